@@ -25,7 +25,6 @@
 #include "app/main.h"
 #include "board.h"
 #include "driver/bk4819.h"
-#include "external/printf/printf.h"
 #include "frequencies.h"
 #include "functions.h"
 #include "misc.h"
@@ -479,7 +478,11 @@
 			{
 				const unsigned int index = gain_table_index[vfo];
 //				sprintf(s, "%2u.%u %4ddB %3u", index, ARRAY_SIZE(gain_table) - 1, gain_table[index].gain_dB, prev_rssi[vfo]);
-				sprintf(s, "%2u %4ddB %3u", index, gain_table[index].gain_dB, prev_rssi[vfo]);
+				s = NUMBER_format_uint(s, index, 2, ' ');
+				*s++ = ' ';
+				s = NUMBER_format_int(s, gain_table[index].gain_dB, 4);
+				strcpy(s, "dB ");
+				NUMBER_format_uint(s + 3, prev_rssi[vfo], 3, ' ');
 				counter = 0;
 			}
 		}
@@ -21,6 +21,7 @@
 #endif
 #include "app/aircopy.h"
 #include "audio.h"
+#include "board.h"
 #include "bsp/dp32g030/gpio.h"
 #include "driver/backlight.h"
 #include "driver/bk4819.h"
@@ -193,8 +194,7 @@ void AIRCOPY_start_fsk_tx(const int request_block_num)
 	BK4819_WriteRegister(BK4819_REG_59, fsk_reg59);
 
 	// load the packet
-	for (k = 0; k < tx_size; k++)
-		BK4819_WriteRegister(BK4819_REG_5F, g_fsk_buffer[k]);
+	BK4819_WriteRegisterBlock(BK4819_REG_5F, g_fsk_buffer, tx_size);
 
 	// enable tx interrupt(s)
 	BK4819_WriteRegister(BK4819_REG_3F, BK4819_REG_3F_FSK_TX_FINISHED);
@@ -554,6 +554,7 @@ void AIRCOPY_process_fsk_rx_10ms(void)
 		}
 
 		EEPROM_WriteBuffer8(eeprom_addr, data);   // 8 bytes at a time
+		BOARD_channel_index_eeprom_written(eeprom_addr);
 
 		data        += write_size / sizeof(data[0]);
 		eeprom_addr += write_size;
@@ -568,6 +569,7 @@ void AIRCOPY_process_fsk_rx_10ms(void)
 		AUDIO_PlayBeep(BEEP_880HZ_60MS_TRIPLE_BEEP);
 
 		#ifdef ENABLE_AIRCOPY_RX_REBOOT
+			EEPROM_Flush();
 			#if defined(ENABLE_OVERLAY)
 				overlay_FLASH_RebootToBootloader();
 			#else
@@ -40,6 +40,7 @@
 	#include "driver/bk1080.h"
 #endif
 #include "driver/bk4819.h"
+#include "driver/eeprom.h"
 #include "driver/gpio.h"
 #include "driver/keyboard.h"
 #include "driver/st7565.h"
@@ -49,11 +50,19 @@
 #include "dtmf.h"
 #include "external/printf/printf.h"
 #include "frequencies.h"
+#ifdef ENABLE_FSK_LINK
+	#include "fsk_link.h"
+#endif
 #include "functions.h"
 #include "helper/battery.h"
+#ifdef ENABLE_KISS_TNC
+	#include "kiss_tnc.h"
+#endif
 #include "misc.h"
 #include "radio.h"
+#include "profile.h"
 #include "settings.h"
+#include "trace.h"
 #if defined(ENABLE_OVERLAY)
 	#include "sram-overlay.h"
 #endif
@@ -80,6 +89,17 @@ const uint8_t orig_pga       = 6;   //  -3dB
 
 static void APP_process_key(const key_code_t Key, const bool key_pressed, const bool key_held);
 
+#ifdef ENABLE_FASTER_CHANNEL_SCAN
+	#define SCAN_PAUSE_CHAN_10ms       9  // 90ms .. <= ~60ms it misses signals (squelch response and/or PLL lock time) ?
+#else
+	#define SCAN_PAUSE_CHAN_10ms       scan_pause_chan_10ms
+#endif
+// dwell after a RADIO_fast_retune() hop, the receiver isn't restarted so the squelch responds sooner
+#define SCAN_PAUSE_CHAN_FAST_10ms      (SCAN_PAUSE_CHAN_10ms / 2)
+
+static bool scan_fast_hop_ok;   // false forces the next channel hop to do a full register setup
+static bool scan_fast_hop;      // true if the current channel was reached with a fast hop
+
 static void APP_update_rssi(const int vfo)
 {
 	int16_t rssi = BK4819_GetRSSI();
@@ -471,6 +491,9 @@ bool APP_start_listening(function_type_t Function, const bool reset_am_fix)
 
 	BK4819_set_GPIO_pin(BK4819_GPIO6_PIN2_GREEN, true);   // LED on
 
+	scan_fast_hop_ok = false;   // AF path is now open, the next scan hop needs the full setup
+	scan_fast_hop    = false;
+
 	if (g_setting_backlight_on_tx_rx >= 2)
 		backlight_turn_on(backlight_tx_rx_time_500ms);
 
@@ -751,6 +774,17 @@ static void APP_next_channel(void)
 	const unsigned int  prev_chan   = g_scan_next_channel;
 	unsigned int        chan        = 0;
 
+	if (scan_fast_hop)
+	{	// short dwell is over .. if there's any sign of a signal give the squelch the rest of the normal dwell
+		// before moving on, the squelch can't open with the RSSI below the close threshold
+		scan_fast_hop = false;
+		if (g_current_function == FUNCTION_FOREGROUND && BK4819_GetRSSI() >= g_rx_vfo->squelch_close_rssi_thresh)
+		{
+			g_scan_pause_10ms = SCAN_PAUSE_CHAN_10ms - SCAN_PAUSE_CHAN_FAST_10ms;
+			return;
+		}
+	}
+
 	if (enabled)
 	{
 		#pragma GCC diagnostic push
@@ -831,17 +865,19 @@ static void APP_next_channel(void)
 		g_eeprom.screen_channel[g_eeprom.rx_vfo] = g_scan_next_channel;
 
 		RADIO_configure_channel(g_eeprom.rx_vfo, VFO_CONFIGURE_RELOAD);
-		RADIO_setup_registers(true);
+
+		// only push the registers that differ from the last channel if we can
+		scan_fast_hop = scan_fast_hop_ok && RADIO_fast_retune();
+		if (!scan_fast_hop)
+			RADIO_setup_registers(true);
+		scan_fast_hop_ok = true;
+
+		TRACE(TRACE_ID_SCAN_NEXT, g_scan_next_channel, scan_fast_hop);
 
 		g_update_display = true;
 	}
 
-	#ifdef ENABLE_FASTER_CHANNEL_SCAN
-		g_scan_pause_10ms = 9;  // 90ms .. <= ~60ms it misses signals (squelch response and/or PLL lock time) ?
-	#else
-		g_scan_pause_10ms = scan_pause_chan_10ms;
-	#endif
-
+	g_scan_pause_10ms      = scan_fast_hop ? SCAN_PAUSE_CHAN_FAST_10ms : SCAN_PAUSE_CHAN_10ms;
 	g_scan_pause_time_mode = false;
 
 	if (enabled)
@@ -904,6 +940,12 @@ void APP_process_radio_interrupts(void)
 		BK4819_WriteRegister(BK4819_REG_02, 0);
 		const uint16_t interrupt_bits = BK4819_ReadRegister(BK4819_REG_02);
 
+		TRACE(TRACE_ID_RADIO_IRQ, interrupt_bits, 0);
+
+		#ifdef ENABLE_FSK_MODEM
+			BK4819_FskProcessInterrupts(interrupt_bits);
+		#endif
+
 		if (interrupt_bits & BK4819_REG_02_DTMF_5TONE_FOUND)
 		{	// save the RX'ed DTMF character
 			const char c = DTMF_GetCharacter(BK4819_GetDTMF_5TONE_Code());
@@ -1000,6 +1042,8 @@ void APP_process_radio_interrupts(void)
 			BK4819_set_GPIO_pin(BK4819_GPIO6_PIN2_GREEN, false);  // LED off
 			g_squelch_open = false;
 
+			TRACE(TRACE_ID_SQUELCH, 0, BK4819_GetRSSI());
+
 			#if defined(ENABLE_UART) && defined(ENABLE_UART_DEBUG)
 				UART_printf("squelch closed\r\n");
 			#endif
@@ -1010,6 +1054,8 @@ void APP_process_radio_interrupts(void)
 //			BK4819_set_GPIO_pin(BK4819_GPIO6_PIN2_GREEN, true);   // LED on
 			g_squelch_open = true;
 
+			TRACE(TRACE_ID_SQUELCH, 1, BK4819_GetRSSI());
+
 			#if defined(ENABLE_UART) && defined(ENABLE_UART_DEBUG)
 				UART_printf("squelch opened\r\n");
 			#endif
@@ -1623,12 +1669,14 @@ void APP_time_slice_10ms(void)
 	g_flash_light_blink_counter++;
 
 #ifdef ENABLE_UART
-	if (UART_IsCommandAvailable())
-	{
+	while (UART_IsCommandAvailable())
+	{	// there can be more than one waiting
 		__disable_irq();
 		UART_HandleCommand();
 		__enable_irq();
 	}
+
+	UART_process_10ms();
 #endif
 
 	// ***********
@@ -1664,6 +1712,9 @@ void APP_time_slice_10ms(void)
 		GUI_SelectNextDisplay(DISPLAY_MAIN);
 	}
 
+	// burn any buffered eeprom writes
+	EEPROM_FlushStep();
+
 	// ***********
 
 	if (g_serial_config_count_down_500ms > 0)
@@ -1709,11 +1760,33 @@ void APP_time_slice_10ms(void)
 	#ifdef ENABLE_AM_FIX
 //		if (g_eeprom.vfo_info[g_eeprom.rx_vfo].am_mode && g_setting_am_fix)
 		if (g_rx_vfo->am_mode && g_setting_am_fix)
+		{
+			PROFILE_ENTER(PROFILE_ID_AM_FIX);
 			AM_fix_10ms(g_eeprom.rx_vfo);
+			PROFILE_EXIT(PROFILE_ID_AM_FIX);
+		}
 	#endif
 
-	if (g_current_function != FUNCTION_POWER_SAVE || !g_rx_idle_mode)
-		APP_process_radio_interrupts();
+	#ifdef ENABLE_FSK_MODEM
+		if (g_current_function != FUNCTION_POWER_SAVE || !g_rx_idle_mode || BK4819_FskTxBusy() || BK4819_FskRxActive())
+	#else
+		if (g_current_function != FUNCTION_POWER_SAVE || !g_rx_idle_mode)
+	#endif
+		{
+			PROFILE_ENTER(PROFILE_ID_RADIO_IRQ);
+			APP_process_radio_interrupts();
+			PROFILE_EXIT(PROFILE_ID_RADIO_IRQ);
+		}
+
+	#ifdef ENABLE_FSK_MODEM
+		BK4819_FskProcess10ms();
+	#endif
+	#ifdef ENABLE_FSK_LINK
+		FSK_LINK_process_10ms();
+	#endif
+	#ifdef ENABLE_KISS_TNC
+		KISS_TNC_process_10ms();
+	#endif
 
 	if (g_current_function == FUNCTION_TRANSMIT)
 	{	// transmitting
@@ -2076,6 +2149,25 @@ void APP_cancel_user_input_modes(void)
 	}
 }
 
+#ifdef ENABLE_FSK_MODEM
+	// some ARM memory addresses to test FSK tx of some data
+	#define MEMORY_ADDRESS          0x00002000
+	#define MEMORY_PACKET_LEN_WORDS 250
+	#define MEMORY_PACKETS          20
+
+	static unsigned int fsk_test_packet;
+
+	static void APP_fsk_test_tx_done(const bool ok)
+	{	// called from the FSK TX engine each time a packet has gone out
+		if (ok && ++fsk_test_packet < MEMORY_PACKETS)
+			if (BK4819_FskTransmitPacket((const uint16_t *)(MEMORY_ADDRESS + MEMORY_PACKET_LEN_WORDS * fsk_test_packet), MEMORY_PACKET_LEN_WORDS * 2, APP_fsk_test_tx_done) == 0)
+				return;
+
+		// disable the TX
+		RADIO_disableTX(true);
+	}
+#endif
+
 // this is called once every 500ms
 void APP_time_slice_500ms(void)
 {
@@ -2085,7 +2177,21 @@ void APP_time_slice_500ms(void)
 
 		#define MMIO16(addr) (*(volatile uint16_t *)(addr))
 
-		if(g_setting_fsk_modem_txrx != FSK_OFF && (43000000 < g_current_vfo->p_tx->frequency && g_current_vfo->p_tx->frequency < 44000000))
+		const bool fsk_band = (43000000 < g_current_vfo->p_tx->frequency && g_current_vfo->p_tx->frequency < 44000000);
+
+		#ifdef ENABLE_FSK_LINK
+			const bool fsk_link = FSK_LINK_is_open();   // the link layer has the modem, keep the test modes out of its way
+		#else
+			const bool fsk_link = false;
+		#endif
+
+		if (!fsk_link && BK4819_FskRxActive() && (g_setting_fsk_modem_txrx != FSK_RX || !fsk_band))
+		{	// receiver no longer wanted
+			BK4819_FskStopReceive();
+			BK4819_FskExitMode();
+		}
+
+		if(!fsk_link && g_setting_fsk_modem_txrx == FSK_TX && fsk_band && !BK4819_FskTxBusy())
 		{
 			if (g_fsk_modem_countdown_500ms > 0)
 			{
@@ -2103,7 +2209,7 @@ void APP_time_slice_500ms(void)
 
 				BK4819_FskEnterMode(
 					FSK_TX,
-					FSK_MODULATION_TYPE_MSK1200_1800, // FSK_MODULATION_TYPE_FSK1K2, FSK_MODULATION_TYPE_FSK2K4, FSK_MODULATION_TYPE_MSK1200_1800, FSK_MODULATION_TYPE_MSK1200_2400
+					(FSK_MODULATION_TYPE_t)g_setting_fsk_modem_mode, // the FSK M? menu
 					120, 				 			  // FSK_TONE2_GAIN   // 0-127
 					FSK_NO_SYNC_BYTES_4, 			  // 0 (2 bytes) or 1 (4 bytes)
 					16, 							  // FSK_PREAMBLE_BYTES // 1-16 bytes
@@ -2111,30 +2217,69 @@ void APP_time_slice_500ms(void)
 					false, 							  // FSK_CRC_EN
 					false                             // FSK_INVERT_DATA
 				);
-				
-				// some ARM memory addresses to test FSK tx of some data
-				#define MEMORY_ADDRESS 0x00002000
-				#define MEMORY_PACKET_LEN_WORDS 250
+
+				// the packets are sent in the background, the TX is disabled again once the last one has gone
+				fsk_test_packet = 0;
+				if (BK4819_FskTransmitPacket((const uint16_t *)MEMORY_ADDRESS, MEMORY_PACKET_LEN_WORDS * 2, APP_fsk_test_tx_done) < 0)
+					RADIO_disableTX(true);
+
+			}
+		}
+		else
+		if (!fsk_link && g_setting_fsk_modem_txrx == FSK_RX && fsk_band && !BK4819_FskTxBusy())
+		{
+			if (!BK4819_FskRxActive())
+			{	// start the receiver, it runs from the radio interrupts and queues the packets for us
+				BK4819_FskEnterMode(
+					FSK_RX,
+					(FSK_MODULATION_TYPE_t)g_setting_fsk_modem_mode, // must match the TX side
+					120,
+					FSK_NO_SYNC_BYTES_4,
+					16,
+					false,
+					false,
+					false
+				);
+				BK4819_FskStartReceive(MEMORY_PACKET_LEN_WORDS * 2);
+			}
+			else
+			{	// fetch whatever packets have arrived
+				uint16_t words[4];
+				bool     crc_ok;
+				int16_t  len;
+
+				while ((len = BK4819_FskReadPacket(words, ARRAY_SIZE(words), &crc_ok)) >= 0)
 				{
-					uint8_t i;
-					for(i=0; i < 20; i++)
-					{
-						BK4819_FskTransmitPacket( (uint16_t *)(MEMORY_ADDRESS + MEMORY_PACKET_LEN_WORDS * i), MEMORY_PACKET_LEN_WORDS * 2);
-					}
+					#if defined(ENABLE_UART) && defined(ENABLE_UART_DEBUG)
+						UART_printf("fsk rx %d words crc %u .. %04X %04X %04X %04X\r\n", len, crc_ok, words[0], words[1], words[2], words[3]);
+					#else
+						(void)len;
+						(void)crc_ok;
+					#endif
 				}
-				
-				// disable the TX
-				RADIO_disableTX(true);
-
-				#if 0 // RX FSK
-				
-				/// to be coded ...
 
+				#if defined(ENABLE_UART) && defined(ENABLE_UART_DEBUG)
+					UART_printf("fsk rx %u pkts %u crc %u short %u ovr %u sync\r\n",
+						g_fsk_rx_stats.packets,
+						g_fsk_rx_stats.crc_errors,
+						g_fsk_rx_stats.short_packets,
+						g_fsk_rx_stats.overruns,
+						g_fsk_rx_stats.sync_found);
 				#endif
 			}
 		}
 	#endif // ENABLE_FSK_MODEM
 
+	{	// the blits only send what's changed, so put the LCD settings and the
+		// whole screen back every 2 seconds in case our own RF has corrupted them
+		static unsigned int lcd_refresh_500ms = 0;
+		if (++lcd_refresh_500ms >= 4)
+		{
+			lcd_refresh_500ms = 0;
+			ST7565_Refresh();
+		}
+	}
+
 	// Skipped authentic device check
 
 	if (g_serial_config_count_down_500ms > 0)
@@ -2214,6 +2359,7 @@ void APP_time_slice_500ms(void)
 
 		if (g_usb_current > 500 || g_battery_calibration[3] < g_usb_current_voltage)
 		{
+			EEPROM_Flush();
 			#ifdef ENABLE_OVERLAY
 				overlay_FLASH_RebootToBootloader();
 			#else
@@ -2521,6 +2667,8 @@ void APP_channel_next(const bool remember_current, const scan_state_dir_t scan_d
 	{	// channel mode
 		if (remember_current)
 			g_scan_restore_channel = g_scan_next_channel;
+		scan_fast_hop_ok = false;
+		scan_fast_hop    = false;
 		APP_next_channel();
 	}
 	else
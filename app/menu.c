@@ -1710,6 +1710,8 @@ static void MENU_Key_MENU(const bool key_pressed, const bool key_held)
 
 						MENU_AcceptSetting();
 
+						EEPROM_Flush();
+
 #if defined(ENABLE_OVERLAY)
 							overlay_FLASH_RebootToBootloader();
 #else
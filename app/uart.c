@@ -26,6 +26,7 @@
 #endif
 #include "app/uart.h"
 #include "board.h"
+#include "bsp/dp32g030/crc.h"
 #include "bsp/dp32g030/dma.h"
 #include "bsp/dp32g030/gpio.h"
 #include "driver/aes.h"
@@ -35,8 +36,17 @@
 #include "driver/gpio.h"
 #include "driver/uart.h"
 #include "functions.h"
+#ifdef ENABLE_KISS_TNC
+	#include "kiss_tnc.h"
+#endif
 #include "misc.h"
 #include "settings.h"
+#ifdef ENABLE_PROFILE
+	#include "profile.h"
+#endif
+#ifdef ENABLE_TRACE
+	#include "trace.h"
+#endif
 #if defined(ENABLE_OVERLAY)
 	#include "sram-overlay.h"
 #endif
@@ -145,6 +155,172 @@ typedef struct {
 	uint32_t time_stamp;
 } __attribute__((packed)) cmd_052F_t;
 
+#ifdef ENABLE_BK4819_REG_CACHE
+	typedef struct {
+		Header_t Header;
+		uint8_t  clear;         // non-zero to reset the counters after reading them
+		uint8_t  pad[3];
+	} __attribute__((packed)) cmd_0531_t;
+
+	typedef struct {
+		Header_t Header;
+		struct {
+			uint32_t read_hits;
+			uint32_t read_misses;
+			uint32_t writes;
+			uint32_t write_skips;
+			uint32_t uncached;
+		} __attribute__((packed)) Data;
+	} __attribute__((packed)) reply_0531_t;
+#endif
+
+typedef struct {
+	Header_t Header;
+	uint8_t  clear;             // non-zero to reset the counters after reading them
+	uint8_t  pad[3];
+} __attribute__((packed)) cmd_0533_t;
+
+typedef struct {
+	Header_t Header;
+	struct {
+		uint32_t bytes_written;
+		uint32_t page_writes;
+		uint32_t write_skips;
+		uint16_t busy_polls_max;
+		uint16_t flush_last_10ms;
+		uint16_t flush_max_10ms;
+		uint16_t pad;
+	} __attribute__((packed)) Data;
+} __attribute__((packed)) reply_0533_t;
+
+// bulk eeprom read .. the radio streams 0x0536 frames, keeping at most 'window' of them un-ack'ed
+typedef struct {
+	Header_t Header;
+	uint16_t Offset;
+	uint16_t Size;              // total bytes wanted, up to the whole eeprom
+	uint8_t  window;            // frames allowed in flight (un-ack'ed), 0 for the default
+	uint8_t  pad[3];
+} __attribute__((packed)) cmd_0535_t;
+
+typedef struct {
+	Header_t Header;
+	struct {
+		uint16_t Offset;
+		uint16_t Size;
+		uint8_t  Data[256];
+	} __attribute__((packed)) Data;
+} __attribute__((packed)) reply_0535_t;
+
+// bulk eeprom read ack
+typedef struct {
+	Header_t Header;
+	uint16_t Offset;            // everything below this has been received
+	uint8_t  pad[2];
+} __attribute__((packed)) cmd_0537_t;
+
+// bulk eeprom write .. the PC streams these without waiting, each one is ack'ed with a 0x053A
+#define BULK_WRITE_FLAG_FIRST           (1u << 0)   // first frame, (re)starts the sequence
+#define BULK_WRITE_FLAG_ALLOW_PASSWORD  (1u << 1)
+
+typedef struct {
+	Header_t Header;
+	uint16_t Offset;
+	uint8_t  Size;              // bytes of data that follow, a multiple of 8
+	uint8_t  flags;             // BULK_WRITE_FLAG_xxx
+//	uint8_t  Data[0];
+} __attribute__((packed)) cmd_0539_t;
+
+typedef struct {
+	Header_t Header;
+	struct {
+		uint16_t Offset;        // next offset the radio expects
+		uint8_t  pad[2];
+	} __attribute__((packed)) Data;
+} __attribute__((packed)) reply_0539_t;
+
+#ifdef ENABLE_UART_TX_DMA
+	typedef struct {
+		Header_t Header;
+		uint8_t  clear;         // non-zero to reset the counters after reading them
+		uint8_t  pad[3];
+	} __attribute__((packed)) cmd_053B_t;
+
+	typedef struct {
+		Header_t Header;
+		struct {
+			uint32_t bytes;
+			uint16_t high_water;
+			uint16_t stalls;
+		} __attribute__((packed)) Data;
+	} __attribute__((packed)) reply_053B_t;
+#endif
+
+#ifdef ENABLE_TRACE
+	#define TRACE_REPLY_MAX 24  // events per reply
+
+	typedef struct {
+		Header_t Header;
+		uint8_t  max;           // max number of events wanted, 0 = as many as fit
+		uint8_t  pad[3];
+	} __attribute__((packed)) cmd_053D_t;
+
+	typedef struct {
+		Header_t Header;
+		struct {
+			uint16_t      lost;      // events overwritten before they were drained
+			uint8_t       count;     // events in this reply
+			uint8_t       pad;
+			trace_entry_t entry[TRACE_REPLY_MAX];
+		} __attribute__((packed)) Data;
+	} __attribute__((packed)) reply_053D_t;
+#endif
+
+#ifdef ENABLE_PROFILE
+	typedef struct {
+		Header_t Header;
+		uint8_t  clear;         // non-zero to reset the table after reading it
+		uint8_t  pad[3];
+	} __attribute__((packed)) cmd_053F_t;
+
+	typedef struct {
+		Header_t Header;
+		struct {
+			uint32_t cycles_per_tick;                       // cycles per 10ms
+			uint32_t overruns[PROFILE_SLICE_COUNT];          // 10ms, 500ms
+			struct {
+				uint32_t count;
+				uint32_t min;
+				uint32_t avg;
+				uint32_t max;
+			} __attribute__((packed)) region[PROFILE_ID_COUNT];   // in profile_id_e order
+		} __attribute__((packed)) Data;
+	} __attribute__((packed)) reply_053F_t;
+#endif
+
+#ifdef ENABLE_KISS_TNC
+	typedef struct {
+		Header_t Header;
+		uint8_t  clear;         // non-zero to reset the counters after reading them, not the queue depths
+		uint8_t  pad[3];
+	} __attribute__((packed)) cmd_0541_t;
+
+	typedef struct {
+		Header_t Header;
+		struct {
+			uint8_t          open;
+			uint8_t          tx_frames;     // waiting to go on the air, the one going out included
+			uint8_t          rx_frames;     // waiting to go out the UART
+			uint8_t          pad;
+			uint16_t         tx_bytes;
+			uint16_t         rx_bytes;
+			uint16_t         tx_size;       // queue sizes
+			uint16_t         rx_size;
+			kiss_tnc_stats_t stats;
+		} __attribute__((packed)) Data;
+	} __attribute__((packed)) reply_0541_t;
+#endif
+
+// only used for the odd command that wraps around the end of the DMA ring
 static union
 {
 	uint8_t Buffer[256];
@@ -155,6 +331,9 @@ static union
 	} __attribute__((packed));
 } __attribute__((packed)) UART_Command;
 
+// the command to handle, decoded in place in the DMA ring, or in UART_Command if it wrapped
+static uint8_t *p_command = UART_Command.Buffer;
+
 uint32_t time_stamp    = 0;
 uint16_t write_index   = 0;
 bool     is_encrypted  = true;
@@ -164,19 +343,75 @@ bool     is_encrypted  = true;
 	uint8_t  try_count = 0;
 #endif
 
+#define BULK_READ_WINDOW   4    // default frames in flight
+
+// bytes one full 0x0536 frame takes in the TX ring, the reply plus the 0xCDAB header and 0xBADC footer
+#define BULK_READ_FRAME    (sizeof(reply_0535_t) + sizeof(Header_t) + sizeof(Footer_t))
+
+// frames in flight, more than the whole eeprom would be pointless .. the TX ring is never
+// overrun whatever the window, BulkReadSend() only queues what UART_TxFree() takes
+#define BULK_READ_WINDOW_MAX  (EEPROM_SIZE / sizeof(((reply_0535_t *)0)->Data.Data))
+
+static struct {
+	uint16_t next;              // next offset to send
+	uint16_t acked;             // PC has everything below this
+	uint16_t end;
+	uint16_t window;            // bytes allowed in flight
+} bulk_read;
+
+static uint16_t bulk_write_next;
+
 // ****************************************************
 
-static void SendReply(void *preply, uint16_t Size)
+// XOR with the obfuscation pattern, a word at a time once the buffer is word aligned
+static void Obfuscate(void *pBuffer, const unsigned int Size)
+{
+	uint8_t     *pBytes = (uint8_t *)pBuffer;
+	unsigned int i      = 0;
+
+	while (i < Size && ((uintptr_t)&pBytes[i] & 3u) != 0)
+	{
+		pBytes[i] ^= obfuscate_array[i % 16];
+		i++;
+	}
+
+	if ((i + 4) <= Size)
+	{
+		uint32_t    *pWords = (uint32_t *)&pBytes[i];
+		uint8_t      pattern[16];
+		uint32_t     key[4];
+		unsigned int k;
+
+		// the pattern rotated to line up with the first aligned byte
+		for (k = 0; k < sizeof(pattern); k++)
+			pattern[k] = obfuscate_array[(i + k) % 16];
+		memcpy(key, pattern, sizeof(key));
+
+		for (k = 0; (i + 4) <= Size; i += 4, k++)
+			pWords[k] ^= key[k % 4];
+	}
+
+	for ( ; i < Size; i++)
+		pBytes[i] ^= obfuscate_array[i % 16];
+}
+
+static void SendFrame(void *preply, uint16_t Size, const bool with_crc)
 {
 	Header_t Header;
 	Footer_t Footer;
+	uint16_t CRC = 0xFFFF;      // the original replies don't carry a CRC
+
+	if (with_crc)
+		CRC = CRC_Calculate(preply, Size);
+
+	Footer.pad[0] = (CRC >> 0) & 0xFF;
+	Footer.pad[1] = (CRC >> 8) & 0xFF;
 
 	if (is_encrypted)
 	{
-		uint8_t     *pBytes = (uint8_t *)preply;
-		unsigned int i;
-		for (i = 0; i < Size; i++)
-			pBytes[i] ^= obfuscate_array[i % 16];
+		Obfuscate(preply, Size);
+		Footer.pad[0] ^= obfuscate_array[(Size + 0) % 16];
+		Footer.pad[1] ^= obfuscate_array[(Size + 1) % 16];
 	}
 
 	Header.ID   = 0xCDAB;
@@ -184,20 +419,15 @@ static void SendReply(void *preply, uint16_t Size)
 	UART_Send(&Header, sizeof(Header));
 	UART_Send(preply, Size);
 
-	if (is_encrypted)
-	{
-		Footer.pad[0] = obfuscate_array[(Size + 0) % 16] ^ 0xFF;
-		Footer.pad[1] = obfuscate_array[(Size + 1) % 16] ^ 0xFF;
-	}
-	else
-	{
-		Footer.pad[0] = 0xFF;
-		Footer.pad[1] = 0xFF;
-	}
 	Footer.ID = 0xBADC;
 	UART_Send(&Footer, sizeof(Footer));
 }
 
+static void SendReply(void *preply, uint16_t Size)
+{
+	SendFrame(preply, Size, false);
+}
+
 static void SendVersion(void)
 {
 	reply_0514_t reply;
@@ -294,6 +524,43 @@ static void cmd_051B(const uint8_t *pBuffer)
 	SendReply(&reply, size + 8);
 }
 
+// write 8 bytes of eeprom for the PC, minus the bits it's not allowed to change
+// returns true if the AES key was written
+static bool WriteEeprom8(const unsigned int Offset, uint8_t *data, const bool allow_password)
+{
+	bool aes_key = false;
+
+	#ifdef INCLUDE_AES
+		if (Offset >= 0x0F30 && Offset < 0x0F40)     // AES key
+			if (!is_locked)
+				aes_key = true;
+	#else
+		if (Offset == 0x0F30)
+			memset(data, 0xff, 8);   // wipe the AES key
+	#endif
+
+	//#ifndef ENABLE_KILL_REVIVE
+		if (Offset == 0x0F40)
+		{	// killed flag is here
+			data[2] = false;	// remove it
+		}
+	//#endif
+
+	#ifdef ENABLE_PWRON_PASSWORD
+		if ((Offset < 0x0E98 || Offset >= 0x0E9C) || !g_password_locked || allow_password)
+			EEPROM_WriteBuffer8(Offset, data);
+	#else
+		(void)allow_password;
+		if (Offset == 0x0E98)
+			memset(data, 0xff, 4);   // wipe the password 
+		EEPROM_WriteBuffer8(Offset, data);
+	#endif
+
+	BOARD_channel_index_eeprom_written(Offset);
+
+	return aes_key;
+}
+
 // write eeprom
 static void cmd_051D(const uint8_t *pBuffer)
 {
@@ -342,28 +609,10 @@ static void cmd_051D(const uint8_t *pBuffer)
 				break;
 
 			#ifdef INCLUDE_AES
-				if (Offset >= 0x0F30 && Offset < 0x0F40)     // AES key
-					if (!is_locked)
-						reload_eeprom = true;
+				if (WriteEeprom8(Offset, data, pCmd->allow_password))
+					reload_eeprom = true;
 			#else
-				if (Offset == 0x0F30)
-					memset(data, 0xff, 8);   // wipe the AES key
-			#endif
-
-			//#ifndef ENABLE_KILL_REVIVE
-				if (Offset == 0x0F40)
-				{	// killed flag is here
-					data[2] = false;	// remove it
-				}
-			//#endif
-
-			#ifdef ENABLE_PWRON_PASSWORD
-				if ((Offset < 0x0E98 || Offset >= 0x0E9C) || !g_password_locked || pCmd->allow_password)
-					EEPROM_WriteBuffer8(Offset, data);
-			#else
-				if (Offset == 0x0E98)
-					memset(data, 0xff, 4);   // wipe the password 
-				EEPROM_WriteBuffer8(Offset, data);
+				WriteEeprom8(Offset, data, pCmd->allow_password);
 			#endif
 		}
 
@@ -376,6 +625,161 @@ static void cmd_051D(const uint8_t *pBuffer)
 	SendReply(&reply, sizeof(reply));
 }
 
+// send bulk read frames until the window is full, or until the TX ring is
+//
+// this runs with interrupts off, so it only queues what UART_Send() takes without waiting,
+// UART_process_10ms() carries on with the rest of the window
+static void BulkReadSend(void)
+{
+	unsigned int sent = 0;
+
+	while (bulk_read.next < bulk_read.end && (uint16_t)(bulk_read.next - bulk_read.acked) < bulk_read.window)
+	{
+		reply_0535_t reply;
+		unsigned int size = bulk_read.end - bulk_read.next;
+
+		if (size > sizeof(reply.Data.Data))
+			size = sizeof(reply.Data.Data);
+
+		#ifdef ENABLE_UART_TX_DMA
+			if (UART_TxFree() < (size + (BULK_READ_FRAME - sizeof(reply.Data.Data))))
+				break;   // no room yet
+		#else
+			if (sent > 0)
+				break;   // no TX ring, UART_Send() waits out every byte .. one frame per call
+		#endif
+
+		reply.Header.ID   = 0x0536;
+		reply.Header.Size = size + 4;
+		reply.Data.Offset = bulk_read.next;
+		reply.Data.Size   = size;
+
+		EEPROM_ReadBuffer(bulk_read.next, reply.Data.Data, size);
+
+		bulk_read.next += size;
+
+		// unlike the other replies these carry a real CRC
+		SendFrame(&reply, size + 8, true);
+
+		sent++;
+	}
+}
+
+// bulk read eeprom, (re)starts a stream
+static void cmd_0535(const uint8_t *pBuffer)
+{
+	const cmd_0535_t *pCmd = (const cmd_0535_t *)pBuffer;
+	unsigned int      addr = pCmd->Offset;
+	unsigned int      size = pCmd->Size;
+	unsigned int      window;
+
+	g_serial_config_count_down_500ms = serial_config_count_down_500ms;
+
+	bulk_read.next  = 0;
+	bulk_read.acked = 0;
+	bulk_read.end   = 0;
+
+	if (addr >= EEPROM_SIZE)
+		return;
+
+	if (size > (EEPROM_SIZE - addr))
+		size =  EEPROM_SIZE - addr;
+
+	bulk_read.next   = addr;
+	bulk_read.acked  = addr;
+	bulk_read.end    = addr + size;
+	window           = (pCmd->window > 0) ? pCmd->window : BULK_READ_WINDOW;
+	if (window > BULK_READ_WINDOW_MAX)
+		window = BULK_READ_WINDOW_MAX;
+	bulk_read.window = window * sizeof(((reply_0535_t *)0)->Data.Data);
+
+	BulkReadSend();
+}
+
+// bulk read ack
+//
+// a lost frame shows up as an ack that stops moving, the PC then restarts the stream
+// from its ack'ed offset with another 0x0535
+static void cmd_0537(const uint8_t *pBuffer)
+{
+	const cmd_0537_t *pCmd = (const cmd_0537_t *)pBuffer;
+
+	g_serial_config_count_down_500ms = serial_config_count_down_500ms;
+
+	if (pCmd->Offset > bulk_read.acked && pCmd->Offset <= bulk_read.next)
+		bulk_read.acked = pCmd->Offset;
+
+	BulkReadSend();
+}
+
+// bulk write eeprom
+//
+// frames must arrive in order, anything else is dropped and the ack tells the PC where to carry on from
+static void cmd_0539(const uint8_t *pBuffer)
+{
+	const unsigned int write_size = 8;
+	const cmd_0539_t  *pCmd       = (const cmd_0539_t *)pBuffer;
+	const unsigned int addr       = pCmd->Offset;
+	unsigned int       size       = pCmd->Size;
+	unsigned int       data_size;
+#ifdef INCLUDE_AES
+	bool               locked     = g_has_custom_aes_key ? is_locked : g_has_custom_aes_key;
+#endif
+	reply_0539_t       reply;
+
+	// never trust the size field beyond what actually arrived
+	if (pCmd->Header.Size < (sizeof(cmd_0539_t) - sizeof(Header_t)))
+		return;          // too short to even hold the command
+	data_size = pCmd->Header.Size - (sizeof(cmd_0539_t) - sizeof(Header_t));
+	if (size > data_size)
+		size = data_size;
+
+	g_serial_config_count_down_500ms = serial_config_count_down_500ms;
+
+	if (pCmd->flags & BULK_WRITE_FLAG_FIRST)
+		bulk_write_next = addr;
+
+	if (addr >= EEPROM_SIZE || size > (EEPROM_SIZE - addr))
+		size = 0;
+	size -= size % write_size;
+
+	if (addr == bulk_write_next && size > 0)
+	{
+#ifdef INCLUDE_AES
+		bool reload_eeprom = false;
+
+		if (!locked)
+#endif
+		{
+			unsigned int k;
+			for (k = 0; k < size; k += write_size)
+			{
+				uint8_t *data = (uint8_t *)pCmd + sizeof(cmd_0539_t) + k;
+			#ifdef INCLUDE_AES
+				if (WriteEeprom8(addr + k, data, (pCmd->flags & BULK_WRITE_FLAG_ALLOW_PASSWORD) != 0))
+					reload_eeprom = true;
+			#else
+				WriteEeprom8(addr + k, data, (pCmd->flags & BULK_WRITE_FLAG_ALLOW_PASSWORD) != 0);
+			#endif
+			}
+		}
+
+		bulk_write_next = addr + size;
+
+#ifdef INCLUDE_AES
+		if (reload_eeprom)
+			BOARD_EEPROM_load();
+#endif
+	}
+
+	memset(&reply, 0, sizeof(reply));
+	reply.Header.ID   = 0x053A;
+	reply.Header.Size = sizeof(reply.Data);
+	reply.Data.Offset = bulk_write_next;
+
+	SendReply(&reply, sizeof(reply));
+}
+
 // read RSSI
 static void cmd_0527(void)
 {
@@ -407,6 +811,156 @@ static void cmd_0529(void)
 	SendReply(&reply, sizeof(reply));
 }
 
+#ifdef ENABLE_BK4819_REG_CACHE
+	// read BK4819 register cache counters
+	static void cmd_0531(const uint8_t *pBuffer)
+	{
+		const cmd_0531_t *pCmd = (const cmd_0531_t *)pBuffer;
+		reply_0531_t      reply;
+
+		memset(&reply, 0, sizeof(reply));
+		reply.Header.ID        = 0x0532;
+		reply.Header.Size      = sizeof(reply.Data);
+		reply.Data.read_hits   = g_bk4819_reg_cache_stats.read_hits;
+		reply.Data.read_misses = g_bk4819_reg_cache_stats.read_misses;
+		reply.Data.writes      = g_bk4819_reg_cache_stats.writes;
+		reply.Data.write_skips = g_bk4819_reg_cache_stats.write_skips;
+		reply.Data.uncached    = g_bk4819_reg_cache_stats.uncached;
+
+		if (pCmd->clear)
+			memset(&g_bk4819_reg_cache_stats, 0, sizeof(g_bk4819_reg_cache_stats));
+
+		SendReply(&reply, sizeof(reply));
+	}
+#endif
+
+// read eeprom write counters
+static void cmd_0533(const uint8_t *pBuffer)
+{
+	const cmd_0533_t *pCmd = (const cmd_0533_t *)pBuffer;
+	reply_0533_t      reply;
+
+	memset(&reply, 0, sizeof(reply));
+	reply.Header.ID            = 0x0534;
+	reply.Header.Size          = sizeof(reply.Data);
+	reply.Data.bytes_written   = g_eeprom_write_stats.bytes_written;
+	reply.Data.page_writes     = g_eeprom_write_stats.page_writes;
+	reply.Data.write_skips     = g_eeprom_write_stats.write_skips;
+	reply.Data.busy_polls_max  = g_eeprom_write_stats.busy_polls_max;
+	reply.Data.flush_last_10ms = g_eeprom_write_stats.flush_last_10ms;
+	reply.Data.flush_max_10ms  = g_eeprom_write_stats.flush_max_10ms;
+
+	if (pCmd->clear)
+		memset(&g_eeprom_write_stats, 0, sizeof(g_eeprom_write_stats));
+
+	SendReply(&reply, sizeof(reply));
+}
+
+#ifdef ENABLE_UART_TX_DMA
+	// read UART TX queue counters
+	static void cmd_053B(const uint8_t *pBuffer)
+	{
+		const cmd_053B_t *pCmd = (const cmd_053B_t *)pBuffer;
+		reply_053B_t      reply;
+
+		memset(&reply, 0, sizeof(reply));
+		reply.Header.ID       = 0x053C;
+		reply.Header.Size     = sizeof(reply.Data);
+		reply.Data.bytes      = g_uart_tx_stats.bytes;
+		reply.Data.high_water = g_uart_tx_stats.high_water;
+		reply.Data.stalls     = g_uart_tx_stats.stalls;
+
+		if (pCmd->clear)
+			memset(&g_uart_tx_stats, 0, sizeof(g_uart_tx_stats));
+
+		SendReply(&reply, sizeof(reply));
+	}
+#endif
+
+#ifdef ENABLE_TRACE
+	// drain the oldest events from the trace ring, send it repeatedly until 'count' comes back 0
+	static void cmd_053D(const uint8_t *pBuffer)
+	{
+		const cmd_053D_t *pCmd = (const cmd_053D_t *)pBuffer;
+		reply_053D_t      reply;
+		unsigned int      max  = pCmd->max;
+		uint16_t          lost;
+
+		if (max == 0 || max > TRACE_REPLY_MAX)
+			max = TRACE_REPLY_MAX;
+
+		reply.Header.ID  = 0x053E;
+		reply.Data.count = TRACE_drain(reply.Data.entry, max, &lost);
+		reply.Data.lost  = lost;
+		reply.Data.pad   = 0;
+
+		// only send the events we have
+		reply.Header.Size = sizeof(reply.Data) - (sizeof(reply.Data.entry[0]) * (TRACE_REPLY_MAX - reply.Data.count));
+
+		SendReply(&reply, sizeof(reply.Header) + reply.Header.Size);
+	}
+#endif
+
+#ifdef ENABLE_PROFILE
+	// read the cycle profiler table
+	static void cmd_053F(const uint8_t *pBuffer)
+	{
+		const cmd_053F_t *pCmd = (const cmd_053F_t *)pBuffer;
+		reply_053F_t      reply;
+		unsigned int      i;
+
+		memset(&reply, 0, sizeof(reply));
+		reply.Header.ID            = 0x0540;
+		reply.Header.Size          = sizeof(reply.Data);
+		reply.Data.cycles_per_tick = PROFILE_CYCLES_PER_TICK;
+
+		for (i = 0; i < PROFILE_SLICE_COUNT; i++)
+			reply.Data.overruns[i] = g_profile_overruns[i];
+
+		for (i = 0; i < PROFILE_ID_COUNT; i++)
+		{
+			const profile_stat_t *p_stat = &g_profile_stat[i];
+			reply.Data.region[i].count = p_stat->count;
+			reply.Data.region[i].min   = p_stat->min;
+			reply.Data.region[i].avg   = (p_stat->count > 0) ? (uint32_t)(p_stat->total / p_stat->count) : 0;
+			reply.Data.region[i].max   = p_stat->max;
+		}
+
+		if (pCmd->clear)
+			PROFILE_clear();
+
+		SendReply(&reply, sizeof(reply));
+	}
+#endif
+
+#ifdef ENABLE_KISS_TNC
+	// read the KISS TNC queue depths and counters
+	static void cmd_0541(const uint8_t *pBuffer)
+	{
+		const cmd_0541_t *pCmd = (const cmd_0541_t *)pBuffer;
+		reply_0541_t      reply;
+		uint16_t          tx_bytes;
+		uint16_t          rx_bytes;
+
+		memset(&reply, 0, sizeof(reply));
+		reply.Header.ID      = 0x0542;
+		reply.Header.Size    = sizeof(reply.Data);
+		reply.Data.open      = KISS_TNC_is_open();
+		reply.Data.tx_frames = KISS_TNC_queued(true, &tx_bytes);
+		reply.Data.rx_frames = KISS_TNC_queued(false, &rx_bytes);
+		reply.Data.tx_bytes  = tx_bytes;
+		reply.Data.rx_bytes  = rx_bytes;
+		reply.Data.tx_size   = KISS_TNC_TX_QUEUE_BYTES;
+		reply.Data.rx_size   = KISS_TNC_RX_QUEUE_BYTES;
+		reply.Data.stats     = g_kiss_tnc_stats;
+
+		if (pCmd->clear)
+			memset(&g_kiss_tnc_stats, 0, sizeof(g_kiss_tnc_stats));
+
+		SendReply(&reply, sizeof(reply));
+	}
+#endif
+
 #ifdef INCLUDE_AES
 
 static void cmd_052D(const uint8_t *pBuffer)
@@ -489,112 +1043,124 @@ static void cmd_052F(const uint8_t *pBuffer)
 }
 
 bool UART_IsCommandAvailable(void)
-{
-	uint16_t Index;
-	uint16_t TailIndex;
-	uint16_t Size;
-	uint16_t CRC;
-	uint16_t CommandLength;
-	uint16_t DmaLength = DMA_CH0->ST & 0xFFFU;
+{	// the frames are validated, de-obfuscated and CRC checked where they sit in the DMA ring,
+	// consuming them only moves write_index on
+	//
+	// 0xAB 0xCD, Size (2), payload (Size), CRC (2), 0xDC 0xBA
+	//
+	// KISS frames share the port, the TNC takes them a byte at a time as they arrive
 
-	while (1)
+	const uint16_t DmaLength = DMA_CH0->ST & 0xFFFU;
+
+	while (write_index != DmaLength)
 	{
-		if (write_index == DmaLength)
-			return false;
+		const uint16_t Available = DMA_INDEX(DmaLength, sizeof(UART_DMA_Buffer) - write_index);
+		uint16_t       Index;
+		uint16_t       TailIndex;
+		uint16_t       Size;
+		uint16_t       ID;
+		uint16_t       CRC;
+		uint8_t       *pDest;
+		unsigned int   i;
+
+		#ifdef ENABLE_KISS_TNC
+			if (KISS_TNC_uart_byte(UART_DMA_Buffer[write_index]))
+			{
+				write_index = DMA_INDEX(write_index, 1);
+				continue;
+			}
+
+			if (KISS_TNC_uart_busy())
+				return false;          // a reply now would land in the middle of a KISS frame
+		#endif
 
-		while (write_index != DmaLength && UART_DMA_Buffer[write_index] != 0xABU)
+		if (UART_DMA_Buffer[write_index] != 0xAB)
+		{	// hunt for the start of a frame
 			write_index = DMA_INDEX(write_index, 1);
+			continue;
+		}
 
-		if (write_index == DmaLength)
+		if (Available < 8)
 			return false;
 
-		if (write_index < DmaLength)
-			CommandLength = DmaLength - write_index;
-		else
-			CommandLength = (DmaLength + sizeof(UART_DMA_Buffer)) - write_index;
-
-		if (CommandLength < 8)
-			return 0;
+		if (UART_DMA_Buffer[DMA_INDEX(write_index, 1)] != 0xCD)
+		{
+			write_index = DMA_INDEX(write_index, 1);
+			continue;
+		}
 
-		if (UART_DMA_Buffer[DMA_INDEX(write_index, 1)] == 0xCD)
-			break;
+		Index = DMA_INDEX(write_index, 2);
+		Size  = (UART_DMA_Buffer[DMA_INDEX(Index, 1)] << 8) | UART_DMA_Buffer[Index];
 
-		write_index = DMA_INDEX(write_index, 1);
-	}
+		if ((Size + 8u) > sizeof(UART_Command.Buffer))
+		{	// can't be a frame, resync
+			write_index = DMA_INDEX(write_index, 1);
+			continue;
+		}
 
-	Index = DMA_INDEX(write_index, 2);
-	Size  = (UART_DMA_Buffer[DMA_INDEX(Index, 1)] << 8) | UART_DMA_Buffer[Index];
+		if (Available < (Size + 8))
+			return false;                  // not all here yet
 
-	if ((Size + 8u) > sizeof(UART_DMA_Buffer))
-	{
-		write_index = DmaLength;
-		return false;
-	}
+		Index     = DMA_INDEX(Index, 2);
+		TailIndex = DMA_INDEX(Index, Size + 2);
 
-	if (CommandLength < (Size + 8))
-		return false;
+		if (UART_DMA_Buffer[TailIndex] != 0xDC || UART_DMA_Buffer[DMA_INDEX(TailIndex, 1)] != 0xBA)
+		{	// not a frame after all, resync
+			write_index = DMA_INDEX(write_index, 1);
+			continue;
+		}
 
-	Index     = DMA_INDEX(Index, 2);
-	TailIndex = DMA_INDEX(Index, Size + 2);
+		write_index = DMA_INDEX(TailIndex, 2);
 
-	if (UART_DMA_Buffer[TailIndex] != 0xDC || UART_DMA_Buffer[DMA_INDEX(TailIndex, 1)] != 0xBA)
-	{
-		write_index = DmaLength;
-		return false;
-	}
+		ID = UART_DMA_Buffer[Index] | (UART_DMA_Buffer[DMA_INDEX(Index, 1)] << 8);
 
-	if (TailIndex < Index)
-	{
-		const uint16_t ChunkSize = sizeof(UART_DMA_Buffer) - Index;
-		memcpy(UART_Command.Buffer, UART_DMA_Buffer + Index, ChunkSize);
-		memcpy(UART_Command.Buffer + ChunkSize, UART_DMA_Buffer, TailIndex);
-	}
-	else
-		memcpy(UART_Command.Buffer, UART_DMA_Buffer + Index, TailIndex - Index);
+		if (ID == 0x0514)
+			is_encrypted = false;
 
-	TailIndex = DMA_INDEX(TailIndex, 2);
-	if (TailIndex < write_index)
-	{
-		memset(UART_DMA_Buffer + write_index, 0, sizeof(UART_DMA_Buffer) - write_index);
-		memset(UART_DMA_Buffer, 0, TailIndex);
-	}
-	else
-		memset(UART_DMA_Buffer + write_index, 0, TailIndex - write_index);
+		if (ID == 0x6902)
+			is_encrypted = true;
 
-	write_index = TailIndex;
+		// decode in place, unless the frame wraps around the end of the ring
+		pDest = ((Index + Size + 2u) <= sizeof(UART_DMA_Buffer)) ? &UART_DMA_Buffer[Index] : UART_Command.Buffer;
 
-	if (UART_Command.Header.ID == 0x0514)
-		is_encrypted = false;
+		// de-obfuscate and CRC in the one pass
+		CRC_Begin();
+		for (i = 0; i < (Size + 2u); i++)
+		{
+			uint8_t b = UART_DMA_Buffer[DMA_INDEX(Index, i)];
+			if (is_encrypted)
+				b ^= obfuscate_array[i % 16];
+			if (i < Size)
+				CRC_DATAIN = b;
+			pDest[i] = b;
+		}
 
-	if (UART_Command.Header.ID == 0x6902)
-		is_encrypted = true;
+		CRC = pDest[Size] | (pDest[Size + 1] << 8);
 
-	if (is_encrypted)
-	{
-		unsigned int i;
-		for (i = 0; i < (Size + 2u); i++)
-			UART_Command.Buffer[i] ^= obfuscate_array[i % 16];
+		if (CRC_End() == CRC)
+		{
+			p_command = pDest;
+			return true;
+		}
 	}
 
-	CRC = UART_Command.Buffer[Size] | (UART_Command.Buffer[Size + 1] << 8);
-
-	return (CRC_Calculate(UART_Command.Buffer, Size) != CRC) ? false : true;
+	return false;
 }
 
 void UART_HandleCommand(void)
 {
-	switch (UART_Command.Header.ID)
+	switch (((const Header_t *)p_command)->ID)
 	{
 		case 0x0514:    // version
-			cmd_0514(UART_Command.Buffer);
+			cmd_0514(p_command);
 			break;
 
 		case 0x051B:    // read eeprom
-			cmd_051B(UART_Command.Buffer);
+			cmd_051B(p_command);
 			break;
 
 		case 0x051D:    // write eeprom
-			cmd_051D(UART_Command.Buffer);
+			cmd_051D(p_command);
 			break;
 
 		case 0x051F:	// Not implementing non-authentic command
@@ -613,15 +1179,62 @@ void UART_HandleCommand(void)
 			
 #ifdef INCLUDE_AES
 		case 0x052D:    //
-			cmd_052D(UART_Command.Buffer);
+			cmd_052D(p_command);
 			break;
 #endif
 
 		case 0x052F:    //
-			cmd_052F(UART_Command.Buffer);
+			cmd_052F(p_command);
+			break;
+
+#ifdef ENABLE_BK4819_REG_CACHE
+		case 0x0531:    // read BK4819 register cache counters
+			cmd_0531(p_command);
+			break;
+#endif
+
+		case 0x0533:    // read eeprom write counters
+			cmd_0533(p_command);
+			break;
+
+		case 0x0535:    // bulk read eeprom
+			cmd_0535(p_command);
+			break;
+
+		case 0x0537:    // bulk read eeprom ack
+			cmd_0537(p_command);
 			break;
 
+		case 0x0539:    // bulk write eeprom
+			cmd_0539(p_command);
+			break;
+
+#ifdef ENABLE_UART_TX_DMA
+		case 0x053B:    // read UART TX queue counters
+			cmd_053B(p_command);
+			break;
+#endif
+
+#ifdef ENABLE_TRACE
+		case 0x053D:    // drain the event trace
+			cmd_053D(p_command);
+			break;
+#endif
+
+#ifdef ENABLE_PROFILE
+		case 0x053F:    // read the cycle profiler table
+			cmd_053F(p_command);
+			break;
+#endif
+
+#ifdef ENABLE_KISS_TNC
+		case 0x0541:    // read the KISS TNC queues and counters
+			cmd_0541(p_command);
+			break;
+#endif
+
 		case 0x05DD:    // reboot
+			EEPROM_Flush();
 			#if defined(ENABLE_OVERLAY)
 				overlay_FLASH_RebootToBootloader();
 			#else
@@ -630,3 +1243,9 @@ void UART_HandleCommand(void)
 			break;
 	}
 }
+
+// called from the 10ms time slice, carries on with a bulk read the TX ring couldn't take in one go
+void UART_process_10ms(void)
+{
+	BulkReadSend();
+}
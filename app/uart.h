@@ -21,6 +21,7 @@
 
 bool UART_IsCommandAvailable(void);
 void UART_HandleCommand(void);
+void UART_process_10ms(void);
 
 #endif
 
@@ -44,6 +44,7 @@
 #if defined(ENABLE_OVERLAY)
 	#include "sram-overlay.h"
 #endif
+#include "ui/main.h"
 #include "ui/menu.h"
 
 static const uint32_t gDefaultFrequencyTable[] =
@@ -771,6 +772,8 @@ void BOARD_EEPROM_load(void)
 	// 0D60..0E27
 	EEPROM_ReadBuffer(0x0D60, g_user_channel_attributes, sizeof(g_user_channel_attributes));
 
+	BOARD_channel_index_build();
+
 	// *****************************
 
 	// 0F30..0F3F .. AES key
@@ -798,6 +801,16 @@ void BOARD_EEPROM_load(void)
 #endif
 }
 
+void BOARD_EEPROM_boot_load(void)
+{	// read the config area in sequential chunks, the field parsers then decode it from RAM
+	EEPROM_StageBegin(0x0C80, 0x2000 - 0x0C80);
+
+	BOARD_EEPROM_load();
+	BOARD_EEPROM_LoadCalibration();
+
+	EEPROM_StageEnd();
+}
+
 void BOARD_EEPROM_LoadCalibration(void)
 {
 //	uint8_t Mic;
@@ -853,29 +866,159 @@ void BOARD_EEPROM_LoadCalibration(void)
 	}
 }
 
-unsigned int BOARD_find_channel(const uint32_t frequency)
+// ***************************************************************************
+// RAM copy of the user channel frequencies and name hashes
+//
+// saves trawling through the (slow bit-banged I2C) eeprom every time we need to
+// find a channel by frequency or check a channel frequency/name.
+// channel_freq_sorted[] holds the valid channels in frequency order (then channel
+// order) for a binary search.
+
+static uint32_t     channel_freq[USER_CHANNEL_LAST + 1];        // 0 = unused channel (attributes say so)
+static uint16_t     channel_name_hash[USER_CHANNEL_LAST + 1];   // 0 = no name
+static uint8_t      channel_freq_sorted[USER_CHANNEL_LAST + 1];
+static unsigned int channel_freq_count;
+
+static void BOARD_read_channel_name(char *s, const unsigned int channel)
+{	// 's' needs to be at least 11 bytes
+	int i;
+
+	memset(s, 0, 11);
+
+	EEPROM_ReadBuffer(0x0F50 + (channel * 16), s + 0, 8);
+	EEPROM_ReadBuffer(0x0F58 + (channel * 16), s + 8, 2);
+
+	for (i = 0; i < 10; i++)
+		if (s[i] < 32 || s[i] > 127)
+			break;                // invalid char
+
+	s[i--] = 0;                   // null term
+
+	while (i >= 0 && s[i] == 32)  // trim trailing spaces
+		s[i--] = 0;               // null term
+}
+
+static uint16_t BOARD_name_hash(const char *s)
+{	// FNV-1a folded down to 16-bits, 0 is kept for 'no name'
+	uint32_t hash = 2166136261u;
+
+	if (*s == 0)
+		return 0;
+
+	while (*s)
+	{
+		hash ^= (uint8_t)*s++;
+		hash *= 16777619u;
+	}
+
+	hash = (hash >> 16) ^ (hash & 0xffff);
+
+	return (hash != 0) ? hash : 1;
+}
+
+static unsigned int BOARD_channel_index_lower_bound(const uint32_t frequency, const unsigned int channel)
+{	// first position in the sorted list that is >= frequency/channel
+	unsigned int lo = 0;
+	unsigned int hi = channel_freq_count;
+
+	while (lo < hi)
+	{
+		const unsigned int mid  = (lo + hi) / 2;
+		const unsigned int chan = channel_freq_sorted[mid];
+
+		if (channel_freq[chan] < frequency || (channel_freq[chan] == frequency && chan < channel))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+static void BOARD_channel_index_remove(const unsigned int channel)
+{
+	const unsigned int i = BOARD_channel_index_lower_bound(channel_freq[channel], channel);
+
+	if (i < channel_freq_count && channel_freq_sorted[i] == channel)
+	{
+		memmove(&channel_freq_sorted[i], &channel_freq_sorted[i + 1], channel_freq_count - i - 1);
+		channel_freq_count--;
+	}
+
+	channel_freq[channel] = 0;
+}
+
+static void BOARD_channel_index_insert(const unsigned int channel)
+{
+	const unsigned int i = BOARD_channel_index_lower_bound(channel_freq[channel], channel);
+
+	memmove(&channel_freq_sorted[i + 1], &channel_freq_sorted[i], channel_freq_count - i);
+	channel_freq_sorted[i] = channel;
+	channel_freq_count++;
+}
+
+void BOARD_channel_index_update(const unsigned int channel)
+{	// re-read the one channel from eeprom, call this after writing a user channel
+	uint32_t frequency = 0;
+	char     name[11];
+
+	if (channel > USER_CHANNEL_LAST)
+		return;
+
+	UI_main_channel_changed(channel);    // the main screen's copy of the name
+
+	BOARD_channel_index_remove(channel);
+	channel_name_hash[channel] = 0;
+
+	if ((g_user_channel_attributes[channel] & USER_CH_BAND_MASK) > BAND7_470MHz)
+		return;
+
+	EEPROM_ReadBuffer(channel * 16, &frequency, 4);
+	channel_freq[channel] = frequency;
+	if (frequency != 0 && frequency != 0xffffffff)
+		BOARD_channel_index_insert(channel);
+
+	BOARD_read_channel_name(name, channel);
+	channel_name_hash[channel] = BOARD_name_hash(name);
+}
+
+void BOARD_channel_index_build(void)
 {
 	unsigned int chan;
-	
+
+	memset(channel_freq,      0, sizeof(channel_freq));
+	memset(channel_name_hash, 0, sizeof(channel_name_hash));
+	channel_freq_count = 0;
+
+	for (chan = 0; chan <= USER_CHANNEL_LAST; chan++)
+		BOARD_channel_index_update(chan);
+}
+
+void BOARD_channel_index_eeprom_written(const unsigned int eeprom_addr)
+{	// keep the index in step with raw eeprom writes (PC programming, aircopy)
+	if (eeprom_addr < ((USER_CHANNEL_LAST + 1) * 16))
+		BOARD_channel_index_update(eeprom_addr / 16);
+	else
+	if (eeprom_addr >= 0x0F50 && eeprom_addr < (0x0F50 + ((USER_CHANNEL_LAST + 1) * 16)))
+		BOARD_channel_index_update((eeprom_addr - 0x0F50) / 16);
+}
+
+uint16_t BOARD_channel_name_hash(const int channel)
+{
+	return (channel >= 0 && channel <= (int)USER_CHANNEL_LAST) ? channel_name_hash[channel] : 0;
+}
+
+unsigned int BOARD_find_channel(const uint32_t frequency)
+{	// lowest numbered user channel with this frequency
+	unsigned int i;
+
 	if (frequency == 0 || frequency == 0xffffffff)
 		return 0xffffffff;
-	
-	for (chan = 0; chan <= USER_CHANNEL_LAST; chan++)
-	{
-		uint32_t chan_freq;
-
-		if ((g_user_channel_attributes[chan] & USER_CH_BAND_MASK) > BAND7_470MHz)
-			continue;
-		
-		EEPROM_ReadBuffer(chan * 16, &chan_freq, 4);
-
-		if (chan_freq == 0 || chan_freq == 0xffffffff)
-			continue;
-		
-		if (chan_freq == frequency)
-			return chan;          // found it
-	}
-	
+
+	i = BOARD_channel_index_lower_bound(frequency, 0);
+	if (i < channel_freq_count && channel_freq[channel_freq_sorted[i]] == frequency)
+		return channel_freq_sorted[i];          // found it
+
 	return 0xffffffff;
 }
 
@@ -889,6 +1032,9 @@ uint32_t BOARD_fetchChannelFrequency(const int channel)
 	if ((g_user_channel_attributes[channel] & USER_CH_BAND_MASK) > BAND7_470MHz)
 		return 0;
 
+	if (channel <= (int)USER_CHANNEL_LAST)
+		return channel_freq[channel];
+
 	EEPROM_ReadBuffer(channel * 16, &frequency, 4);
 
 	return frequency;
@@ -936,8 +1082,6 @@ unsigned int BOARD_fetchFrequencyStepSetting(const int channel, const int vfo)
 
 void BOARD_fetchChannelName(char *s, const int channel)
 {
-	int i;
-
 	if (s == NULL)
 		return;
 
@@ -949,17 +1093,10 @@ void BOARD_fetchChannelName(char *s, const int channel)
 	if (!RADIO_CheckValidChannel(channel, false, 0))
 		return;
 
-	EEPROM_ReadBuffer(0x0F50 + (channel * 16), s + 0, 8);
-	EEPROM_ReadBuffer(0x0F58 + (channel * 16), s + 8, 2);
+	if (channel_name_hash[channel] == 0)
+		return;            // no name, don't bother reading the eeprom
 
-	for (i = 0; i < 10; i++)
-		if (s[i] < 32 || s[i] > 127)
-			break;                // invalid char
-
-	s[i--] = 0;                   // null term
-
-	while (i >= 0 && s[i] == 32)  // trim trailing spaces
-		s[i--] = 0;               // null term
+	BOARD_read_channel_name(s, channel);
 }
 
 void BOARD_FactoryReset(bool bIsAll)
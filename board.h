@@ -27,6 +27,11 @@ void         BOARD_ADC_GetBatteryInfo(uint16_t *pVoltage, uint16_t *pCurrent);
 void         BOARD_Init(void);
 void         BOARD_EEPROM_load(void);
 void         BOARD_EEPROM_LoadCalibration(void);
+void         BOARD_EEPROM_boot_load(void);
+void         BOARD_channel_index_build(void);
+void         BOARD_channel_index_update(const unsigned int channel);
+void         BOARD_channel_index_eeprom_written(const unsigned int eeprom_addr);
+uint16_t     BOARD_channel_name_hash(const int channel);
 unsigned int BOARD_find_channel(const uint32_t frequency);
 uint32_t     BOARD_fetchChannelFrequency(const int channel);
 unsigned int BOARD_fetchChannelStepSetting(const int channel);
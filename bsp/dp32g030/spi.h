@@ -100,6 +100,11 @@ typedef struct {
 #define SPI_CR_TXDMAEN_SHIFT                 14
 #define SPI_CR_TXDMAEN_WIDTH                 1
 #define SPI_CR_TXDMAEN_MASK                  (((1U << SPI_CR_TXDMAEN_WIDTH) - 1U) << SPI_CR_TXDMAEN_SHIFT)
+#define SPI_CR_TXDMAEN_VALUE_DISABLE         0U
+#define SPI_CR_TXDMAEN_BITS_DISABLE          (SPI_CR_TXDMAEN_VALUE_DISABLE << SPI_CR_TXDMAEN_SHIFT)
+#define SPI_CR_TXDMAEN_VALUE_ENABLE          1U
+#define SPI_CR_TXDMAEN_BITS_ENABLE           (SPI_CR_TXDMAEN_VALUE_ENABLE << SPI_CR_TXDMAEN_SHIFT)
+
 #define SPI_CR_RF_CLR_SHIFT                  15
 #define SPI_CR_RF_CLR_WIDTH                  1
 #define SPI_CR_RF_CLR_MASK                   (((1U << SPI_CR_RF_CLR_WIDTH) - 1U) << SPI_CR_RF_CLR_SHIFT)
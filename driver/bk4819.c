@@ -16,6 +16,7 @@
 
 #include <string.h>   // NULL and memset
 
+#include "ARMCM0.h"
 #include "bk4819.h"
 #include "bsp/dp32g030/gpio.h"
 #include "bsp/dp32g030/portcon.h"
@@ -26,10 +27,10 @@
 #ifdef ENABLE_MDC1200
 	#include "mdc1200.h"
 #endif
-#ifdef ENABLE_FSK_MODEM
-	#include "app/uart.h"
-	#include "external/printf/printf.h"
-#endif // ENABLE_FSK_MODEM
+#include "trace.h"
+#ifdef HOST_BUILD
+	#include "host/hal.h"
+#endif
 
 #ifndef ARRAY_SIZE
 	#define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
@@ -37,6 +38,10 @@
 
 static uint16_t gBK4819_GpioOutState;
 
+#ifdef ENABLE_BK4819_REG_CACHE
+	static void BK4819_RegCacheInit(void);
+#endif
+
 bool g_rx_idle_mode;
 
 __inline uint16_t scale_freq(const uint16_t freq)
@@ -47,6 +52,10 @@ __inline uint16_t scale_freq(const uint16_t freq)
 
 void BK4819_Init(void)
 {
+	#ifdef ENABLE_BK4819_REG_CACHE
+		BK4819_RegCacheInit();
+	#endif
+
 	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
 	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
 	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
@@ -148,6 +157,64 @@ void BK4819_Init(void)
 #endif
 }
 
+// bus timing .. SYSTICK_DelayUs(1) really costs a couple of us once the call and SysTick
+// polling overhead are added, the BK4819 only needs a few hundred ns per clock phase.
+// 8 NOPs + the GPIO read-modify-write is about 14 cycles (~290ns @ 48MHz) per phase
+#define BK4819_BUS_DELAY()  do { __NOP(); __NOP(); __NOP(); __NOP(); __NOP(); __NOP(); __NOP(); __NOP(); } while (0)
+
+#ifndef HOST_BUILD
+	#define BK4819_SCN_HIGH()   (GPIOC->DATA |=  (1u << GPIOC_PIN_BK4819_SCN))
+	#define BK4819_SCN_LOW()    (GPIOC->DATA &= ~(1u << GPIOC_PIN_BK4819_SCN))
+	#define BK4819_SCL_HIGH()   (GPIOC->DATA |=  (1u << GPIOC_PIN_BK4819_SCL))
+	#define BK4819_SCL_LOW()    (GPIOC->DATA &= ~(1u << GPIOC_PIN_BK4819_SCL))
+	#define BK4819_SDA_HIGH()   (GPIOC->DATA |=  (1u << GPIOC_PIN_BK4819_SDA))
+	#define BK4819_SDA_LOW()    (GPIOC->DATA &= ~(1u << GPIOC_PIN_BK4819_SDA))
+	#define BK4819_SDA_READ()   ((GPIOC->DATA >> GPIOC_PIN_BK4819_SDA) & 1u)
+#else
+	// host build (make host), the pins drive the BK4819 model in host/bk4819_model.c
+	#define BK4819_SCN_HIGH()   HOST_bk4819_pin(GPIOC_PIN_BK4819_SCN, 1)
+	#define BK4819_SCN_LOW()    HOST_bk4819_pin(GPIOC_PIN_BK4819_SCN, 0)
+	#define BK4819_SCL_HIGH()   HOST_bk4819_pin(GPIOC_PIN_BK4819_SCL, 1)
+	#define BK4819_SCL_LOW()    HOST_bk4819_pin(GPIOC_PIN_BK4819_SCL, 0)
+	#define BK4819_SDA_HIGH()   HOST_bk4819_pin(GPIOC_PIN_BK4819_SDA, 1)
+	#define BK4819_SDA_LOW()    HOST_bk4819_pin(GPIOC_PIN_BK4819_SDA, 0)
+	#define BK4819_SDA_READ()   HOST_bk4819_sda()
+#endif
+
+static void BK4819_WriteBits(uint32_t Data, unsigned int bits)
+{	// MSB first, data is clocked in on the rising edge of SCL
+	Data <<= 32 - bits;
+	while (bits-- > 0)
+	{
+		if (Data & 0x80000000u)
+			BK4819_SDA_HIGH();
+		else
+			BK4819_SDA_LOW();
+		BK4819_BUS_DELAY();
+		BK4819_SCL_HIGH();
+		Data <<= 1;
+		BK4819_BUS_DELAY();
+		BK4819_SCL_LOW();
+	}
+}
+
+static void BK4819_BusStart(void)
+{	// park the clock and take the chip select
+	BK4819_SCN_HIGH();
+	BK4819_SCL_LOW();
+	BK4819_BUS_DELAY();
+	BK4819_SCN_LOW();
+}
+
+static void BK4819_BusStop(void)
+{	// release the chip select (the register is latched here) and return the bus to idle
+	BK4819_BUS_DELAY();
+	BK4819_SCN_HIGH();
+	BK4819_BUS_DELAY();
+	BK4819_SCL_HIGH();
+	BK4819_SDA_HIGH();
+}
+
 static uint16_t BK4819_ReadU16(void)
 {
 	unsigned int i;
@@ -155,17 +222,17 @@ static uint16_t BK4819_ReadU16(void)
 
 	PORTCON_PORTC_IE = (PORTCON_PORTC_IE & ~PORTCON_PORTC_IE_C2_MASK) | PORTCON_PORTC_IE_C2_BITS_ENABLE;
 	GPIOC->DIR = (GPIOC->DIR & ~GPIO_DIR_2_MASK) | GPIO_DIR_2_BITS_INPUT;
-	SYSTICK_DelayUs(1);
+	BK4819_BUS_DELAY();
 
 	Value = 0;
 	for (i = 0; i < 16; i++)
 	{
 		Value <<= 1;
-		Value |= GPIO_CheckBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
-		GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
-		SYSTICK_DelayUs(1);
-		GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
-		SYSTICK_DelayUs(1);
+		Value |= BK4819_SDA_READ();
+		BK4819_SCL_HIGH();
+		BK4819_BUS_DELAY();
+		BK4819_SCL_LOW();
+		BK4819_BUS_DELAY();
 	}
 	PORTCON_PORTC_IE = (PORTCON_PORTC_IE & ~PORTCON_PORTC_IE_C2_MASK) | PORTCON_PORTC_IE_C2_BITS_DISABLE;
 	GPIOC->DIR = (GPIOC->DIR & ~GPIO_DIR_2_MASK) | GPIO_DIR_2_BITS_OUTPUT;
@@ -173,96 +240,192 @@ static uint16_t BK4819_ReadU16(void)
 	return Value;
 }
 
-uint16_t BK4819_ReadRegister(bk4819_register_t Register)
-{
-	uint16_t Value;
-
-	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
-	GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
+#ifdef ENABLE_BK4819_REG_CACHE
+	// write-through shadow copy of the BK4819 config registers
+	//
+	// only registers that never change unless we write them are cached, the rest ..
+	//   REG_00 soft reset
+	//   REG_02 interrupt status, REG_0B/0C/0D/0E status
+	//   REG_06/07/08/09 indexed tables (the top bits of the value select the sub-register)
+	//   REG_5F FSK FIFO
+	//   REG_63..REG_6F RSSI/noise/glitch/tone readings
+	// .. always go to the chip
+	//
+	// REG_59 is cached for reads but always written, it has the self clearing FIFO clear bits
 
-	SYSTICK_DelayUs(1);
+	static const uint8_t reg_cache_list[] = {
+		0x10, 0x11, 0x12, 0x13, 0x14, 0x19, 0x1E, 0x1F,
+		0x20, 0x21, 0x24, 0x26, 0x28, 0x29, 0x2A, 0x2B, 0x2C,
+		0x30, 0x31, 0x32, 0x33, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F,
+		0x43, 0x46, 0x47, 0x48, 0x49, 0x4B, 0x4D, 0x4E, 0x4F,
+		0x50, 0x51, 0x52, 0x53, 0x58, 0x59, 0x5A, 0x5B, 0x5C, 0x5D, 0x5E,
+		0x70, 0x71, 0x72, 0x77, 0x78, 0x79, 0x7A, 0x7B, 0x7C, 0x7D, 0x7E
+	};
 
-	GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
-	BK4819_WriteU8(Register | 0x80);
-	Value = BK4819_ReadU16();
-	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
+	static uint32_t reg_cache_cacheable[128 / 32];
+	static uint32_t reg_cache_valid[128 / 32];
+	static uint16_t reg_cache[128];
 
-	SYSTICK_DelayUs(1);
+	BK4819_reg_cache_stats_t g_bk4819_reg_cache_stats;
 
-	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
-	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
+	#define REG_CACHE_TEST(bits, reg)  (((bits)[(reg) >> 5] >> ((reg) & 31u)) & 1u)
+	#define REG_CACHE_SET(bits, reg)   ((bits)[(reg) >> 5] |= 1u << ((reg) & 31u))
 
-	return Value;
-}
+	static void BK4819_RegCacheInit(void)
+	{
+		unsigned int i;
+		memset(reg_cache_cacheable, 0, sizeof(reg_cache_cacheable));
+		memset(reg_cache_valid,     0, sizeof(reg_cache_valid));
+		for (i = 0; i < ARRAY_SIZE(reg_cache_list); i++)
+			REG_CACHE_SET(reg_cache_cacheable, reg_cache_list[i]);
+	}
 
-void BK4819_WriteRegister(bk4819_register_t Register, uint16_t Data)
-{
-	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
-	GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
+	static void BK4819_RegCacheStore(const bk4819_register_t Register, const uint16_t Data, const unsigned int writes)
+	{	// 'writes' values are about to go out on the bus, 'Data' being the last of them
+		const unsigned int reg = Register & 0x7Fu;
 
-	SYSTICK_DelayUs(1);
+		if (!REG_CACHE_TEST(reg_cache_cacheable, reg))
+		{
+			if (Register == BK4819_REG_00)
+				memset(reg_cache_valid, 0, sizeof(reg_cache_valid));   // chip reset, forget everything
+			g_bk4819_reg_cache_stats.uncached += writes;
+			return;
+		}
 
-	GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
-	BK4819_WriteU8(Register);
+		reg_cache[reg] = Data;
+		REG_CACHE_SET(reg_cache_valid, reg);
+		g_bk4819_reg_cache_stats.writes += writes;
+	}
 
-	SYSTICK_DelayUs(1);
+	static bool BK4819_RegCacheWrite(const bk4819_register_t Register, const uint16_t Data)
+	{	// returns false if the write can be skipped
+		const unsigned int reg = Register & 0x7Fu;
 
-	BK4819_WriteU16(Data);
+		if (REG_CACHE_TEST(reg_cache_valid, reg) && reg_cache[reg] == Data && Register != BK4819_REG_59)
+		{
+			g_bk4819_reg_cache_stats.write_skips++;
+			return false;
+		}
 
-	SYSTICK_DelayUs(1);
+		BK4819_RegCacheStore(Register, Data, 1);
+		return true;
+	}
+#endif
 
-	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
+static uint16_t BK4819_ReadRegisterBus(bk4819_register_t Register)
+{
+	uint16_t Value;
 
-	SYSTICK_DelayUs(1);
+	BK4819_BusStart();
+	BK4819_WriteBits(Register | 0x80, 8);
+	Value = BK4819_ReadU16();
+	BK4819_BusStop();
 
-	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
-	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
+	return Value;
 }
 
-void BK4819_WriteU8(uint8_t Data)
+uint16_t BK4819_ReadRegister(bk4819_register_t Register)
 {
-	unsigned int i;
-
-	GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
-	for (i = 0; i < 8; i++)
-	{
-		if ((Data & 0x80) == 0)
-			GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
-		else
-			GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
+	#ifdef ENABLE_BK4819_REG_CACHE
+		const unsigned int reg = Register & 0x7Fu;
+		if (REG_CACHE_TEST(reg_cache_cacheable, reg))
+		{
+			if (REG_CACHE_TEST(reg_cache_valid, reg))
+			{
+				g_bk4819_reg_cache_stats.read_hits++;
+				return reg_cache[reg];
+			}
+			g_bk4819_reg_cache_stats.read_misses++;
+			reg_cache[reg] = BK4819_ReadRegisterBus(Register);
+			REG_CACHE_SET(reg_cache_valid, reg);
+			return reg_cache[reg];
+		}
+		g_bk4819_reg_cache_stats.uncached++;
+	#endif
 
-		SYSTICK_DelayUs(1);
-		GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
-		SYSTICK_DelayUs(1);
+	return BK4819_ReadRegisterBus(Register);
+}
 
-		Data <<= 1;
+void BK4819_WriteRegister(bk4819_register_t Register, uint16_t Data)
+{
+	#ifdef ENABLE_BK4819_REG_CACHE
+		if (!BK4819_RegCacheWrite(Register, Data))
+			return;
+	#endif
 
-		GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
-		SYSTICK_DelayUs(1);
-	}
+	BK4819_BusStart();
+	BK4819_WriteBits(((uint32_t)Register << 16) | Data, 24);
+	BK4819_BusStop();
 }
 
-void BK4819_WriteU16(uint16_t Data)
-{
+void BK4819_WriteRegisters(const bk4819_reg_pair_t *pPairs, const unsigned int Count)
+{	// the chip latches each register when SCN goes high, so SCN is only released for
+	// one bus delay between the frames, the bus is parked just the once at the end
 	unsigned int i;
+	unsigned int frames = 0;
 
-	GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
-	for (i = 0; i < 16; i++)
+	for (i = 0; i < Count; i++)
 	{
-		if ((Data & 0x8000) == 0)
-			GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
+		#ifdef ENABLE_BK4819_REG_CACHE
+			if (!BK4819_RegCacheWrite(pPairs[i].reg, pPairs[i].data))
+				continue;
+		#endif
+
+		if (frames++ == 0)
+		{
+			BK4819_BusStart();
+		}
 		else
-			GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
+		{
+			BK4819_BUS_DELAY();
+			BK4819_SCN_HIGH();
+			BK4819_BUS_DELAY();
+			BK4819_SCN_LOW();
+		}
+		BK4819_WriteBits(((uint32_t)pPairs[i].reg << 16) | pPairs[i].data, 24);
+	}
 
-		SYSTICK_DelayUs(1);
-		GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
+	if (frames > 0)
+		BK4819_BusStop();
+}
 
-		Data <<= 1;
+void BK4819_WriteRegisterBlock(bk4819_register_t Register, const uint16_t *pData, const unsigned int Count)
+{	// same as BK4819_WriteRegisters() but for one register, mainly for loading the FSK TX FIFO
+	unsigned int i;
+
+	if (Count == 0)
+		return;
+
+	#ifdef ENABLE_BK4819_REG_CACHE
+		// every value is sent (FIFO loads repeat values), the cache only keeps the last one
+		BK4819_RegCacheStore(Register, pData[Count - 1], Count);
+	#endif
 
-		SYSTICK_DelayUs(1);
-		GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
-		SYSTICK_DelayUs(1);
+	BK4819_BusStart();
+	for (i = 0; i < Count; i++)
+	{
+		if (i > 0)
+		{
+			BK4819_BUS_DELAY();
+			BK4819_SCN_HIGH();
+			BK4819_BUS_DELAY();
+			BK4819_SCN_LOW();
+		}
+		BK4819_WriteBits(((uint32_t)Register << 16) | pData[i], 24);
 	}
+	BK4819_BusStop();
+}
+
+void BK4819_WriteU8(uint8_t Data)
+{
+	BK4819_SCL_LOW();
+	BK4819_WriteBits(Data, 8);
+}
+
+void BK4819_WriteU16(uint16_t Data)
+{
+	BK4819_SCL_LOW();
+	BK4819_WriteBits(Data, 16);
 }
 
 void BK4819_SetAGC(uint8_t Value)
@@ -741,8 +904,12 @@ void BK4819_SetupPowerAmplifier(const uint8_t bias, const uint32_t frequency)
 
 void BK4819_set_rf_frequency(const uint32_t frequency, const bool trigger_update)
 {
-	BK4819_WriteRegister(BK4819_REG_38, (frequency >>  0) & 0xFFFF);
-	BK4819_WriteRegister(BK4819_REG_39, (frequency >> 16) & 0xFFFF);
+	const bk4819_reg_pair_t regs[] = {
+		{BK4819_REG_38, (frequency >>  0) & 0xFFFF},
+		{BK4819_REG_39, (frequency >> 16) & 0xFFFF}
+	};
+
+	BK4819_WriteRegisters(regs, ARRAY_SIZE(regs));
 
 	if (trigger_update)
 	{
@@ -766,14 +933,14 @@ void BK4819_set_rf_frequency(const uint32_t frequency, const bool trigger_update
 	}
 }
 
-void BK4819_SetupSquelch(
+void BK4819_SetSquelchThresholds(
 		uint8_t squelch_open_rssi_thresh,
 		uint8_t squelch_close_rssi_thresh,
 		uint8_t squelch_open_noise_thresh,
 		uint8_t squelch_close_noise_thresh,
 		uint8_t squelch_close_glitch_thresh,
 		uint8_t squelch_open_glitch_thresh)
-{
+{	// just the threshold registers, the receiver is left running
 	// REG_70
 	//
 	// <15>   0 Enable TONE1
@@ -790,13 +957,14 @@ void BK4819_SetupSquelch(
 	// <6:0>  0 TONE2/FSK tuning gain
 	//        0 ~ 127
 	//
-	BK4819_WriteRegister(BK4819_REG_70, 0);
+	const bk4819_reg_pair_t regs[] = {
+		{BK4819_REG_70, 0},
 
 	// Glitch threshold for Squelch = close
 	//
 	// 0 ~ 255
 	//
-	BK4819_WriteRegister(BK4819_REG_4D, 0xA000 | squelch_close_glitch_thresh);
+		{BK4819_REG_4D, 0xA000 | squelch_close_glitch_thresh},
 
 	// REG_4E
 	//
@@ -813,13 +981,13 @@ void BK4819_SetupSquelch(
 	// <7:0>   8 Glitch threshold for Squelch = open
 	//         0 ~ 255
 	//
-	BK4819_WriteRegister(BK4819_REG_4E,  // 01 101 11 1 00000000
+		{BK4819_REG_4E,  // 01 101 11 1 00000000
 //	#ifndef ENABLE_FASTER_CHANNEL_SCAN
 		// original (*)
 		(1u << 14) |                  // 1 ???
 		(5u << 11) |                  // 5  squelch = open  delay .. 0 ~ 7
 		(6u <<  9) |                  // *3  squelch = close delay .. 0 ~ 3
-		squelch_open_glitch_thresh);  // 0 ~ 255
+		squelch_open_glitch_thresh},  // 0 ~ 255
 //	#else
 		// faster (but twitchier)
 //		(1u << 14) |                  //  1 ???
@@ -838,7 +1006,7 @@ void BK4819_SetupSquelch(
 	// <6:0>  46 Ex-noise threshold for Squelch = open
 	//        0 ~ 127
 	//
-	BK4819_WriteRegister(BK4819_REG_4F, ((uint16_t)squelch_close_noise_thresh << 8) | squelch_open_noise_thresh);
+		{BK4819_REG_4F, ((uint16_t)squelch_close_noise_thresh << 8) | squelch_open_noise_thresh},
 
 	// REG_78
 	//
@@ -846,7 +1014,24 @@ void BK4819_SetupSquelch(
 	//
 	// <7:0>  70 RSSI threshold for Squelch = close   0.5dB/step
 	//
-	BK4819_WriteRegister(BK4819_REG_78, ((uint16_t)squelch_open_rssi_thresh   << 8) | squelch_close_rssi_thresh);
+		{BK4819_REG_78, ((uint16_t)squelch_open_rssi_thresh   << 8) | squelch_close_rssi_thresh}
+	};
+
+	BK4819_WriteRegisters(regs, ARRAY_SIZE(regs));
+}
+
+void BK4819_SetupSquelch(
+		uint8_t squelch_open_rssi_thresh,
+		uint8_t squelch_close_rssi_thresh,
+		uint8_t squelch_open_noise_thresh,
+		uint8_t squelch_close_noise_thresh,
+		uint8_t squelch_close_glitch_thresh,
+		uint8_t squelch_open_glitch_thresh)
+{
+	BK4819_SetSquelchThresholds(
+		squelch_open_rssi_thresh,    squelch_close_rssi_thresh,
+		squelch_open_noise_thresh,   squelch_close_noise_thresh,
+		squelch_close_glitch_thresh, squelch_open_glitch_thresh);
 
 	BK4819_SetAF(BK4819_AF_MUTE);
 
@@ -2119,12 +2304,8 @@ void BK4819_PlayRogerMDC1200(void)
 //	BK4819_WriteRegister(BK4819_REG_5C, 0xAA30);   // 101010100 0 110000
 	BK4819_WriteRegister(BK4819_REG_5C, 0);        // setting to '0' doesn't make any difference !
 
-	{	// load the entire packet data into the TX FIFO buffer
-		unsigned int i;
-		const uint16_t *p = (const uint16_t *)packet;
-		for (i = 0; i < (size / sizeof(p[0])); i++)
-			BK4819_WriteRegister(BK4819_REG_5F, p[i]);  // load 16-bits at a time
-	}
+	// load the entire packet data into the TX FIFO buffer, 16-bits at a time
+	BK4819_WriteRegisterBlock(BK4819_REG_5F, (const uint16_t *)packet, size / sizeof(uint16_t));
 
 	// enable tx interrupt
 	BK4819_WriteRegister(BK4819_REG_3F, BK4819_REG_3F_FSK_TX_FINISHED);
@@ -2195,6 +2376,58 @@ void BK4819_PlayDTMFEx(bool bLocalLoopback, char Code)
 
 #ifdef ENABLE_FSK_MODEM
 
+#define TX_FIFO_LOW_THRESHOLD_WORDS  64   // 128 bytes --- default is 128 bytes (64 words)
+#define RX_FIFO_HIGH_THRESHOLD_WORDS 4    // 8 bytes --- default is 8 bytes (4 words)
+
+enum fsk_tx_state_e {
+	FSK_TX_STATE_IDLE = 0,
+	FSK_TX_STATE_SENDING
+};
+typedef enum fsk_tx_state_e fsk_tx_state_t;
+
+// the TX engine, the FIFO is refilled from BK4819_FskProcessInterrupts() so the caller never blocks
+static struct {
+	const uint16_t       *data;
+	uint16_t              len_words;
+	uint16_t              index;           // next word to load into the FIFO
+	uint16_t              timeout_10ms;
+	uint16_t              reg59;
+	fsk_tx_state_t        state;
+	BK4819_fsk_tx_done_t  done;
+} fsk_tx;
+
+// air time of one 16-bit word, set by BK4819_FskEnterMode()
+static uint8_t fsk_ms_per_word = 14;
+
+// RX ring entry header word, one in front of every received packet
+#define FSK_RX_HDR_MASK_LEN    0x07FFu        // 0 ~ 1024 words
+#define FSK_RX_HDR_CRC_OK      (1u << 15)
+#define FSK_RX_HDR_SHORT       (1u << 14)    // RX finished before all the words arrived
+
+#define FSK_RX_RING_MASK       (BK4819_FSK_RX_RING_WORDS - 1u)
+
+#if (BK4819_FSK_RX_RING_WORDS & FSK_RX_RING_MASK) != 0
+	#error "BK4819_FSK_RX_RING_WORDS must be a power of 2"
+#endif
+
+// the RX engine, a single producer (BK4819_FskProcessInterrupts) single consumer (BK4819_FskReadPacket)
+// ring .. the producer only publishes 'head' once a whole packet is in, the consumer only moves 'tail'
+static uint16_t fsk_rx_ring[BK4819_FSK_RX_RING_WORDS];
+
+static struct {
+	volatile uint16_t head;                // end of the last complete packet, written by the producer only
+	volatile uint16_t tail;                // start of the next unread packet, written by the consumer only
+	uint16_t          wr;                  // producer's write position in the packet being received
+	uint16_t          hdr;                 // where the header of the packet being received goes
+	uint16_t          len_words;           // configured packet length
+	uint16_t          received;            // words received so far in this packet
+	uint16_t          reg59;
+	bool              active;
+	bool              dropping;            // no room in the ring, discard this packet
+} fsk_rx;
+
+BK4819_fsk_rx_stats_t g_fsk_rx_stats;
+
 /** The BK4819 can send FSK packets with (pag.10 of 'BK4819(V3) Application Note 20210428.pdf'):
  * 1 to 16 preamble bytes
  * 2 or 4 sync bytes
@@ -2225,9 +2458,15 @@ void BK4819_FskEnterMode(
 	BK4819_WriteRegister(BK4819_REG_70, BK4819_REG_70_ENABLE_TONE2 | fskTone2Gain); // Tone2 gain: 0-127
 
 	if(fskModulationType == FSK_MODULATION_TYPE_FSK1K2 || fskModulationType == FSK_MODULATION_TYPE_MSK1200_1800)
+	{
 		BK4819_WriteRegister(BK4819_REG_72, scale_freq(1200)); // FSK 1K2 and MSK 1200/1800 are at 1200 bps
+		fsk_ms_per_word = 14;                                  // 13.3ms rounded up
+	}
 	else
+	{
 		BK4819_WriteRegister(BK4819_REG_72, scale_freq(2400)); // FSK 2K4 and MSK 1200/2400 are at 2400 bps
+		fsk_ms_per_word = 7;                                   // 6.7ms rounded up
+	}
 
 	// FSK Enable, RX Bandwidth FFSK1200/1800, 0xAA or 0x55 Preamble, 11 RX Gain,
 	// 101 RX Mode, FFSK1200/1800 TX
@@ -2346,168 +2585,331 @@ void BK4819_FskIdle(void)
 FSK_IRQ_t BK4819_FskCheckInterrupt(void)
 {
 	uint16_t reg0c_irq = BK4819_ReadRegister(BK4819_REG_0C);
-	printf("BK4819_REG_0C 0x%04x\r\n", reg0c_irq);
+	uint16_t reg02_irq = 0;
+	FSK_IRQ_t irq      = FSK_OTHER;
 
 	if (reg0c_irq & (1u << 0))
 	{	// we have some interrupt flags, let's read the REG_02, to check which are
 		BK4819_WriteRegister(BK4819_REG_02, 0);
-		uint16_t reg02_irq = BK4819_ReadRegister(BK4819_REG_02);
-		printf("BK4819_REG_02 0x%04x\r\n", reg02_irq);
+		reg02_irq = BK4819_ReadRegister(BK4819_REG_02);
 
 		if (reg02_irq & BK4819_REG_02_MASK_FSK_TX_FINISHED)
-		{
-			printf("interrupt BK4819_REG_02_FSK_TX_FINISHED\r\n");
-			return FSK_TX_FINISHED;
-		}
-
+			irq = FSK_TX_FINISHED;
+		else
 		if (reg02_irq & BK4819_REG_02_MASK_FSK_FIFO_ALMOST_EMPTY)
-		{
-			printf("interrupt BK4819_REG_02_FSK_FIFO_ALMOST_EMPTY\r\n");
-			return FSK_FIFO_ALMOST_EMPTY;
-		}
-
+			irq = FSK_FIFO_ALMOST_EMPTY;
+		else
 		if (reg02_irq & BK4819_REG_02_MASK_FSK_RX_FINISHED)
-		{
-			printf("interrupt BK4819_REG_02_FSK_RX_FINISHED\r\n");
-			return FSK_RX_FINISHED;
-		}
-
+			irq = FSK_RX_FINISHED;
+		else
 		if (reg02_irq & BK4819_REG_02_MASK_FSK_FIFO_ALMOST_FULL)
+			irq = FSK_FIFO_ALMOST_FULL;
+		else
+		if (reg02_irq & BK4819_REG_02_MASK_FSK_RX_SYNC)
+			irq = FSK_RX_SYNC;
+	}
+
+	TRACE(TRACE_ID_BK4819_IRQ, reg0c_irq, reg02_irq);
+
+	return irq;
+}
+
+static void BK4819_FskTxRefill(const unsigned int max_words)
+{	// burst as many words as we have room for into the TX FIFO, no per-word delays
+	unsigned int n = fsk_tx.len_words - fsk_tx.index;
+	if (n > max_words)
+		n = max_words;
+	BK4819_WriteRegisterBlock(BK4819_REG_5F, &fsk_tx.data[fsk_tx.index], n);  // load 16-bits at a time
+	TRACE(TRACE_ID_FSK_TX_REFILL, fsk_tx.index, n);
+	fsk_tx.index += n;
+}
+
+static void BK4819_FskTxEnd(const bool ok)
+{
+	const BK4819_fsk_tx_done_t done = fsk_tx.done;
+
+	TRACE(TRACE_ID_FSK_TX_END, ok, fsk_tx.index);
+
+	GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_FLASHLIGHT);
+
+	// clear fifo and stop tx, we don't shut off the TX PA, as maybe there are other packets to be sent
+	BK4819_WriteRegister(BK4819_REG_59, fsk_tx.reg59 | BK4819_REG_59_MASK_FSK_CLEAR_TX_FIFO);
+	BK4819_WriteRegister(BK4819_REG_59, fsk_tx.reg59);
+	BK4819_WriteRegister(BK4819_REG_3F, 0);        // disable the FSK TX interrupts
+
+	fsk_tx.state = FSK_TX_STATE_IDLE;
+	fsk_tx.done  = NULL;
+
+	if (done != NULL)
+		done(ok);      // the callback is free to start the next packet
+}
+
+static void BK4819_FskRxArm(void)
+{
+	fsk_rx.received = 0;
+	fsk_rx.dropping = false;
+
+	BK4819_WriteRegister(BK4819_REG_59, fsk_rx.reg59 | BK4819_REG_59_MASK_FSK_CLEAR_RX_FIFO);
+	BK4819_WriteRegister(BK4819_REG_59, fsk_rx.reg59 | BK4819_REG_59_MASK_FSK_ENABLE_RX);
+}
+
+static void BK4819_FskRxDrain(unsigned int max_words)
+{
+	unsigned int n = fsk_rx.len_words - fsk_rx.received;
+
+	if (n > max_words)
+		n = max_words;
+	if (n == 0)
+		return;
+
+	if (fsk_rx.received == 0)
+	{	// start of a new packet, make sure the whole of it plus its header fits in the ring
+		const uint16_t used = fsk_rx.wr - fsk_rx.tail;
+		if ((used + fsk_rx.len_words + 1u) > BK4819_FSK_RX_RING_WORDS)
 		{
-			printf("interrupt BK4819_REG_02_FSK_FIFO_ALMOST_FULL\r\n");
-			return FSK_FIFO_ALMOST_FULL;
+			fsk_rx.dropping = true;
+			g_fsk_rx_stats.overruns++;
 		}
+		else
+			fsk_rx.hdr = fsk_rx.wr++;
+	}
 
-		if (reg02_irq & BK4819_REG_02_MASK_FSK_RX_SYNC)
+	fsk_rx.received += n;
+
+	TRACE(TRACE_ID_FSK_RX_DRAIN, n, fsk_rx.received);
+
+	while (n-- > 0)
+	{
+		const uint16_t word = BK4819_ReadRegister(BK4819_REG_5F);
+		if (!fsk_rx.dropping)
+			fsk_rx_ring[fsk_rx.wr++ & FSK_RX_RING_MASK] = word;
+	}
+}
+
+static void BK4819_FskRxEnd(void)
+{
+	if (fsk_rx.received > 0 && !fsk_rx.dropping)
+	{
+		uint16_t hdr = fsk_rx.received;
+
+		// REG_0B <4> FSK RX CRC indicator .. doc says 1 = CRC OK, but the original firmware treats 1 as a fail
+		if ((BK4819_ReadRegister(BK4819_REG_0B) & (1u << 4)) == 0)
+			hdr |= FSK_RX_HDR_CRC_OK;
+		else
+			g_fsk_rx_stats.crc_errors++;
+
+		if (fsk_rx.received < fsk_rx.len_words)
 		{
-			printf("interrupt BK4819_REG_02_FSK_RX_SYNC\r\n");
-			return FSK_RX_SYNC;
+			hdr |= FSK_RX_HDR_SHORT;
+			g_fsk_rx_stats.short_packets++;
 		}
+
+		fsk_rx_ring[fsk_rx.hdr & FSK_RX_RING_MASK] = hdr;
+
+		__asm volatile ("" ::: "memory");   // packet data must be in place before it's published
+		fsk_rx.head = fsk_rx.wr;
+
+		g_fsk_rx_stats.packets++;
+
+		TRACE(TRACE_ID_FSK_RX_PACKET, fsk_rx.received, hdr);
 	}
 
-	return FSK_OTHER;
+	BK4819_FskRxArm();
 }
 
-int16_t BK4819_FskTransmitPacket(void * tx_buffer_ptr, uint16_t tx_packet_len_bytes)
+int16_t BK4819_FskTransmitPacket(const void *tx_buffer_ptr, const uint16_t tx_packet_len_bytes, BK4819_fsk_tx_done_t done)
 {
-	#define BK4819_FIFO_DIM_WORDS 		128  // 256 bytes
-	#define BK4819_MAX_PACKET_LEN_WORDS 1024 // 2048 bytes
-	#define TX_FIFO_LOW_THRESHOLD_WORDS 64   // 128 bytes --- default is 128 bytes (64 words)
-	#define TX_FIFO_CHUNKS_DIM_WORDS 	(BK4819_FIFO_DIM_WORDS - TX_FIFO_LOW_THRESHOLD_WORDS)
+	const uint16_t len_words = tx_packet_len_bytes / 2;
 
-	if(tx_packet_len_bytes > (BK4819_MAX_PACKET_LEN_WORDS * 2))
-	{
+	if (fsk_tx.state != FSK_TX_STATE_IDLE)
+		return -1;             // busy sending the previous packet
+
+	// the FIFO is loaded a whole word at a time straight from the callers buffer,
+	// an odd length would send a byte from past the end of it
+	if ((tx_packet_len_bytes & 1u) != 0 || len_words == 0 || len_words > BK4819_MAX_PACKET_LEN_WORDS)
 		return -1;
-	}
 
-	//uint16_t local_buffer_U16[(tx_packet_len_bytes / 2)];
-	//uint16_t local_packet_len_words = tx_packet_len_bytes / 2;
+	if (fsk_rx.active)
+		BK4819_FskStopReceive();   // half duplex, the receiver has to be restarted once we're done
+
+	fsk_tx.data      = (const uint16_t *)tx_buffer_ptr;   // tx_buffer_ptr can be of whatever type
+	fsk_tx.len_words = len_words;
+	fsk_tx.index     = 0;
+	fsk_tx.done      = done;
 
-	//memcpy(local_buffer_U16, (uint16_t *)tx_buffer_ptr, local_packet_len_words);
+	// worst case air time of the packet plus preamble/sync, and a little extra
+	fsk_tx.timeout_10ms = ((len_words * fsk_ms_per_word) / 10) + (500 / 10);
 
 	// set up custom tx fifo low threshold
-	uint16_t reg5E_fifo = BK4819_ReadRegister(BK4819_REG_5E);
-	//printf("BK4819_REG_5E: 0x%02x\r\n", reg5E_fifo);
+	const uint16_t reg5E_fifo = BK4819_ReadRegister(BK4819_REG_5E);
 	BK4819_WriteRegister(BK4819_REG_5E, (reg5E_fifo & ~BK4819_REG_5E_MASK_FSK_TX_FIFO_THRESHOLD) | (TX_FIFO_LOW_THRESHOLD_WORDS << BK4819_REG_5E_SHIFT_FSK_TX_FIFO_THRESHOLD));
 
-	// enable TX interrupt
+	{	// set the packet length (bytes - 1) .. low 8 bits in <15:8>, high 3 bits in <7:5>
+		const uint16_t size = (len_words * 2u) - 1u;
+		BK4819_WriteRegister(BK4819_REG_5D,
+			((size << BK4819_REG_5D_SHIFT_FSK_DATA_LENGTH_LOW) & BK4819_REG_5D_MASK_FSK_DATA_LENGTH_LOW) |
+			(((size >> 8) << BK4819_REG_5D_SHIFT_FSK_DATA_LENGTH_HIGH) & BK4819_REG_5D_MASK_FSK_DATA_LENGTH_HIGH));
+	}
+
+	// enable TX interrupts
 	BK4819_WriteRegister(BK4819_REG_3F, BK4819_REG_3F_FSK_TX_FINISHED | BK4819_REG_3F_FSK_FIFO_ALMOST_EMPTY); // unfortunately the BK4819_REG_02_FSK_FIFO_ALMOST_FULL is not triggered in TX
+	BK4819_WriteRegister(BK4819_REG_02, 0);        // clear any stale interrupt flags
 
-	// clear tx fifo and enable tx
-	uint16_t reg59_fsk = BK4819_ReadRegister(BK4819_REG_59);
-	//printf("BK4819_REG_59: 0x%02x\r\n", reg59_fsk);
-	// flush FIFO
-	BK4819_WriteRegister(BK4819_REG_59, reg59_fsk | BK4819_REG_59_MASK_FSK_ENABLE_TX | BK4819_REG_59_MASK_FSK_CLEAR_TX_FIFO);
-	BK4819_WriteRegister(BK4819_REG_59, reg59_fsk | BK4819_REG_59_MASK_FSK_ENABLE_TX);
+	// flush the FIFO
+	fsk_tx.reg59 = BK4819_ReadRegister(BK4819_REG_59) & ~(BK4819_REG_59_MASK_FSK_ENABLE_TX | BK4819_REG_59_MASK_FSK_CLEAR_TX_FIFO);
+	BK4819_WriteRegister(BK4819_REG_59, fsk_tx.reg59 | BK4819_REG_59_MASK_FSK_CLEAR_TX_FIFO);
+	BK4819_WriteRegister(BK4819_REG_59, fsk_tx.reg59);
 
-	uint16_t i;
-	bool jump_to_end = false;
-	const uint16_t *p = (const uint16_t *)tx_buffer_ptr; // tx_buffer_ptr can be of whatever type
+	// pre-load the whole FIFO (or the whole packet if it's shorter) before starting the TX
+	BK4819_FskTxRefill(BK4819_FSK_TX_FIFO_LEN_WORDS);
+
+	fsk_tx.state = FSK_TX_STATE_SENDING;
+
+	TRACE(TRACE_ID_FSK_TX_START, len_words, fsk_tx.index);
+
+	// enable TX .. from here on the FIFO is topped up from BK4819_FskProcessInterrupts()
+	BK4819_WriteRegister(BK4819_REG_59, fsk_tx.reg59 | BK4819_REG_59_MASK_FSK_ENABLE_TX);
 
-	uint8_t refills = 0;
-	FSK_IRQ_t fsk_irq = FSK_OTHER;
 	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_FLASHLIGHT);
 
-	printf("\nnew packet, for loop until %d (words)\r\n", (tx_packet_len_bytes / 2));
-	for (i = 0; i < (tx_packet_len_bytes / 2); i++) // i counts the words, not the bytes!
-	{
-		/* it doesn't fire the fifo low interrupt ... */
-		/* the logic behind this is:
-			1. set the fsk to transmit (it will tx as soon as 1 word is put in the fifo buffer)
-			2. loop over the tx buffer, word by word
-			3. in the first batch, fill the fifo with 128 words (in case the packet length is more than 128)
-			4. the fsk engine begins transmitting
-			5. wait for the 'FSK_FIFO_ALMOST_EMPTY' interrupt to fire (it should fire when the fifo reaches 64 words)
-			6. put in the fifo other 64 words maximum (because we are sure there is room for those)
-			7. wait again for the interrupt...
-			8. once we don't have any other words to send, exit the loop and wait for the 'FSK_TX_FINISHED' interrupt
-			9. upon 'FSK_TX_FINISHED', clear 'FSK_ENABLE_TX' from REG_59 (we don't shut off the TX PA, as maybe there are other packets to be sent)
-		*/
-		if(i == (BK4819_FIFO_DIM_WORDS + refills * TX_FIFO_CHUNKS_DIM_WORDS))
-		{
-			printf("stop at %d words, wait for fifo\r\n", i);
-			// stop and wait for the fifo to be depleted
-			#define WAIT_MS 2
-			uint16_t timeout = 100 / WAIT_MS;
-			while(timeout--)
-			{
-				SYSTEM_DelayMs(WAIT_MS);
-				fsk_irq = BK4819_FskCheckInterrupt();
-				switch(fsk_irq)
-				{
-					case FSK_TX_FINISHED:
-						printf("TX finished in wait loop, setting flag and exit\r\n");
-						jump_to_end = true;
-						timeout = 0;
-						break;
-
-					case FSK_FIFO_ALMOST_EMPTY:
-						printf("TX fifo almost empty, refilling\r\n");
-						timeout = 0;
-
-					default:
-						continue;
-				}			
-			}
+	return 0;
+}
 
-			refills++;
-			printf("refills: %d\r\n", refills);
-		}
+bool BK4819_FskTxBusy(void)
+{
+	return (fsk_tx.state != FSK_TX_STATE_IDLE) ? true : false;
+}
 
-		if(jump_to_end)
+void BK4819_FskProcessInterrupts(const uint16_t interrupt_bits)
+{
+	if (fsk_tx.state != FSK_TX_STATE_IDLE)
+	{
+		if (interrupt_bits & BK4819_REG_02_FSK_TX_FINISHED)
 		{
-			printf("break\r\n");
-			break;
+			BK4819_FskTxEnd(fsk_tx.index >= fsk_tx.len_words);
+			return;
 		}
 
-		BK4819_WriteRegister(BK4819_REG_5F, p[i]);  // load 16-bits at a time
-		SYSTICK_DelayUs(100);
-		//printf(" 0x%04x", p[i]);
-		//if(!(i % 10))
-		//	printf("\r\n");
+		if (interrupt_bits & BK4819_REG_02_FSK_FIFO_ALMOST_EMPTY)
+		{	// at most TX_FIFO_LOW_THRESHOLD_WORDS are still in the FIFO, there's room for the rest
+			BK4819_FskTxRefill(BK4819_FSK_TX_FIFO_LEN_WORDS - TX_FIFO_LOW_THRESHOLD_WORDS);
+		}
+		return;
 	}
-	GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_FLASHLIGHT);
 
-	// wait for end of tx if still transmitting
-	if(!jump_to_end)
+	if (!fsk_rx.active)
+		return;
+
+	if (interrupt_bits & BK4819_REG_02_FSK_RX_SYNC)
+		g_fsk_rx_stats.sync_found++;
+
+	if (interrupt_bits & BK4819_REG_02_FSK_FIFO_ALMOST_FULL)
+		BK4819_FskRxDrain(RX_FIFO_HIGH_THRESHOLD_WORDS);
+
+	if (interrupt_bits & BK4819_REG_02_FSK_RX_FINISHED)
 	{
-		uint16_t timeout = 300;
-		while (timeout--)
-		{
-			SYSTEM_DelayMs(1);
-			//SYSTICK_DelayUs(100);
-			if(BK4819_FskCheckInterrupt() == FSK_TX_FINISHED)
-				timeout = 0;
-		}
+		// whatever is left of the packet is sitting below the FIFO threshold
+		BK4819_FskRxDrain(BK4819_FSK_RX_FIFO_LEN_WORDS);
+		BK4819_FskRxEnd();
+	}
+}
+
+int16_t BK4819_FskStartReceive(const uint16_t packetLenBytes)
+{
+	const uint16_t len_words = (packetLenBytes + 1) / 2;
+
+	if (len_words == 0 || len_words > BK4819_FSK_RX_MAX_PACKET_LEN_WORDS)
+		return -1;
+
+	if (fsk_tx.state != FSK_TX_STATE_IDLE)
+		return -1;
+
+	fsk_rx.len_words = len_words;
+	fsk_rx.wr        = fsk_rx.head;    // forget any partial packet, keep the complete ones
+
+	{	// set the packet length (bytes - 1) .. low 8 bits in <15:8>, high 3 bits in <7:5>
+		const uint16_t size = (len_words * 2u) - 1u;
+		BK4819_WriteRegister(BK4819_REG_5D,
+			((size << BK4819_REG_5D_SHIFT_FSK_DATA_LENGTH_LOW) & BK4819_REG_5D_MASK_FSK_DATA_LENGTH_LOW) |
+			(((size >> 8) << BK4819_REG_5D_SHIFT_FSK_DATA_LENGTH_HIGH) & BK4819_REG_5D_MASK_FSK_DATA_LENGTH_HIGH));
 	}
 
+	{	// set up the rx fifo high threshold
+		const uint16_t reg5E_fifo = BK4819_ReadRegister(BK4819_REG_5E);
+		BK4819_WriteRegister(BK4819_REG_5E, (reg5E_fifo & ~BK4819_REG_5E_MASK_FSK_RX_FIFO_THRESHOLD) | (RX_FIFO_HIGH_THRESHOLD_WORDS << BK4819_REG_5E_SHIFT_FSK_RX_FIFO_THRESHOLD));
+	}
 
-	// clear fifo and stop tx
-	BK4819_WriteRegister(BK4819_REG_59, reg59_fsk | BK4819_REG_59_MASK_FSK_CLEAR_TX_FIFO);
-	BK4819_WriteRegister(BK4819_REG_59, reg59_fsk);
+	BK4819_WriteRegister(BK4819_REG_02, 0);        // clear any stale interrupt flags
+	BK4819_WriteRegister(BK4819_REG_3F, BK4819_REG_3F_FSK_RX_SYNC | BK4819_REG_3F_FSK_RX_FINISHED | BK4819_REG_3F_FSK_FIFO_ALMOST_FULL);
 
-	return i;
+	fsk_rx.reg59 = BK4819_ReadRegister(BK4819_REG_59) & ~(
+		  BK4819_REG_59_MASK_FSK_ENABLE_TX
+		| BK4819_REG_59_MASK_FSK_CLEAR_TX_FIFO
+		| BK4819_REG_59_MASK_FSK_ENABLE_RX
+		| BK4819_REG_59_MASK_FSK_CLEAR_RX_FIFO);
+
+	fsk_rx.active = true;
+
+	BK4819_FskRxArm();
+
+	return 0;
+}
+
+void BK4819_FskStopReceive(void)
+{
+	if (!fsk_rx.active)
+		return;
+
+	fsk_rx.active = false;
+	fsk_rx.wr     = fsk_rx.head;       // drop any partial packet
+
+	BK4819_WriteRegister(BK4819_REG_3F, 0);        // disable the FSK RX interrupts
+	BK4819_WriteRegister(BK4819_REG_59, fsk_rx.reg59 | BK4819_REG_59_MASK_FSK_CLEAR_RX_FIFO);
+	BK4819_WriteRegister(BK4819_REG_59, fsk_rx.reg59);
+}
+
+bool BK4819_FskRxActive(void)
+{
+	return fsk_rx.active;
 }
 
+int16_t BK4819_FskReadPacket(uint16_t *buffer, const uint16_t max_words, bool *crc_ok)
+{
+	uint16_t     tail = fsk_rx.tail;
+	uint16_t     hdr;
+	uint16_t     len;
+	unsigned int i;
 
-#endif // ENABLE_FSK_MODEM
\ No newline at end of file
+	if (tail == fsk_rx.head)
+		return -1;     // nothing waiting
+
+	hdr = fsk_rx_ring[tail++ & FSK_RX_RING_MASK];
+	len = hdr & FSK_RX_HDR_MASK_LEN;
+
+	for (i = 0; i < len; i++, tail++)
+		if (i < max_words)
+			buffer[i] = fsk_rx_ring[tail & FSK_RX_RING_MASK];
+
+	if (crc_ok != NULL)
+		*crc_ok = ((hdr & (FSK_RX_HDR_CRC_OK | FSK_RX_HDR_SHORT)) == FSK_RX_HDR_CRC_OK) ? true : false;
+
+	__asm volatile ("" ::: "memory");   // finish reading before handing the space back
+	fsk_rx.tail = tail;
+
+	return len;
+}
+
+void BK4819_FskProcess10ms(void)
+{
+	if (fsk_tx.state == FSK_TX_STATE_IDLE)
+		return;
+
+	if (fsk_tx.timeout_10ms > 0)
+		if (--fsk_tx.timeout_10ms > 0)
+			return;
+
+	// if it takes any longer then somethings gone wrong, we shut the TX down
+	BK4819_FskTxEnd(false);
+}
+
+#endif // ENABLE_FSK_MODEM
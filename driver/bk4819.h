@@ -59,11 +59,30 @@ enum BK4819_CSS_scan_result_e
 };
 typedef enum BK4819_CSS_scan_result_e BK4819_CSS_scan_result_t;
 
+typedef struct {
+	bk4819_register_t reg;
+	uint16_t          data;
+} bk4819_reg_pair_t;
+
+#ifdef ENABLE_BK4819_REG_CACHE
+	typedef struct {
+		uint32_t read_hits;     // config register reads answered from RAM
+		uint32_t read_misses;   // config register reads that had to go to the chip
+		uint32_t writes;        // config register writes sent to the chip
+		uint32_t write_skips;   // config register writes dropped, value unchanged
+		uint32_t uncached;      // status/FIFO register reads and writes
+	} BK4819_reg_cache_stats_t;
+
+	extern BK4819_reg_cache_stats_t g_bk4819_reg_cache_stats;
+#endif
+
 extern bool g_rx_idle_mode;
 
 void     BK4819_Init(void);
 uint16_t BK4819_ReadRegister(bk4819_register_t Register);
 void     BK4819_WriteRegister(bk4819_register_t Register, uint16_t Data);
+void     BK4819_WriteRegisters(const bk4819_reg_pair_t *pPairs, const unsigned int Count);
+void     BK4819_WriteRegisterBlock(bk4819_register_t Register, const uint16_t *pData, const unsigned int Count);
 void     BK4819_WriteU8(uint8_t Data);
 void     BK4819_WriteU16(uint16_t Data);
 
@@ -78,6 +97,13 @@ void     BK4819_EnableVox(uint16_t Vox1Threshold, uint16_t Vox0Threshold);
 void     BK4819_SetFilterBandwidth(const BK4819_filter_bandwidth_t Bandwidth, const bool weak_no_different);
 void     BK4819_SetupPowerAmplifier(const uint8_t bias, const uint32_t frequency);
 void     BK4819_set_rf_frequency(const uint32_t frequency, const bool trigger_update);
+void     BK4819_SetSquelchThresholds(
+			uint8_t SquelchOpenRSSIThresh,
+			uint8_t SquelchCloseRSSIThresh,
+			uint8_t SquelchOpenNoiseThresh,
+			uint8_t SquelchCloseNoiseThresh,
+			uint8_t SquelchCloseGlitchThresh,
+			uint8_t SquelchOpenGlitchThresh);
 void     BK4819_SetupSquelch(
 			uint8_t SquelchOpenRSSIThresh,
 			uint8_t SquelchCloseRSSIThresh,
@@ -169,6 +195,22 @@ void     BK4819_PlayDTMFEx(bool bLocalLoopback, char Code);
 
 #define BK4819_FSK_TX_FIFO_LEN_WORDS 128
 #define BK4819_FSK_RX_FIFO_LEN_WORDS 8
+#define BK4819_MAX_PACKET_LEN_WORDS  1024 // 2048 bytes
+
+// RX packet ring, must be a power of 2 and hold at least one packet + 1 word
+//
+// a packet has to fit in the ring whole before it can be read, so the ring sets the longest packet the
+// receiver takes, not the chip .. 511 words (1022 bytes) with the default 1kB ring. Receiving the full
+// 1024 word packets needs -DBK4819_FSK_RX_RING_WORDS=2048 in the CFLAGS, which takes 4kB of RAM
+#ifndef BK4819_FSK_RX_RING_WORDS
+	#define BK4819_FSK_RX_RING_WORDS 512
+#endif
+
+#if (BK4819_FSK_RX_RING_WORDS - 1) < BK4819_MAX_PACKET_LEN_WORDS
+	#define BK4819_FSK_RX_MAX_PACKET_LEN_WORDS  (BK4819_FSK_RX_RING_WORDS - 1)
+#else
+	#define BK4819_FSK_RX_MAX_PACKET_LEN_WORDS  BK4819_MAX_PACKET_LEN_WORDS
+#endif
 
 enum FSK_NO_SYNC_BYTES_t {
 	FSK_NO_SYNC_BYTES_2 = 0,
@@ -205,6 +247,16 @@ enum FSK_IRQ_t {
 
 typedef enum FSK_IRQ_t FSK_IRQ_t;
 
+typedef struct {
+	uint16_t packets;          // complete packets put in the RX ring
+	uint16_t crc_errors;       // .. of which failed the chip's CRC check
+	uint16_t short_packets;    // RX finished before the whole packet arrived
+	uint16_t overruns;         // packets dropped because the RX ring was full
+	uint16_t sync_found;
+} BK4819_fsk_rx_stats_t;
+
+extern BK4819_fsk_rx_stats_t g_fsk_rx_stats;
+
 void BK4819_FskEnterMode(
 	FSK_TX_RX_t txRx,
 	FSK_MODULATION_TYPE_t fskModulationType,
@@ -216,8 +268,27 @@ void BK4819_FskEnterMode(
 	bool fskInvertData
 	);
 
+// called once the packet has gone out (ok = true) or the TX has timed out (ok = false)
+typedef void (*BK4819_fsk_tx_done_t)(const bool ok);
+
 FSK_IRQ_t BK4819_FskCheckInterrupt(void);
-int16_t BK4819_FskTransmitPacket(void * txBuffer, uint16_t packetLenBytes);
+
+// starts sending the packet and returns straight away (0 = started, -1 = busy or bad length),
+// the length must be even and the buffer must stay valid until the done callback has been called
+int16_t BK4819_FskTransmitPacket(const void *txBuffer, const uint16_t packetLenBytes, BK4819_fsk_tx_done_t done);
+bool    BK4819_FskTxBusy(void);
+
+// continuous receiver, complete packets are queued in a ring buffer until read with BK4819_FskReadPacket()
+//
+// returns -1 for packets longer than BK4819_FSK_RX_MAX_PACKET_LEN_WORDS, see BK4819_FSK_RX_RING_WORDS
+int16_t BK4819_FskStartReceive(const uint16_t packetLenBytes);
+void    BK4819_FskStopReceive(void);
+bool    BK4819_FskRxActive(void);
+// returns the packet length in words (only the first max_words are copied) or -1 if there's nothing waiting
+int16_t BK4819_FskReadPacket(uint16_t *buffer, const uint16_t max_words, bool *crc_ok);
+
+void    BK4819_FskProcessInterrupts(const uint16_t interrupt_bits);
+void    BK4819_FskProcess10ms(void);
 
 void BK4819_FskExitMode(void);
 void BK4819_FskIdle(void);
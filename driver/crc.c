@@ -31,19 +31,29 @@ void CRC_Init(void)
 	CRC_IV = 0;
 }
 
+void CRC_Begin(void)
+{
+	CRC_CR = (CRC_CR & ~CRC_CR_CRC_EN_MASK) | CRC_CR_CRC_EN_BITS_ENABLE;
+}
+
+uint16_t CRC_End(void)
+{
+	const uint16_t crc = (uint16_t)CRC_DATAOUT;
+
+	CRC_CR = (CRC_CR & ~CRC_CR_CRC_EN_MASK) | CRC_CR_CRC_EN_BITS_DISABLE;
+
+	return crc;
+}
+
 uint16_t CRC_Calculate(const void *pBuffer, uint16_t Size)
 {
 	const uint8_t *data = (const uint8_t *)pBuffer;
 	uint16_t       i;
-	uint16_t       crc;
 
-	CRC_CR = (CRC_CR & ~CRC_CR_CRC_EN_MASK) | CRC_CR_CRC_EN_BITS_ENABLE;
+	CRC_Begin();
 
 	for (i = 0; i < Size; i++)
 		CRC_DATAIN = data[i];
-	crc = (uint16_t)CRC_DATAOUT;
 
-	CRC_CR = (CRC_CR & ~CRC_CR_CRC_EN_MASK) | CRC_CR_CRC_EN_BITS_DISABLE;
-
-	return crc;
+	return CRC_End();
 }
@@ -22,5 +22,9 @@
 void CRC_Init(void);
 uint16_t CRC_Calculate(const void *pBuffer, uint16_t Size);
 
+// for feeding CRC_DATAIN a byte at a time
+void     CRC_Begin(void);
+uint16_t CRC_End(void);
+
 #endif
 
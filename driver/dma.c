@@ -0,0 +1,41 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#include "bsp/dp32g030/dma.h"
+#include "driver/st7565.h"
+#include "driver/uart.h"
+
+// the one DMA interrupt is shared by all four channels, each finished channel is handed to its owner
+//   CH0 .. UART1 RX, loop mode, no interrupt
+//   CH1 .. UART1 TX (ENABLE_UART_TX_DMA)
+//   CH2 .. ST7565 display (ENABLE_LCD_DMA)
+void HandlerDMA(void)
+{
+	const uint32_t status = DMA_INTST;
+
+	#ifdef ENABLE_UART_TX_DMA
+		if ((status & DMA_INTST_CH1_TC_INTST_MASK) != DMA_INTST_CH1_TC_INTST_BITS_NOT_SET)
+			UART_DMA_Interrupt();
+	#endif
+
+	#ifdef ENABLE_LCD_DMA
+		if ((status & DMA_INTST_CH2_TC_INTST_MASK) != DMA_INTST_CH2_TC_INTST_BITS_NOT_SET)
+			ST7565_DMA_Interrupt();
+	#endif
+
+	(void)status;
+}
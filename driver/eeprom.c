@@ -14,26 +14,268 @@
  *     limitations under the License.
  */
 
-#include <string.h>     // NULL and memcmp
+#include <stdbool.h>
+#include <string.h>     // NULL, memcmp and memcpy
 
 #include "driver/eeprom.h"
 #include "driver/i2c.h"
-#include "driver/system.h"
 
-void EEPROM_ReadBuffer(const uint16_t address, void *p_buffer, const unsigned int size)
+// a BL24C64 write cycle takes 1.5ms ~ 5ms, the eeprom NACK's its device address until it's done.
+// one poll is roughly 40us on the bit-banged bus, so this gives up after about 10ms
+#define EEPROM_MAX_BUSY_POLLS   250
+
+EEPROM_write_stats_t g_eeprom_write_stats;
+
+#ifdef ENABLE_EEPROM_WRITE_BACK
+	// RAM copies of the eeprom pages being written to
+	//
+	// writes only land in here, EEPROM_FlushStep() then burns each dirty page with a single page write.
+	// a settings/channel save writes 8 bytes at a time to neighbouring addresses, so this turns up
+	// to 4 write cycles (and 4 x 6ms of sitting in a delay loop) into one, and the main loop no longer stalls
+
+	#define EEPROM_PAGE_SLOTS   8
+
+	typedef struct {
+		uint16_t address;                  // eeprom address of the page
+		uint16_t dirty_tick;               // eeprom_tick_10ms when the page first went dirty
+		uint8_t  valid;
+		uint8_t  dirty_lo;                 // dirty byte range within the page, clean when lo == hi
+		uint8_t  dirty_hi;
+		uint8_t  data[EEPROM_PAGE_SIZE];
+	} eeprom_page_t;
+
+	static eeprom_page_t eeprom_page[EEPROM_PAGE_SLOTS];
+	static uint8_t       eeprom_page_next;
+	static uint16_t      eeprom_tick_10ms;
+#endif
+
+// staging area, see EEPROM_StageBegin()
+#define EEPROM_STAGE_CHUNK    256u           // bytes read in one sequential transfer
+
+static uint8_t  eeprom_stage[EEPROM_STAGE_CHUNK];
+static bool     eeprom_stage_on;
+static uint16_t eeprom_stage_lo;             // the area being staged
+static uint16_t eeprom_stage_hi;
+static uint16_t eeprom_stage_addr;           // the chunk currently held in eeprom_stage[]
+static uint16_t eeprom_stage_size;           // 0 = nothing held yet
+
+// start a transfer, ACK polling the device address until any write cycle in progress has finished
+//
+// returns false if the eeprom is still busy and we were told not to wait
+static bool EEPROM_Select(const bool wait)
 {
-	if (p_buffer == NULL || (address + size) > 0x2000 || size == 0)
-		return;
+	uint16_t polls = 0;
 
-	I2C_Start();
-	I2C_Write(0xA0);
+	while (1)
+	{
+		I2C_Start();
+		if (I2C_Write(0xA0) == 0)
+			break;           // ACK'ed, it's ready
+
+		if (!wait)
+		{
+			I2C_Stop();
+			return false;
+		}
+
+		if (++polls >= EEPROM_MAX_BUSY_POLLS)
+			break;           // give up waiting, carry on as we used to
+
+		I2C_Stop();
+	}
+
+	if (g_eeprom_write_stats.busy_polls_max < polls)
+		g_eeprom_write_stats.busy_polls_max = polls;
+
+	return true;
+}
+
+static void EEPROM_ReadChip(const uint16_t address, void *p_buffer, const unsigned int size)
+{
+	EEPROM_Select(true);
 	I2C_Write((address >> 8) & 0xFF);
 	I2C_Write((address >> 0) & 0xFF);
 
 	I2C_Start();
 	I2C_Write(0xA1);
-	I2C_ReadBuffer(p_buffer, size);
+	I2C_ReadBufferFast(p_buffer, size);
+	I2C_Stop();
+}
+
+// the data must not cross a page boundary, the eeprom wraps around within the page
+static bool EEPROM_WriteChip(const uint16_t address, const void *p_buffer, const unsigned int size, const bool wait)
+{
+	if (!EEPROM_Select(wait))
+		return false;
+
+	I2C_Write((address >> 8) & 0xFF);
+	I2C_Write((address >> 0) & 0xFF);
+	I2C_WriteBuffer(p_buffer, size);
 	I2C_Stop();
+
+	// no more fixed 6ms delay in here, the next transfer ACK polls the eeprom instead
+
+	g_eeprom_write_stats.bytes_written += size;
+	g_eeprom_write_stats.page_writes++;
+
+	return true;
+}
+
+#ifdef ENABLE_EEPROM_WRITE_BACK
+	static eeprom_page_t * EEPROM_FindPage(const uint16_t page_addr)
+	{
+		unsigned int i;
+		for (i = 0; i < EEPROM_PAGE_SLOTS; i++)
+			if (eeprom_page[i].valid && eeprom_page[i].address == page_addr)
+				return &eeprom_page[i];
+		return NULL;
+	}
+
+	static bool EEPROM_FlushPage(eeprom_page_t *page, const bool wait)
+	{
+		uint16_t latency;
+
+		if (page->dirty_lo >= page->dirty_hi)
+			return true;     // nothing to burn
+
+		// only the dirty span of the page gets written
+		if (!EEPROM_WriteChip(page->address + page->dirty_lo, &page->data[page->dirty_lo], page->dirty_hi - page->dirty_lo, wait))
+			return false;
+
+		page->dirty_lo = 0;
+		page->dirty_hi = 0;
+
+		latency = eeprom_tick_10ms - page->dirty_tick;
+		g_eeprom_write_stats.flush_last_10ms = latency;
+		if (g_eeprom_write_stats.flush_max_10ms < latency)
+			g_eeprom_write_stats.flush_max_10ms = latency;
+
+		return true;
+	}
+
+	static eeprom_page_t * EEPROM_OldestDirtyPage(void)
+	{
+		eeprom_page_t *oldest = NULL;
+		unsigned int   i;
+
+		for (i = 0; i < EEPROM_PAGE_SLOTS; i++)
+		{
+			eeprom_page_t *page = &eeprom_page[i];
+			if (page->dirty_lo >= page->dirty_hi)
+				continue;
+			if (oldest == NULL || (uint16_t)(eeprom_tick_10ms - page->dirty_tick) > (uint16_t)(eeprom_tick_10ms - oldest->dirty_tick))
+				oldest = page;
+		}
+
+		return oldest;
+	}
+
+	static eeprom_page_t * EEPROM_GetPage(const uint16_t page_addr)
+	{
+		eeprom_page_t *page = EEPROM_FindPage(page_addr);
+		unsigned int   i;
+
+		if (page != NULL)
+			return page;
+
+		// use an unused slot, else the next clean one round robin
+		for (i = 0; i < EEPROM_PAGE_SLOTS; i++)
+		{
+			eeprom_page_t *slot = &eeprom_page[(eeprom_page_next + i) % EEPROM_PAGE_SLOTS];
+			if (!slot->valid)
+			{
+				page = slot;
+				break;
+			}
+			if (page == NULL && slot->dirty_lo >= slot->dirty_hi)
+				page = slot;
+		}
+
+		if (page == NULL)
+		{	// all of them are waiting to be burnt, make room now
+			page = EEPROM_OldestDirtyPage();
+			EEPROM_FlushPage(page, true);
+		}
+
+		eeprom_page_next = ((page - eeprom_page) + 1) % EEPROM_PAGE_SLOTS;
+
+		page->valid    = 0;
+		EEPROM_ReadChip(page_addr, page->data, EEPROM_PAGE_SIZE);
+		page->address  = page_addr;
+		page->dirty_lo = 0;
+		page->dirty_hi = 0;
+		page->valid    = 1;
+
+		return page;
+	}
+#endif
+
+// serve a read from the staged chunk, loading the chunk that holds it if needed
+//
+// returns false if the read is outside the staged area or straddles two chunks
+static bool EEPROM_StageRead(const uint16_t address, void *p_buffer, const unsigned int size)
+{
+	uint16_t     chunk_addr;
+	unsigned int chunk_size;
+
+	if (!eeprom_stage_on || address < eeprom_stage_lo || (address + size) > eeprom_stage_hi)
+		return false;
+
+	if (eeprom_stage_size == 0 || address < eeprom_stage_addr || (address + size) > (eeprom_stage_addr + eeprom_stage_size))
+	{
+		chunk_addr = eeprom_stage_lo + (((address - eeprom_stage_lo) / EEPROM_STAGE_CHUNK) * EEPROM_STAGE_CHUNK);
+		if ((address + size) > (chunk_addr + EEPROM_STAGE_CHUNK))
+			return false;
+
+		chunk_size = eeprom_stage_hi - chunk_addr;
+		if (chunk_size > EEPROM_STAGE_CHUNK)
+			chunk_size = EEPROM_STAGE_CHUNK;
+
+		EEPROM_ReadChip(chunk_addr, eeprom_stage, chunk_size);
+		eeprom_stage_addr = chunk_addr;
+		eeprom_stage_size = chunk_size;
+	}
+
+	memcpy(p_buffer, &eeprom_stage[address - eeprom_stage_addr], size);
+	return true;
+}
+
+void EEPROM_ReadBuffer(const uint16_t address, void *p_buffer, const unsigned int size)
+{
+	if (p_buffer == NULL || (address + size) > 0x2000 || size == 0)
+		return;
+
+#ifdef ENABLE_EEPROM_WRITE_BACK
+	{	// straight from RAM if it's all within a page we're holding
+		const uint16_t       page_addr = address & ~(EEPROM_PAGE_SIZE - 1);
+		const unsigned int   offset    = address - page_addr;
+		const eeprom_page_t *page      = (offset + size) <= EEPROM_PAGE_SIZE ? EEPROM_FindPage(page_addr) : NULL;
+		if (page != NULL)
+		{
+			memcpy(p_buffer, &page->data[offset], size);
+			return;
+		}
+	}
+#endif
+
+	if (!EEPROM_StageRead(address, p_buffer, size))
+		EEPROM_ReadChip(address, p_buffer, size);
+
+#ifdef ENABLE_EEPROM_WRITE_BACK
+	{	// overlay anything that's not been burnt yet
+		unsigned int i;
+		for (i = 0; i < EEPROM_PAGE_SLOTS; i++)
+		{
+			const eeprom_page_t *page = &eeprom_page[i];
+			const unsigned int   lo   = page->address + page->dirty_lo;
+			const unsigned int   hi   = page->address + page->dirty_hi;
+			const unsigned int   from = (lo > address) ? lo : address;
+			const unsigned int   to   = (hi < (address + size)) ? hi : address + size;
+			if (page->valid && from < to)
+				memcpy((uint8_t *)p_buffer + (from - address), &page->data[from - page->address], to - from);
+		}
+	}
+#endif
 }
 
 void EEPROM_WriteBuffer8(const uint16_t address, const void *p_buffer)
@@ -41,37 +283,129 @@ void EEPROM_WriteBuffer8(const uint16_t address, const void *p_buffer)
 	if (p_buffer == NULL || (address + 8) > 0x2000)
 		return;
 
-#if 0
-	// normal way
+#ifdef ENABLE_EEPROM_WRITE_BACK
+	{
+		const uint8_t *p       = (const uint8_t *)p_buffer;
+		uint16_t       addr    = address;
+		unsigned int   size    = 8;
+		bool           changed = false;
 
-	I2C_Start();
-	I2C_Write(0xA0);
-	I2C_Write((address >> 8) & 0xFF);
-	I2C_Write((address >> 0) & 0xFF);
-	I2C_WriteBuffer(p_buffer, 8);
-	I2C_Stop();
+		while (size > 0)
+		{	// split at page boundaries
+			const uint16_t page_addr = addr & ~(EEPROM_PAGE_SIZE - 1);
+			const unsigned int offset = addr - page_addr;
+			const unsigned int len    = (size < (EEPROM_PAGE_SIZE - offset)) ? size : EEPROM_PAGE_SIZE - offset;
+			eeprom_page_t     *page   = EEPROM_GetPage(page_addr);
+
+			// eeprom wear reduction
+			// only mark the data dirty if it's different to what's already there
+			if (memcmp(&page->data[offset], p, len) != 0)
+			{
+				memcpy(&page->data[offset], p, len);
 
-	// give the EEPROM time to burn the data in (apparently takes 1.5ms ~ 5ms)
-	SYSTEM_DelayMs(6);
+				if (page->dirty_lo >= page->dirty_hi)
+				{
+					page->dirty_lo   = offset;
+					page->dirty_hi   = offset + len;
+					page->dirty_tick = eeprom_tick_10ms;
+				}
+				else
+				{
+					if (page->dirty_lo > offset)
+						page->dirty_lo = offset;
+					if (page->dirty_hi < (offset + len))
+						page->dirty_hi = offset + len;
+				}
 
+				changed = true;
+			}
+
+			addr += len;
+			p    += len;
+			size -= len;
+		}
+
+		if (!changed)
+			g_eeprom_write_stats.write_skips++;
+	}
 #else
-	// eeprom wear reduction
-	// only write the data if it's different to what's already there
+	{	// eeprom wear reduction
+		// only write the data if it's different to what's already there
 
-	uint8_t buffer[8];
-	EEPROM_ReadBuffer(address, buffer, 8);
-	if (memcmp(p_buffer, buffer, 8) != 0)
-	{
-		I2C_Start();
-		I2C_Write(0xA0);
-		I2C_Write((address >> 8) & 0xFF);
-		I2C_Write((address >> 0) & 0xFF);
-		I2C_WriteBuffer(p_buffer, 8);
-		I2C_Stop();
+		uint8_t buffer[8];
+		EEPROM_ReadBuffer(address, buffer, 8);
+		if (memcmp(p_buffer, buffer, 8) != 0)
+			EEPROM_WriteChip(address, p_buffer, 8, true);
+		else
+			g_eeprom_write_stats.write_skips++;
+	}
+#endif
 
-		// give the EEPROM time to burn the data in (apparently takes 1.5ms ~ 5ms)
-		SYSTEM_DelayMs(6);
+	if (eeprom_stage_size > 0)
+	{	// keep the staged copy in step
+		const unsigned int from = (address > eeprom_stage_addr) ? address : eeprom_stage_addr;
+		const unsigned int to   = ((address + 8) < (eeprom_stage_addr + eeprom_stage_size)) ? address + 8 : eeprom_stage_addr + eeprom_stage_size;
+		if (from < to)
+			memcpy(&eeprom_stage[from - eeprom_stage_addr], (const uint8_t *)p_buffer + (from - address), to - from);
 	}
+}
+
+// BOARD_EEPROM_load() otherwise pays for a start + device + word address on every 8 or 16 byte
+// field it reads, so while booting the config area is read sequentially a chunk at a time and
+// EEPROM_ReadBuffer() serves the fields from RAM until EEPROM_StageEnd()
+//
+// the chunk buffer is a small static rather than the whole area, the stack is tiny on this part
+void EEPROM_StageBegin(const uint16_t address, const unsigned int size)
+{
+	eeprom_stage_on   = false;
+	eeprom_stage_size = 0;
+
+	if ((address + size) > 0x2000 || size == 0)
+		return;
+
+	eeprom_stage_lo = address;
+	eeprom_stage_hi = address + size;
+	eeprom_stage_on = true;
+}
 
+void EEPROM_StageEnd(void)
+{
+	eeprom_stage_on   = false;
+	eeprom_stage_size = 0;
+}
+
+// called from the 10ms time slice .. burns dirty pages oldest first for as long as the eeprom is
+// idle, never waiting on a write cycle
+//
+// a page write keeps the chip busy for up to 5ms, so in practice that's about one page a tick and
+// a save that dirties all EEPROM_PAGE_SLOTS pages sits in RAM for up to ~80ms .. a battery pull in
+// that time loses it
+void EEPROM_FlushStep(void)
+{
+#ifdef ENABLE_EEPROM_WRITE_BACK
+	unsigned int i;
+
+	eeprom_tick_10ms++;
+
+	for (i = 0; i < EEPROM_PAGE_SLOTS; i++)
+	{
+		eeprom_page_t *page = EEPROM_OldestDirtyPage();
+		if (page == NULL || !EEPROM_FlushPage(page, false))
+			break;   // all burnt, or the chip is still busy with the last one
+	}
 #endif
 }
+
+// burn everything now, call before rebooting
+void EEPROM_Flush(void)
+{
+#ifdef ENABLE_EEPROM_WRITE_BACK
+	unsigned int i;
+	for (i = 0; i < EEPROM_PAGE_SLOTS; i++)
+		EEPROM_FlushPage(&eeprom_page[i], true);
+#endif
+
+	// wait for the last write cycle to finish
+	EEPROM_Select(true);
+	I2C_Stop();
+}
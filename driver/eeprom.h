@@ -19,8 +19,27 @@
 
 #include <stdint.h>
 
+#define EEPROM_PAGE_SIZE   32     // BL24C64 page write size
+
+typedef struct {
+	uint32_t bytes_written;       // bytes actually burnt into the eeprom
+	uint32_t page_writes;         // write cycles started
+	uint32_t write_skips;         // EEPROM_WriteBuffer8() calls that didn't change anything
+	uint16_t busy_polls_max;      // longest ACK poll seen waiting for a write cycle to finish
+	uint16_t flush_last_10ms;     // time the last flushed page sat dirty in RAM
+	uint16_t flush_max_10ms;      // .. and the longest
+} EEPROM_write_stats_t;
+
+extern EEPROM_write_stats_t g_eeprom_write_stats;
+
 void EEPROM_ReadBuffer(const uint16_t address, void *p_buffer, const unsigned int size);
 void EEPROM_WriteBuffer8(const uint16_t address, const void *p_buffer);
 
+void EEPROM_StageBegin(const uint16_t address, const unsigned int size);
+void EEPROM_StageEnd(void);
+
+void EEPROM_FlushStep(void);
+void EEPROM_Flush(void);
+
 #endif
 
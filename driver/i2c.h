@@ -32,6 +32,7 @@ uint8_t I2C_Read(bool bFinal);
 int I2C_Write(uint8_t Data);
 
 int I2C_ReadBuffer(void *pBuffer, uint8_t Size);
+int I2C_ReadBufferFast(void *pBuffer, uint16_t Size);
 int I2C_WriteBuffer(const void *pBuffer, uint8_t Size);
 
 #endif
@@ -16,7 +16,13 @@
 
 #include <stdint.h>
 #include <stdio.h>     // NULL
+#include <string.h>
 
+#ifdef ENABLE_LCD_DMA
+	#include "ARMCM0.h"
+	#include "bsp/dp32g030/dma.h"
+	#include "bsp/dp32g030/irq.h"
+#endif
 #include "bsp/dp32g030/gpio.h"
 #include "bsp/dp32g030/spi.h"
 #include "driver/gpio.h"
@@ -28,6 +34,26 @@
 uint8_t g_status_line[128];
 uint8_t g_frame_buffer[7][128];
 
+// what the glass is showing (page 0 is the status line), the blits only send what differs from it
+static uint8_t lcd_shadow[8][LCD_WIDTH];
+
+#ifdef ENABLE_LCD_DMA
+	// SPI0 TX request line on the DMA handshake mux
+	#define LCD_DMA_HSREQ     DMA_CH_MOD_MD_SEL_BITS_HSREQ_MS2
+
+	typedef enum {
+		LCD_DMA_IDLE = 0,     // SSN released, nothing going out
+		LCD_DMA_DATA          // A0 high, CH2 moving a page span from lcd_shadow into SPI0
+	} lcd_dma_state_t;
+
+	// the pages as the UI last handed them over .. the DMA sends from lcd_shadow, so the UI is free
+	// to draw the next frame into g_frame_buffer while this one is still going out
+	static uint8_t          lcd_back[8][LCD_WIDTH];
+	static volatile uint8_t lcd_pending;    // bit per page, lcd_back has something for it
+	static volatile uint8_t lcd_forced;     // bit per page, send the whole page (refresh) not just the changes
+	static volatile uint8_t lcd_state = LCD_DMA_IDLE;
+#endif
+
 #ifdef ENABLE_CONTRAST
 	uint8_t contrast = 31;  // 0 ~ 63
 #endif
@@ -36,91 +62,280 @@ void ST7565_DrawLine(const unsigned int Column, const unsigned int Line, const u
 {
 	unsigned int i;
 
+	#ifdef ENABLE_LCD_DMA
+		ST7565_BlitWait();
+	#endif
+
 	SPI_ToggleMasterMode(&SPI0->CR, false);
 
 	ST7565_SelectColumnAndLine(Column + 4U, Line);
 
 	GPIO_SetBit(&GPIOB->DATA, GPIOB_PIN_ST7565_A0);
 
-	if (pBitmap != NULL)
+	for (i = 0; i < Size; i++)
 	{
-		for (i = 0; i < Size; i++)
-		{
-			while ((SPI0->FIFOST & SPI_FIFOST_TFF_MASK) != SPI_FIFOST_TFF_BITS_NOT_FULL) {}
-			SPI0->WDR = pBitmap[i];
-		}
+		const uint8_t value = (pBitmap != NULL) ? pBitmap[i] : 0;
+		while ((SPI0->FIFOST & SPI_FIFOST_TFF_MASK) != SPI_FIFOST_TFF_BITS_NOT_FULL) {}
+		SPI0->WDR = value;
+		if (Line < ARRAY_SIZE(lcd_shadow) && (Column + i) < LCD_WIDTH)
+			lcd_shadow[Line][Column + i] = value;
 	}
-	else
+
+	SPI_WaitForUndocumentedTxFifoStatusBit();
+
+	SPI_ToggleMasterMode(&SPI0->CR, true);
+}
+
+#ifdef ENABLE_LCD_DMA
+	// per page state machine, called with interrupts off from the DMA interrupt and the blit calls
+	//   command .. A0 low, page + column select polled out, it's only 3 bytes
+	//   data    .. A0 high, CH2 sends the changed span, its TC interrupt brings us back here
+	static void ST7565_DmaKick(void)
 	{
-		for (i = 0; i < Size; i++)
+		if (lcd_state == LCD_DMA_DATA)
 		{
-			while ((SPI0->FIFOST & SPI_FIFOST_TFF_MASK) != SPI_FIFOST_TFF_BITS_NOT_FULL) {}
-			SPI0->WDR = 0;
+			if ((DMA_INTST & DMA_INTST_CH2_TC_INTST_MASK) == DMA_INTST_CH2_TC_INTST_BITS_NOT_SET)
+				return;     // still going
+
+			DMA_INTST = DMA_INTST_CH2_TC_INTST_BITS_SET;
+
+			// TC only means the last byte is in the FIFO, it has to be on the wire before A0 drops
+			SPI_WaitForUndocumentedTxFifoStatusBit();
+		}
+
+		while ((lcd_pending | lcd_forced) != 0)
+		{
+			const uint8_t todo = lcd_pending | lcd_forced;
+			unsigned int  page = 0;
+			unsigned int  first;
+			unsigned int  last;
+			uint8_t       bit;
+
+			while ((todo & (1u << page)) == 0)
+				page++;
+			bit = 1u << page;
+
+			first = LCD_WIDTH;
+			last  = 0;
+
+			if (lcd_pending & bit)
+			{	// the span that differs from the glass
+				const uint8_t *p_src    = lcd_back[page];
+				uint8_t       *p_shadow = lcd_shadow[page];
+
+				first = 0;
+				while (first < LCD_WIDTH && p_src[first] == p_shadow[first])
+					first++;
+				if (first < LCD_WIDTH)
+				{
+					last = LCD_WIDTH;
+					while (p_src[last - 1] == p_shadow[last - 1])
+						last--;
+					memcpy(&p_shadow[first], &p_src[first], last - first);
+				}
+			}
+
+			if (lcd_forced & bit)
+			{
+				first = 0;
+				last  = LCD_WIDTH;
+			}
+
+			lcd_pending &= ~bit;
+			lcd_forced  &= ~bit;
+
+			if (first >= last)
+				continue;   // nothing changed
+
+			if (lcd_state == LCD_DMA_IDLE)
+			{	// start of a burst
+				SPI_ToggleMasterMode(&SPI0->CR, false);
+				SPI0->CR = (SPI0->CR & ~SPI_CR_TXDMAEN_MASK) | SPI_CR_TXDMAEN_BITS_ENABLE;
+				ST7565_WriteByte(0x40);    // start line ?
+				lcd_state = LCD_DMA_DATA;
+			}
+
+			ST7565_SelectColumnAndLine(first + 4, page);
+			GPIO_SetBit(&GPIOB->DATA, GPIOB_PIN_ST7565_A0);
+
+			DMA_CH2->CTR    = 0;
+			DMA_CH2->MSADDR = (uint32_t)(uintptr_t)&lcd_shadow[page][first];
+			DMA_CH2->MDADDR = (uint32_t)(uintptr_t)&SPI0->WDR;
+			DMA_CH2->MOD    = 0
+				// Source
+				| DMA_CH_MOD_MS_ADDMOD_BITS_INCREMENT
+				| DMA_CH_MOD_MS_SIZE_BITS_8BIT
+				| DMA_CH_MOD_MS_SEL_BITS_SRAM
+				// Destination
+				| DMA_CH_MOD_MD_ADDMOD_BITS_NONE
+				| DMA_CH_MOD_MD_SIZE_BITS_8BIT
+				| LCD_DMA_HSREQ
+				;
+			DMA_CH2->CTR    = 0
+				| DMA_CH_CTR_CH_EN_BITS_ENABLE
+				| (((last - first - 1) << DMA_CH_CTR_LENGTH_SHIFT) & DMA_CH_CTR_LENGTH_MASK)
+				| DMA_CH_CTR_LOOP_BITS_DISABLE
+				| DMA_CH_CTR_PRI_BITS_LOW
+				;
+			return;
+		}
+
+		if (lcd_state != LCD_DMA_IDLE)
+		{	// end of the burst
+			SPI0->CR = (SPI0->CR & ~SPI_CR_TXDMAEN_MASK) | SPI_CR_TXDMAEN_BITS_DISABLE;
+			SPI_ToggleMasterMode(&SPI0->CR, true);
+			lcd_state = LCD_DMA_IDLE;
 		}
 	}
 
-	SPI_WaitForUndocumentedTxFifoStatusBit();
+	static void ST7565_QueuePage(const unsigned int page, const uint8_t *p_src)
+	{	// take a copy, the glass is brought up to date in the background
+		const uint32_t primask = __get_PRIMASK();
+		__disable_irq();
+		memcpy(lcd_back[page], p_src, LCD_WIDTH);
+		lcd_pending |= 1u << page;
+		__set_PRIMASK(primask);
+	}
 
-	SPI_ToggleMasterMode(&SPI0->CR, true);
-}
+	static void ST7565_DmaStart(void)
+	{
+		const uint32_t primask = __get_PRIMASK();
+		__disable_irq();
+		ST7565_DmaKick();
+		__set_PRIMASK(primask);
+	}
 
-void ST7565_BlitFullScreen(void)
-{
-	unsigned int Line;
+	void ST7565_DMA_Interrupt(void)
+	{
+		ST7565_DmaKick();
+	}
 
-	// reset some of the displays settings to try and overcome the
-	// radios hardware problem - RF corrupting the display
-	ST7565_Init(false);
+	bool ST7565_BlitBusy(void)
+	{
+		return lcd_state != LCD_DMA_IDLE;
+	}
 
-	SPI_ToggleMasterMode(&SPI0->CR, false);
+	void ST7565_BlitWait(void)
+	{	// the polled writes can't cut into a page that's still going out
+		uint32_t Timeout = 0;
 
-	ST7565_WriteByte(0x40);
+		while (lcd_state != LCD_DMA_IDLE)
+		{
+			ST7565_DmaStart();
+
+			if (++Timeout > 100000)
+			{	// the DMA has stalled, drop the rest, the periodic refresh puts the glass right
+				const uint32_t primask = __get_PRIMASK();
+				__disable_irq();
+				DMA_CH2->CTR = 0;
+				DMA_INTST    = DMA_INTST_CH2_TC_INTST_BITS_SET;
+				lcd_pending  = 0;
+				lcd_forced   = 0;
+				SPI0->CR     = (SPI0->CR & ~SPI_CR_TXDMAEN_MASK) | SPI_CR_TXDMAEN_BITS_DISABLE;
+				SPI_ToggleMasterMode(&SPI0->CR, true);
+				lcd_state    = LCD_DMA_IDLE;
+				__set_PRIMASK(primask);
+				break;
+			}
+		}
+	}
 
-	for (Line = 0; Line < ARRAY_SIZE(g_frame_buffer); Line++)
+	void ST7565_BlitFullScreen(void)
 	{
-		unsigned int Column;
-		ST7565_SelectColumnAndLine(4, Line + 1);
+		unsigned int Line;
+
+		for (Line = 0; Line < ARRAY_SIZE(g_frame_buffer); Line++)
+			ST7565_QueuePage(Line + 1, g_frame_buffer[Line]);
+
+		ST7565_DmaStart();
+	}
+
+	void ST7565_BlitStatusLine(void)
+	{	// the top small text line on the display
+		ST7565_QueuePage(0, g_status_line);
+		ST7565_DmaStart();
+	}
+#else
+	static void ST7565_BlitPage(const unsigned int page, const uint8_t *p_src)
+	{	// send the column span that differs from what the glass shows, nothing at all if it's the same
+		uint8_t     *p_shadow = lcd_shadow[page];
+		unsigned int first    = 0;
+		unsigned int last     = LCD_WIDTH;
+
+		while (first < LCD_WIDTH && p_src[first] == p_shadow[first])
+			first++;
+		if (first >= LCD_WIDTH)
+			return;
+		while (p_src[last - 1] == p_shadow[last - 1])
+			last--;
+
+		ST7565_SelectColumnAndLine(first + 4, page);
 		GPIO_SetBit(&GPIOB->DATA, GPIOB_PIN_ST7565_A0);
-		for (Column = 0; Column < ARRAY_SIZE(g_frame_buffer[0]); Column++)
+		for ( ; first < last; first++)
 		{
 			while ((SPI0->FIFOST & SPI_FIFOST_TFF_MASK) != SPI_FIFOST_TFF_BITS_NOT_FULL) {}
-			SPI0->WDR = g_frame_buffer[Line][Column];
+			SPI0->WDR = p_shadow[first] = p_src[first];
 		}
 		SPI_WaitForUndocumentedTxFifoStatusBit();
 	}
 
-	#if 0
-		// whats the delay for, it holds things up :(
-		SYSTEM_DelayMs(20);
-	#else
-//		SYSTEM_DelayMs(1);
-	#endif
+	void ST7565_BlitFullScreen(void)
+	{
+		unsigned int Line;
 
-	SPI_ToggleMasterMode(&SPI0->CR, true);
-}
+		SPI_ToggleMasterMode(&SPI0->CR, false);
 
-void ST7565_BlitStatusLine(void)
-{	// the top small text line on the display
+		ST7565_WriteByte(0x40);
 
-	unsigned int i;
+		for (Line = 0; Line < ARRAY_SIZE(g_frame_buffer); Line++)
+			ST7565_BlitPage(Line + 1, g_frame_buffer[Line]);
 
-	SPI_ToggleMasterMode(&SPI0->CR, false);
+		SPI_ToggleMasterMode(&SPI0->CR, true);
+	}
 
-	ST7565_WriteByte(0x40);    // start line ?
+	void ST7565_BlitStatusLine(void)
+	{	// the top small text line on the display
 
-	ST7565_SelectColumnAndLine(4, 0);
+		SPI_ToggleMasterMode(&SPI0->CR, false);
 
-	GPIO_SetBit(&GPIOB->DATA, GPIOB_PIN_ST7565_A0);
+		ST7565_WriteByte(0x40);    // start line ?
 
-	for (i = 0; i < ARRAY_SIZE(g_status_line); i++)
-	{
-		while ((SPI0->FIFOST & SPI_FIFOST_TFF_MASK) != SPI_FIFOST_TFF_BITS_NOT_FULL) {}
-		SPI0->WDR = g_status_line[i];
+		ST7565_BlitPage(0, g_status_line);
+
+		SPI_ToggleMasterMode(&SPI0->CR, true);
 	}
+#endif
 
-	SPI_WaitForUndocumentedTxFifoStatusBit();
+void ST7565_Refresh(void)
+{	// reset some of the displays settings and re-send the whole screen to try and overcome
+	// the radios hardware problem - RF corrupting the display
+	#ifdef ENABLE_LCD_DMA
+		ST7565_Init(false);      // also waits for anything still queued
 
-	SPI_ToggleMasterMode(&SPI0->CR, true);
+		lcd_forced = 0xff;
+		ST7565_DmaStart();
+	#else
+		unsigned int Line;
+
+		ST7565_Init(false);
+
+		SPI_ToggleMasterMode(&SPI0->CR, false);
+
+		for (Line = 0; Line < ARRAY_SIZE(lcd_shadow); Line++)
+		{
+			unsigned int Column;
+			ST7565_SelectColumnAndLine(4, Line);
+			GPIO_SetBit(&GPIOB->DATA, GPIOB_PIN_ST7565_A0);
+			for (Column = 0; Column < ARRAY_SIZE(lcd_shadow[0]); Column++)
+			{
+				while ((SPI0->FIFOST & SPI_FIFOST_TFF_MASK) != SPI_FIFOST_TFF_BITS_NOT_FULL) {}
+				SPI0->WDR = lcd_shadow[Line][Column];
+			}
+			SPI_WaitForUndocumentedTxFifoStatusBit();
+		}
+
+		SPI_ToggleMasterMode(&SPI0->CR, true);
+	#endif
 }
 
 void ST7565_FillScreen(const uint8_t Value)
@@ -147,6 +362,8 @@ void ST7565_FillScreen(const uint8_t Value)
 	}
 
 	SPI_ToggleMasterMode(&SPI0->CR, true);
+
+	memset(lcd_shadow, Value, sizeof(lcd_shadow));
 }
 
 void ST7565_Init(const bool full)
@@ -155,7 +372,19 @@ void ST7565_Init(const bool full)
 	{
 		SPI0_Init();
 		ST7565_HardwareReset();
+
+		#ifdef ENABLE_LCD_DMA
+			DMA_CH2->CTR = 0;
+			DMA_INTST    = DMA_INTST_CH2_TC_INTST_BITS_SET;
+			DMA_INTEN    = (DMA_INTEN & ~DMA_INTEN_CH2_TC_INTEN_MASK) | DMA_INTEN_CH2_TC_INTEN_BITS_ENABLE;
+			DMA_CTR      = (DMA_CTR & ~DMA_CTR_DMAEN_MASK) | DMA_CTR_DMAEN_BITS_ENABLE;
+			NVIC_EnableIRQ((IRQn_Type)DP32_DMA_IRQn);
+		#endif
 	}
+	#ifdef ENABLE_LCD_DMA
+		else
+			ST7565_BlitWait();
+	#endif
 
 	SPI_ToggleMasterMode(&SPI0->CR, false);
 
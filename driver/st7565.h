@@ -29,6 +29,12 @@ extern uint8_t g_frame_buffer[7][128];
 void    ST7565_DrawLine(const unsigned int Column, const unsigned int Line, const unsigned int Size, const uint8_t *pBitmap);
 void    ST7565_BlitFullScreen(void);
 void    ST7565_BlitStatusLine(void);
+#ifdef ENABLE_LCD_DMA
+	bool    ST7565_BlitBusy(void);
+	void    ST7565_BlitWait(void);
+	void    ST7565_DMA_Interrupt(void);
+#endif
+void    ST7565_Refresh(void);
 void    ST7565_FillScreen(const uint8_t Value);
 void    ST7565_Init(const bool full);
 void    ST7565_HardwareReset(void);
@@ -17,14 +17,32 @@
 #include <string.h>
 #include <stdbool.h>
 
+#include "ARMCM0.h"
 #include "bsp/dp32g030/dma.h"
+#include "bsp/dp32g030/irq.h"
 #include "bsp/dp32g030/syscon.h"
 #include "bsp/dp32g030/uart.h"
 #include "driver/uart.h"
 #include "external/printf/printf.h"
 
 static bool UART_IsLogEnabled;
-uint8_t     UART_DMA_Buffer[256];
+uint8_t     UART_DMA_Buffer[512];   // room for a full size command + whatever arrives while it's being handled
+
+#ifdef ENABLE_UART_TX_DMA
+	// transmit ring, drained by DMA channel 1
+	//
+	// UART_Send() only copies into here, so a 128 byte reply no longer holds up the main loop
+	// for the 33ms it takes to go out at 38400 baud
+
+	#define UART_TX_BUFFER_SIZE  512u
+
+	static uint8_t           tx_buffer[UART_TX_BUFFER_SIZE];
+	static volatile uint16_t tx_head;       // where the next byte goes
+	static volatile uint16_t tx_tail;       // first byte not yet sent
+	static volatile uint16_t tx_dma_len;    // bytes in the running DMA transfer, 0 when idle
+
+	UART_tx_stats_t g_uart_tx_stats;
+#endif
 
 void UART_Init(void)
 {
@@ -59,20 +77,21 @@ void UART_Init(void)
 		| DMA_CH_MOD_MD_SIZE_BITS_8BIT
 		| DMA_CH_MOD_MD_SEL_BITS_SRAM
 		;
-	DMA_INTEN = 0;
+	// only our two channels, CH2 belongs to the display (ENABLE_LCD_DMA)
+	#ifdef ENABLE_UART_TX_DMA
+		DMA_INTEN = (DMA_INTEN & ~(DMA_INTEN_CH0_TC_INTEN_MASK | DMA_INTEN_CH1_TC_INTEN_MASK)) | DMA_INTEN_CH1_TC_INTEN_BITS_ENABLE;
+	#else
+		DMA_INTEN =  DMA_INTEN & ~(DMA_INTEN_CH0_TC_INTEN_MASK | DMA_INTEN_CH1_TC_INTEN_MASK);
+	#endif
 	DMA_INTST = 0
 		| DMA_INTST_CH0_TC_INTST_BITS_SET
 		| DMA_INTST_CH1_TC_INTST_BITS_SET
-		| DMA_INTST_CH2_TC_INTST_BITS_SET
-		| DMA_INTST_CH3_TC_INTST_BITS_SET
 		| DMA_INTST_CH0_THC_INTST_BITS_SET
 		| DMA_INTST_CH1_THC_INTST_BITS_SET
-		| DMA_INTST_CH2_THC_INTST_BITS_SET
-		| DMA_INTST_CH3_THC_INTST_BITS_SET
 		;
 	DMA_CH0->CTR = 0
 		| DMA_CH_CTR_CH_EN_BITS_ENABLE
-		| ((0xFF << DMA_CH_CTR_LENGTH_SHIFT) & DMA_CH_CTR_LENGTH_MASK)
+		| (((sizeof(UART_DMA_Buffer) - 1) << DMA_CH_CTR_LENGTH_SHIFT) & DMA_CH_CTR_LENGTH_MASK)
 		| DMA_CH_CTR_LOOP_BITS_ENABLE
 		| DMA_CH_CTR_PRI_BITS_MEDIUM
 		;
@@ -80,20 +99,170 @@ void UART_Init(void)
 
 	DMA_CTR = (DMA_CTR & ~DMA_CTR_DMAEN_MASK) | DMA_CTR_DMAEN_BITS_ENABLE;
 
+	#ifdef ENABLE_UART_TX_DMA
+		tx_head    = 0;
+		tx_tail    = 0;
+		tx_dma_len = 0;
+
+		UART1->CTRL |= UART_CTRL_TXDMAEN_BITS_ENABLE;
+
+		NVIC_EnableIRQ((IRQn_Type)DP32_DMA_IRQn);
+	#endif
+
 	UART1->CTRL |= UART_CTRL_UARTEN_BITS_ENABLE;
 }
 
-void UART_Send(const void *pBuffer, uint32_t Size)
-{
-	const uint8_t *pData = (const uint8_t *)pBuffer;
-	uint32_t i;
+#ifdef ENABLE_UART_TX_DMA
+	// retire a finished DMA transfer and start the next one
+	// interrupts must be off, it's called from both the DMA interrupt and UART_Send()
+	static void UART_TxKick(void)
+	{
+		uint16_t len;
+
+		if (tx_dma_len > 0)
+		{
+			if ((DMA_INTST & DMA_INTST_CH1_TC_INTST_MASK) == DMA_INTST_CH1_TC_INTST_BITS_NOT_SET)
+				return;     // still going
+
+			DMA_INTST  = DMA_INTST_CH1_TC_INTST_BITS_SET;
+			tx_tail    = (tx_tail + tx_dma_len) % UART_TX_BUFFER_SIZE;
+			tx_dma_len = 0;
+		}
+
+		if (tx_tail == tx_head)
+			return;         // all sent
 
-	for (i = 0; i < Size; i++)
+		// one contiguous run at a time, the wrapped remainder goes next time round
+		len = (tx_head > tx_tail) ? (uint16_t)(tx_head - tx_tail) : (uint16_t)(UART_TX_BUFFER_SIZE - tx_tail);
+
+		DMA_CH1->CTR    = 0;
+		DMA_CH1->MSADDR = (uint32_t)(uintptr_t)&tx_buffer[tx_tail];
+		DMA_CH1->MDADDR = (uint32_t)(uintptr_t)&UART1->TDR;
+		DMA_CH1->MOD    = 0
+			// Source
+			| DMA_CH_MOD_MS_ADDMOD_BITS_INCREMENT
+			| DMA_CH_MOD_MS_SIZE_BITS_8BIT
+			| DMA_CH_MOD_MS_SEL_BITS_SRAM
+			// Destination
+			| DMA_CH_MOD_MD_ADDMOD_BITS_NONE
+			| DMA_CH_MOD_MD_SIZE_BITS_8BIT
+			| DMA_CH_MOD_MD_SEL_BITS_HSREQ_MS0    // UART1 TX request, RX is on MS1
+			;
+		tx_dma_len      = len;
+		DMA_CH1->CTR    = 0
+			| DMA_CH_CTR_CH_EN_BITS_ENABLE
+			| (((len - 1) << DMA_CH_CTR_LENGTH_SHIFT) & DMA_CH_CTR_LENGTH_MASK)
+			| DMA_CH_CTR_LOOP_BITS_DISABLE
+			| DMA_CH_CTR_PRI_BITS_MEDIUM
+			;
+	}
+
+	void UART_DMA_Interrupt(void)
 	{
-		UART1->TDR = pData[i];
-		while ((UART1->IF & UART_IF_TXFIFO_FULL_MASK) != UART_IF_TXFIFO_FULL_BITS_NOT_SET) {}
+		UART_TxKick();
 	}
-}
+
+	bool UART_TxBusy(void)
+	{
+		return tx_head != tx_tail;
+	}
+
+	uint16_t UART_TxFree(void)
+	{
+		return (UART_TX_BUFFER_SIZE - 1) - ((tx_head + UART_TX_BUFFER_SIZE - tx_tail) % UART_TX_BUFFER_SIZE);
+	}
+
+	void UART_TxFlush(void)
+	{
+		while (UART_TxBusy())
+		{
+			const uint32_t primask = __get_PRIMASK();
+			__disable_irq();
+			UART_TxKick();
+			__set_PRIMASK(primask);
+		}
+
+		// and the last few bytes out of the FIFO
+		while ((UART1->IF & UART_IF_TXFIFO_EMPTY_MASK) == UART_IF_TXFIFO_EMPTY_BITS_NOT_SET) {}
+	}
+
+	void UART_Send(const void *pBuffer, uint32_t Size)
+	{
+		const uint8_t *pData   = (const uint8_t *)pBuffer;
+		bool           stalled = false;
+
+		while (Size > 0)
+		{
+			const uint32_t primask = __get_PRIMASK();
+			uint16_t       used;
+			uint16_t       len;
+
+			__disable_irq();
+
+			used = (tx_head + UART_TX_BUFFER_SIZE - tx_tail) % UART_TX_BUFFER_SIZE;
+			len  = (UART_TX_BUFFER_SIZE - 1) - used;
+
+			if (len == 0)
+			{	// back-pressure, wait for the DMA to make room
+				// polled rather than left to the interrupt, we may have been called with interrupts off
+				if (!stalled)
+				{	// once per call, not per poll
+					stalled = true;
+					g_uart_tx_stats.stalls++;
+				}
+				UART_TxKick();
+				__set_PRIMASK(primask);
+				continue;
+			}
+
+			if (len > (UART_TX_BUFFER_SIZE - tx_head))
+				len = UART_TX_BUFFER_SIZE - tx_head;
+			if (len > Size)
+				len = Size;
+
+			memcpy(&tx_buffer[tx_head], pData, len);
+			tx_head = (tx_head + len) % UART_TX_BUFFER_SIZE;
+
+			used += len;
+			if (g_uart_tx_stats.high_water < used)
+				g_uart_tx_stats.high_water = used;
+			g_uart_tx_stats.bytes += len;
+
+			UART_TxKick();
+
+			__set_PRIMASK(primask);
+
+			pData += len;
+			Size  -= len;
+		}
+	}
+#else
+	void UART_Send(const void *pBuffer, uint32_t Size)
+	{
+		const uint8_t *pData = (const uint8_t *)pBuffer;
+		uint32_t i;
+
+		for (i = 0; i < Size; i++)
+		{
+			UART1->TDR = pData[i];
+			while ((UART1->IF & UART_IF_TXFIFO_FULL_MASK) != UART_IF_TXFIFO_FULL_BITS_NOT_SET) {}
+		}
+	}
+
+	bool UART_TxBusy(void)
+	{
+		return false;
+	}
+
+	uint16_t UART_TxFree(void)
+	{	// UART_Send() waits on the FIFO a byte at a time, an empty one takes 8 without waiting
+		return ((UART1->IF & UART_IF_TXFIFO_EMPTY_MASK) != UART_IF_TXFIFO_EMPTY_BITS_NOT_SET) ? 8 : 0;
+	}
+
+	void UART_TxFlush(void)
+	{
+	}
+#endif
 
 void UART_SendText(const void *str)
 {
@@ -18,13 +18,29 @@
 #ifndef DRIVER_UART_H
 #define DRIVER_UART_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
-extern uint8_t UART_DMA_Buffer[256];
+extern uint8_t UART_DMA_Buffer[512];
+
+#ifdef ENABLE_UART_TX_DMA
+	typedef struct {
+		uint32_t bytes;         // bytes queued
+		uint16_t high_water;    // most bytes ever waiting in the TX ring
+		uint16_t stalls;        // times UART_Send() had to wait for room
+	} UART_tx_stats_t;
+
+	extern UART_tx_stats_t g_uart_tx_stats;
+
+	void UART_DMA_Interrupt(void);
+#endif
 
 void UART_Init(void);
 void UART_Send(const void *pBuffer, uint32_t Size);
 void UART_SendText(const void *str);
+bool UART_TxBusy(void);
+uint16_t UART_TxFree(void);    // bytes UART_Send() takes without waiting
+void UART_TxFlush(void);
 void UART_LogSend(const void *pBuffer, uint32_t Size);
 void UART_LogSendText(const void *str);
 #if defined(ENABLE_UART) && defined(ENABLE_UART_DEBUG)
@@ -0,0 +1,338 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "fec.h"
+
+#define A0   255                    // log of 0, there isn't one
+
+// GF(256) powers of alpha, twice round so adding two logs never needs reducing
+static const uint8_t gf_exp[510] =
+{
+	0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1D, 0x3A, 0x74, 0xE8, 0xCD, 0x87, 0x13, 0x26,
+	0x4C, 0x98, 0x2D, 0x5A, 0xB4, 0x75, 0xEA, 0xC9, 0x8F, 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0xC0,
+	0x9D, 0x27, 0x4E, 0x9C, 0x25, 0x4A, 0x94, 0x35, 0x6A, 0xD4, 0xB5, 0x77, 0xEE, 0xC1, 0x9F, 0x23,
+	0x46, 0x8C, 0x05, 0x0A, 0x14, 0x28, 0x50, 0xA0, 0x5D, 0xBA, 0x69, 0xD2, 0xB9, 0x6F, 0xDE, 0xA1,
+	0x5F, 0xBE, 0x61, 0xC2, 0x99, 0x2F, 0x5E, 0xBC, 0x65, 0xCA, 0x89, 0x0F, 0x1E, 0x3C, 0x78, 0xF0,
+	0xFD, 0xE7, 0xD3, 0xBB, 0x6B, 0xD6, 0xB1, 0x7F, 0xFE, 0xE1, 0xDF, 0xA3, 0x5B, 0xB6, 0x71, 0xE2,
+	0xD9, 0xAF, 0x43, 0x86, 0x11, 0x22, 0x44, 0x88, 0x0D, 0x1A, 0x34, 0x68, 0xD0, 0xBD, 0x67, 0xCE,
+	0x81, 0x1F, 0x3E, 0x7C, 0xF8, 0xED, 0xC7, 0x93, 0x3B, 0x76, 0xEC, 0xC5, 0x97, 0x33, 0x66, 0xCC,
+	0x85, 0x17, 0x2E, 0x5C, 0xB8, 0x6D, 0xDA, 0xA9, 0x4F, 0x9E, 0x21, 0x42, 0x84, 0x15, 0x2A, 0x54,
+	0xA8, 0x4D, 0x9A, 0x29, 0x52, 0xA4, 0x55, 0xAA, 0x49, 0x92, 0x39, 0x72, 0xE4, 0xD5, 0xB7, 0x73,
+	0xE6, 0xD1, 0xBF, 0x63, 0xC6, 0x91, 0x3F, 0x7E, 0xFC, 0xE5, 0xD7, 0xB3, 0x7B, 0xF6, 0xF1, 0xFF,
+	0xE3, 0xDB, 0xAB, 0x4B, 0x96, 0x31, 0x62, 0xC4, 0x95, 0x37, 0x6E, 0xDC, 0xA5, 0x57, 0xAE, 0x41,
+	0x82, 0x19, 0x32, 0x64, 0xC8, 0x8D, 0x07, 0x0E, 0x1C, 0x38, 0x70, 0xE0, 0xDD, 0xA7, 0x53, 0xA6,
+	0x51, 0xA2, 0x59, 0xB2, 0x79, 0xF2, 0xF9, 0xEF, 0xC3, 0x9B, 0x2B, 0x56, 0xAC, 0x45, 0x8A, 0x09,
+	0x12, 0x24, 0x48, 0x90, 0x3D, 0x7A, 0xF4, 0xF5, 0xF7, 0xF3, 0xFB, 0xEB, 0xCB, 0x8B, 0x0B, 0x16,
+	0x2C, 0x58, 0xB0, 0x7D, 0xFA, 0xE9, 0xCF, 0x83, 0x1B, 0x36, 0x6C, 0xD8, 0xAD, 0x47, 0x8E, 0x01,
+	0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1D, 0x3A, 0x74, 0xE8, 0xCD, 0x87, 0x13, 0x26, 0x4C,
+	0x98, 0x2D, 0x5A, 0xB4, 0x75, 0xEA, 0xC9, 0x8F, 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0xC0, 0x9D,
+	0x27, 0x4E, 0x9C, 0x25, 0x4A, 0x94, 0x35, 0x6A, 0xD4, 0xB5, 0x77, 0xEE, 0xC1, 0x9F, 0x23, 0x46,
+	0x8C, 0x05, 0x0A, 0x14, 0x28, 0x50, 0xA0, 0x5D, 0xBA, 0x69, 0xD2, 0xB9, 0x6F, 0xDE, 0xA1, 0x5F,
+	0xBE, 0x61, 0xC2, 0x99, 0x2F, 0x5E, 0xBC, 0x65, 0xCA, 0x89, 0x0F, 0x1E, 0x3C, 0x78, 0xF0, 0xFD,
+	0xE7, 0xD3, 0xBB, 0x6B, 0xD6, 0xB1, 0x7F, 0xFE, 0xE1, 0xDF, 0xA3, 0x5B, 0xB6, 0x71, 0xE2, 0xD9,
+	0xAF, 0x43, 0x86, 0x11, 0x22, 0x44, 0x88, 0x0D, 0x1A, 0x34, 0x68, 0xD0, 0xBD, 0x67, 0xCE, 0x81,
+	0x1F, 0x3E, 0x7C, 0xF8, 0xED, 0xC7, 0x93, 0x3B, 0x76, 0xEC, 0xC5, 0x97, 0x33, 0x66, 0xCC, 0x85,
+	0x17, 0x2E, 0x5C, 0xB8, 0x6D, 0xDA, 0xA9, 0x4F, 0x9E, 0x21, 0x42, 0x84, 0x15, 0x2A, 0x54, 0xA8,
+	0x4D, 0x9A, 0x29, 0x52, 0xA4, 0x55, 0xAA, 0x49, 0x92, 0x39, 0x72, 0xE4, 0xD5, 0xB7, 0x73, 0xE6,
+	0xD1, 0xBF, 0x63, 0xC6, 0x91, 0x3F, 0x7E, 0xFC, 0xE5, 0xD7, 0xB3, 0x7B, 0xF6, 0xF1, 0xFF, 0xE3,
+	0xDB, 0xAB, 0x4B, 0x96, 0x31, 0x62, 0xC4, 0x95, 0x37, 0x6E, 0xDC, 0xA5, 0x57, 0xAE, 0x41, 0x82,
+	0x19, 0x32, 0x64, 0xC8, 0x8D, 0x07, 0x0E, 0x1C, 0x38, 0x70, 0xE0, 0xDD, 0xA7, 0x53, 0xA6, 0x51,
+	0xA2, 0x59, 0xB2, 0x79, 0xF2, 0xF9, 0xEF, 0xC3, 0x9B, 0x2B, 0x56, 0xAC, 0x45, 0x8A, 0x09, 0x12,
+	0x24, 0x48, 0x90, 0x3D, 0x7A, 0xF4, 0xF5, 0xF7, 0xF3, 0xFB, 0xEB, 0xCB, 0x8B, 0x0B, 0x16, 0x2C,
+	0x58, 0xB0, 0x7D, 0xFA, 0xE9, 0xCF, 0x83, 0x1B, 0x36, 0x6C, 0xD8, 0xAD, 0x47, 0x8E
+};
+
+static const uint8_t gf_log[256] =
+{
+	0xFF, 0x00, 0x01, 0x19, 0x02, 0x32, 0x1A, 0xC6, 0x03, 0xDF, 0x33, 0xEE, 0x1B, 0x68, 0xC7, 0x4B,
+	0x04, 0x64, 0xE0, 0x0E, 0x34, 0x8D, 0xEF, 0x81, 0x1C, 0xC1, 0x69, 0xF8, 0xC8, 0x08, 0x4C, 0x71,
+	0x05, 0x8A, 0x65, 0x2F, 0xE1, 0x24, 0x0F, 0x21, 0x35, 0x93, 0x8E, 0xDA, 0xF0, 0x12, 0x82, 0x45,
+	0x1D, 0xB5, 0xC2, 0x7D, 0x6A, 0x27, 0xF9, 0xB9, 0xC9, 0x9A, 0x09, 0x78, 0x4D, 0xE4, 0x72, 0xA6,
+	0x06, 0xBF, 0x8B, 0x62, 0x66, 0xDD, 0x30, 0xFD, 0xE2, 0x98, 0x25, 0xB3, 0x10, 0x91, 0x22, 0x88,
+	0x36, 0xD0, 0x94, 0xCE, 0x8F, 0x96, 0xDB, 0xBD, 0xF1, 0xD2, 0x13, 0x5C, 0x83, 0x38, 0x46, 0x40,
+	0x1E, 0x42, 0xB6, 0xA3, 0xC3, 0x48, 0x7E, 0x6E, 0x6B, 0x3A, 0x28, 0x54, 0xFA, 0x85, 0xBA, 0x3D,
+	0xCA, 0x5E, 0x9B, 0x9F, 0x0A, 0x15, 0x79, 0x2B, 0x4E, 0xD4, 0xE5, 0xAC, 0x73, 0xF3, 0xA7, 0x57,
+	0x07, 0x70, 0xC0, 0xF7, 0x8C, 0x80, 0x63, 0x0D, 0x67, 0x4A, 0xDE, 0xED, 0x31, 0xC5, 0xFE, 0x18,
+	0xE3, 0xA5, 0x99, 0x77, 0x26, 0xB8, 0xB4, 0x7C, 0x11, 0x44, 0x92, 0xD9, 0x23, 0x20, 0x89, 0x2E,
+	0x37, 0x3F, 0xD1, 0x5B, 0x95, 0xBC, 0xCF, 0xCD, 0x90, 0x87, 0x97, 0xB2, 0xDC, 0xFC, 0xBE, 0x61,
+	0xF2, 0x56, 0xD3, 0xAB, 0x14, 0x2A, 0x5D, 0x9E, 0x84, 0x3C, 0x39, 0x53, 0x47, 0x6D, 0x41, 0xA2,
+	0x1F, 0x2D, 0x43, 0xD8, 0xB7, 0x7B, 0xA4, 0x76, 0xC4, 0x17, 0x49, 0xEC, 0x7F, 0x0C, 0x6F, 0xF6,
+	0x6C, 0xA1, 0x3B, 0x52, 0x29, 0x9D, 0x55, 0xAA, 0xFB, 0x60, 0x86, 0xB1, 0xBB, 0xCC, 0x3E, 0x5A,
+	0xCB, 0x59, 0x5F, 0xB0, 0x9C, 0xA9, 0xA0, 0x51, 0x0B, 0xF5, 0x16, 0xEB, 0x7A, 0x75, 0x2C, 0xD7,
+	0x4F, 0xAE, 0xD5, 0xE9, 0xE6, 0xE7, 0xAD, 0xE8, 0x74, 0xD6, 0xF4, 0xEA, 0xA8, 0x50, 0x58, 0xAF
+};
+
+static uint8_t      genpoly[FEC_MAX_PARITY + 1];    // log form
+static unsigned int genpoly_parity;
+
+// ****************************
+
+static unsigned int FEC_mod255(unsigned int x)
+{
+	while (x >= 255)
+		x -= 255;
+	return x;
+}
+
+static void FEC_generator(const unsigned int parity)
+{	// g(x) = (x - a^0)(x - a^1) .. (x - a^(parity - 1)), only worked out again when the parity size changes
+	unsigned int i;
+	unsigned int j;
+
+	if (genpoly_parity == parity)
+		return;
+
+	genpoly[0] = 1;
+	for (i = 0; i < parity; i++)
+	{
+		genpoly[i + 1] = 1;
+		for (j = i; j > 0; j--)
+			genpoly[j] = (genpoly[j] != 0) ? genpoly[j - 1] ^ gf_exp[gf_log[genpoly[j]] + i] : genpoly[j - 1];
+		genpoly[0] = gf_exp[gf_log[genpoly[0]] + i];
+	}
+
+	for (i = 0; i <= parity; i++)
+		genpoly[i] = gf_log[genpoly[i]];
+
+	genpoly_parity = parity;
+}
+
+static bool FEC_args_ok(const uint16_t len, const unsigned int parity, const unsigned int depth)
+{	// the longest codeword (number 0) has to fit in 255 bytes
+	return parity > 0 && parity <= FEC_MAX_PARITY && depth > 0 && depth <= FEC_MAX_DEPTH &&
+		(((len + depth - 1) / depth) + parity) <= 255;
+}
+
+// ****************************
+
+void FEC_encode(uint8_t *data, const uint16_t len, const unsigned int parity, const unsigned int depth)
+{
+	unsigned int k;
+
+	if (!FEC_args_ok(len, parity, depth))
+		return;
+
+	FEC_generator(parity);
+
+	for (k = 0; k < depth; k++)
+	{
+		uint8_t      par[FEC_MAX_PARITY];
+		unsigned int i;
+		unsigned int j;
+
+		memset(par, 0, parity);
+
+		for (i = k; i < len; i += depth)
+		{	// clock the data byte through the generator's shift register
+			const uint8_t fb = gf_log[data[i] ^ par[0]];
+
+			for (j = 1; j < parity; j++)
+				par[j - 1] = (fb != A0) ? par[j] ^ gf_exp[fb + genpoly[parity - j]] : par[j];
+			par[parity - 1] = (fb != A0) ? gf_exp[fb + genpoly[0]] : 0;
+		}
+
+		for (j = 0; j < parity; j++)
+			data[len + k + (j * depth)] = par[j];
+	}
+}
+
+// ****************************
+
+static unsigned int FEC_position(const unsigned int p, const unsigned int m, const uint16_t len, const unsigned int k, const unsigned int depth)
+{	// where codeword byte 'p' is in the packet
+	return (p < m) ? k + (p * depth) : len + k + ((p - m) * depth);
+}
+
+static int FEC_decode_codeword(uint8_t *data, const uint16_t len, const unsigned int k, const unsigned int parity, const unsigned int depth)
+{	// Berlekamp-Massey for the error locator, Chien search over the bytes that are really there, then Forney
+	const unsigned int m   = (k < len) ? (len - k + depth - 1) / depth : 0;   // data bytes in this codeword
+	const unsigned int n   = m + parity;
+	const unsigned int pad = 255 - n;                                         // the zeros it was shortened by
+	uint8_t            s[FEC_MAX_PARITY];
+	uint8_t            lambda[FEC_MAX_PARITY + 1];
+	uint8_t            b[FEC_MAX_PARITY + 1];
+	uint8_t            t[FEC_MAX_PARITY + 1];
+	uint8_t            omega[FEC_MAX_PARITY + 1];
+	uint8_t            root[FEC_MAX_PARITY];
+	uint8_t            loc[FEC_MAX_PARITY];
+	unsigned int       deg_lambda = 0;
+	unsigned int       deg_omega;
+	unsigned int       count      = 0;
+	unsigned int       el         = 0;
+	unsigned int       syndromes  = 0;
+	unsigned int       r;
+	unsigned int       i;
+	unsigned int       j;
+	unsigned int       p;
+
+	// syndromes .. the codeword evaluated at each root of the generator
+	memset(s, 0, parity);
+	for (p = 0; p < n; p++)
+	{
+		const uint8_t c = data[FEC_position(p, m, len, k, depth)];
+		for (i = 0; i < parity; i++)
+			s[i] = (s[i] == 0) ? c : c ^ gf_exp[gf_log[s[i]] + i];
+	}
+
+	for (i = 0; i < parity; i++)
+	{
+		syndromes |= s[i];
+		s[i]       = gf_log[s[i]];
+	}
+
+	if (syndromes == 0)
+		return 0;        // nothing wrong
+
+	// error locator polynomial
+	memset(lambda, 0, parity + 1);
+	lambda[0] = 1;
+	for (i = 0; i <= parity; i++)
+		b[i] = gf_log[lambda[i]];
+
+	for (r = 1; r <= parity; r++)
+	{
+		uint8_t discr = 0;
+
+		for (i = 0; i < r; i++)
+			if (lambda[i] != 0 && s[r - i - 1] != A0)
+				discr ^= gf_exp[gf_log[lambda[i]] + s[r - i - 1]];
+		discr = gf_log[discr];
+
+		if (discr == A0)
+		{
+			memmove(&b[1], &b[0], parity);
+			b[0] = A0;
+			continue;
+		}
+
+		t[0] = lambda[0];
+		for (i = 0; i < parity; i++)
+			t[i + 1] = (b[i] != A0) ? lambda[i + 1] ^ gf_exp[discr + b[i]] : lambda[i + 1];
+
+		if ((2 * el) <= (r - 1))
+		{
+			el = r - el;
+			for (i = 0; i <= parity; i++)
+				b[i] = (lambda[i] == 0) ? A0 : FEC_mod255(gf_log[lambda[i]] + 255 - discr);
+		}
+		else
+		{
+			memmove(&b[1], &b[0], parity);
+			b[0] = A0;
+		}
+
+		memcpy(lambda, t, parity + 1);
+	}
+
+	for (i = 0; i <= parity; i++)
+	{
+		lambda[i] = gf_log[lambda[i]];
+		if (lambda[i] != A0)
+			deg_lambda = i;
+	}
+
+	if (deg_lambda == 0 || deg_lambda > (parity / 2))
+		return -1;
+
+	{	// Chien search, only over the positions that were sent .. t[] holds the running terms
+		for (j = 1; j <= deg_lambda; j++)
+			t[j] = (lambda[j] != A0) ? (lambda[j] + (j * pad)) % 255 : A0;
+
+		for (i = pad + 1; i <= 255 && count < deg_lambda; i++)
+		{
+			uint8_t q = 1;
+
+			for (j = deg_lambda; j > 0; j--)
+			{
+				if (t[j] != A0)
+				{
+					t[j] = FEC_mod255(t[j] + j);
+					q   ^= gf_exp[t[j]];
+				}
+			}
+
+			if (q == 0)
+			{
+				root[count] = (uint8_t)i;
+				loc[count]  = (uint8_t)(i - 1 - pad);
+				count++;
+			}
+		}
+	}
+
+	if (count != deg_lambda)
+		return -1;       // some of the roots are in the part that wasn't sent, too many errors
+
+	// error evaluator polynomial
+	deg_omega = deg_lambda - 1;
+	for (i = 0; i <= deg_omega; i++)
+	{
+		uint8_t tmp = 0;
+		for (j = 0; j <= i; j++)
+			if (s[i - j] != A0 && lambda[j] != A0)
+				tmp ^= gf_exp[s[i - j] + lambda[j]];
+		omega[i] = gf_log[tmp];
+	}
+
+	// Forney .. the error values
+	for (j = 0; j < count; j++)
+	{
+		uint8_t num = 0;
+		uint8_t den = 0;
+		int     d;
+
+		for (i = 0; i <= deg_omega; i++)
+			if (omega[i] != A0)
+				num ^= gf_exp[(omega[i] + (i * root[j])) % 255];
+
+		// the formal derivative of lambda, the odd terms
+		for (d = (int)(((deg_lambda < parity) ? deg_lambda : parity - 1) & ~1u); d >= 0; d -= 2)
+			if (lambda[d + 1] != A0)
+				den ^= gf_exp[(lambda[d + 1] + (d * root[j])) % 255];
+
+		if (den == 0)
+			return -1;
+
+		if (num != 0)    // first root 0, so the a^-root factor
+			data[FEC_position(loc[j], m, len, k, depth)] ^= gf_exp[(gf_log[num] + (255 - root[j]) + 255 - gf_log[den]) % 255];
+	}
+
+	return count;
+}
+
+int FEC_decode(uint8_t *data, const uint16_t len, const unsigned int parity, const unsigned int depth)
+{
+	unsigned int k;
+	int          total = 0;
+
+	if (!FEC_args_ok(len, parity, depth))
+		return -1;
+
+	for (k = 0; k < depth; k++)
+	{
+		const int n = FEC_decode_codeword(data, len, k, parity, depth);
+		if (n < 0)
+			return -1;
+		total += n;
+	}
+
+	return total;
+}
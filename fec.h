@@ -0,0 +1,47 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+
+#ifndef FEC_H
+#define FEC_H
+
+#include <stdint.h>
+
+// Reed-Solomon forward error correction over GF(256) for FSK packets
+//
+// the packet's data stays where it is and the parity goes on the end, so a receiver that doesn't
+// bother decoding still sees the data. With a depth of more than 1 the packet is split into that
+// many interleaved codewords, byte n belongs to codeword n % depth, data and parity alike .. a burst
+// of errors on the air is then spread over all of them. Each codeword puts right up to parity / 2
+// bad bytes, a burst of up to depth x parity / 2 bytes in all.
+//
+//   [data 0 .. len - 1][parity of codeword 0, 1 .. depth - 1, 0, 1 .. depth - 1, ..]
+//
+// the codewords are shortened RS(255, 255 - parity) codes, GF(2^8) with x^8 + x^4 + x^3 + x^2 + 1,
+// first root 1. The work is all on the stack and bounded by FEC_MAX_PARITY, decoding a packet that's
+// arrived clean costs the syndromes and nothing more.
+
+#define FEC_MAX_PARITY    32        // bytes per codeword
+#define FEC_MAX_DEPTH     4
+
+// 'data' needs room for len + parity x depth bytes
+void FEC_encode(uint8_t *data, const uint16_t len, const unsigned int parity, const unsigned int depth);
+
+// puts right what it can in place, returns the number of bytes corrected or -1 if there were too many
+int  FEC_decode(uint8_t *data, const uint16_t len, const unsigned int parity, const unsigned int depth);
+
+#endif
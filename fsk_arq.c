@@ -0,0 +1,395 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#include <string.h>
+
+#include "fsk_arq.h"
+#include "fsk_link.h"
+
+enum {
+	ARQ_TX_IDLE = 0,
+	ARQ_TX_SEND,                    // a burst is waiting for the link
+	ARQ_TX_BURST,                   // on the air
+	ARQ_TX_WAIT                     // listening for the ACK
+};
+
+fsk_arq_tx_stats_t g_fsk_arq_tx_stats;
+fsk_arq_rx_stats_t g_fsk_arq_rx_stats;
+
+static struct {
+	const uint8_t      *data;
+	uint16_t            len;
+	uint16_t            frames;          // in the transfer
+	uint16_t            base;            // oldest frame not yet acknowledged
+	uint16_t            next;            // next new frame
+	uint16_t            acked;           // frames base + i the receiver already holds
+	uint16_t            burst[FSK_ARQ_MAX_WINDOW];
+	uint8_t             burst_count;
+	uint8_t             window;
+	uint8_t             dst;
+	uint8_t             session;
+	uint8_t             state;
+	uint8_t             retries;
+	uint16_t            timer_10ms;
+	uint16_t            srtt_x8;         // round trip estimate, 10ms units scaled up
+	uint16_t            rttvar_x4;
+	bool                rtt_sample;      // Karn .. no sample from a burst sent after a timeout
+	fsk_link_tx_done_t  done;
+} arq_tx;
+
+static struct {
+	fsk_arq_rx_t        rx;
+	bool                active;          // keep answering polls for the last transfer after it's complete
+	bool                ack_pending;
+	uint8_t             src;
+	uint8_t             session;
+	uint16_t            len;
+	uint16_t            frames;
+	uint16_t            next;            // next frame to hand up
+	uint16_t            have;            // frames next + i waiting in the window
+	uint8_t             buf[FSK_ARQ_MAX_WINDOW][FSK_LINK_PAYLOAD_BYTES];
+} arq_rx;
+
+// ****************************
+
+static uint16_t FSK_ARQ_frame_bytes(const uint16_t frame, const uint16_t len)
+{	// payload bytes of 'frame' in a 'len' byte transfer
+	const uint16_t offset = frame * FSK_LINK_PAYLOAD_BYTES;
+	return ((len - offset) > FSK_LINK_PAYLOAD_BYTES) ? FSK_LINK_PAYLOAD_BYTES : len - offset;
+}
+
+// ****************************
+// sender
+
+static void FSK_ARQ_tx_end(const bool ok)
+{
+	const fsk_link_tx_done_t done = arq_tx.done;
+
+	arq_tx.state = ARQ_TX_IDLE;
+	arq_tx.done  = NULL;
+
+	if (FSK_LINK_is_open() && !FSK_LINK_tx_busy())
+		FSK_LINK_listen(FSK_LINK_FRAME_BYTES);   // no more ACKs to wait for
+
+	if (done != NULL)
+		done(ok);
+}
+
+static uint16_t FSK_ARQ_build_data(const unsigned int index, uint8_t *frame)
+{
+	fsk_link_header_t *hdr   = (fsk_link_header_t *)frame;
+	const uint16_t     num   = arq_tx.burst[index];
+	const uint16_t     n     = FSK_ARQ_frame_bytes(num, arq_tx.len);
+	uint8_t           *payload = frame + FSK_LINK_HEADER_BYTES;
+
+	hdr->type  = FSK_LINK_TYPE_ARQ_DATA;
+	hdr->src   = FSK_LINK_address();
+	hdr->dst   = arq_tx.dst;
+	hdr->seq   = arq_tx.session;
+	hdr->index = (uint8_t)num;
+	hdr->count = ((index + 1u) >= arq_tx.burst_count) ? FSK_ARQ_FLAG_POLL : 0;
+	hdr->len   = arq_tx.len;
+
+	memcpy(payload, arq_tx.data + (num * FSK_LINK_PAYLOAD_BYTES), n);
+	memset(payload + n, 0, FSK_LINK_PAYLOAD_BYTES - n);
+
+	return FSK_LINK_FRAME_BYTES;
+}
+
+static void FSK_ARQ_burst_done(const bool ok)
+{
+	if (arq_tx.state != ARQ_TX_BURST)
+		return;
+
+	if (ok)
+	{	// the poll is out, time the ACK
+		arq_tx.state      = ARQ_TX_WAIT;
+		arq_tx.timer_10ms = 0;
+	}
+	else
+	{	// TX engine trouble, same as no ACK
+		arq_tx.state      = ARQ_TX_WAIT;
+		arq_tx.timer_10ms = g_fsk_arq_tx_stats.rto_10ms;
+	}
+}
+
+static void FSK_ARQ_next_burst(void)
+{	// what the receiver is missing first, then new frames as far as the window allows
+	unsigned int i;
+
+	arq_tx.burst_count = 0;
+
+	for (i = 0; i < (unsigned int)(arq_tx.next - arq_tx.base); i++)
+	{
+		if ((arq_tx.acked & (1u << i)) == 0)
+		{
+			arq_tx.burst[arq_tx.burst_count++] = arq_tx.base + i;
+			g_fsk_arq_tx_stats.retransmits++;
+		}
+	}
+
+	while (arq_tx.next < arq_tx.frames && arq_tx.next < (arq_tx.base + arq_tx.window))
+	{
+		arq_tx.burst[arq_tx.burst_count++] = arq_tx.next++;
+		g_fsk_arq_tx_stats.frames++;
+	}
+
+	arq_tx.state = ARQ_TX_SEND;
+}
+
+static void FSK_ARQ_rx_ack(const fsk_link_header_t *hdr)
+{
+	const uint16_t step = (uint8_t)(hdr->index - (uint8_t)arq_tx.base);
+
+	if (arq_tx.state != ARQ_TX_WAIT || hdr->src != arq_tx.dst || hdr->seq != arq_tx.session)
+		return;
+
+	if (step > (arq_tx.next - arq_tx.base))
+		return;   // acknowledges frames we haven't sent, not ours
+
+	g_fsk_arq_tx_stats.acks++;
+
+	if (arq_tx.rtt_sample)
+	{	// Jacobson/Karels, srtt += err / 8, rttvar += (|err| - rttvar) / 4
+		const int rtt = arq_tx.timer_10ms;
+		int       err;
+		int       rto;
+
+		if (arq_tx.srtt_x8 == 0)
+		{
+			arq_tx.srtt_x8   = rtt << 3;
+			arq_tx.rttvar_x4 = rtt << 1;
+		}
+		else
+		{
+			err = rtt - (arq_tx.srtt_x8 >> 3);
+			arq_tx.srtt_x8 += err;
+			if (err < 0)
+				err = -err;
+			arq_tx.rttvar_x4 += err - (arq_tx.rttvar_x4 >> 2);
+		}
+
+		rto = (arq_tx.srtt_x8 >> 3) + arq_tx.rttvar_x4;
+		if (rto < FSK_ARQ_MIN_RTO_10ms)
+			rto = FSK_ARQ_MIN_RTO_10ms;
+		if (rto > FSK_ARQ_MAX_RTO_10ms)
+			rto = FSK_ARQ_MAX_RTO_10ms;
+
+		g_fsk_arq_tx_stats.srtt_10ms = arq_tx.srtt_x8 >> 3;
+		g_fsk_arq_tx_stats.rto_10ms  = rto;
+	}
+
+	arq_tx.base      += step;
+	arq_tx.acked      = ~hdr->len;   // the missing bitmap
+	arq_tx.retries    = 0;
+	arq_tx.rtt_sample = true;
+
+	if (arq_tx.base >= arq_tx.frames)
+	{
+		FSK_ARQ_tx_end(true);
+		return;
+	}
+
+	FSK_ARQ_next_burst();
+}
+
+int FSK_ARQ_send(const uint8_t dst, const void *data, const uint16_t len, const unsigned int window, fsk_link_tx_done_t done)
+{
+	if (arq_tx.state != ARQ_TX_IDLE || !FSK_LINK_is_open() || len == 0 || dst == FSK_LINK_BROADCAST)
+		return -1;
+
+	memset(&g_fsk_arq_tx_stats, 0, sizeof(g_fsk_arq_tx_stats));
+	g_fsk_arq_tx_stats.bytes    = len;
+	g_fsk_arq_tx_stats.rto_10ms = FSK_ARQ_INITIAL_RTO_10ms;
+
+	arq_tx.data       = (const uint8_t *)data;
+	arq_tx.len        = len;
+	arq_tx.frames     = (len + FSK_LINK_PAYLOAD_BYTES - 1) / FSK_LINK_PAYLOAD_BYTES;
+	arq_tx.base       = 0;
+	arq_tx.next       = 0;
+	arq_tx.acked      = 0;
+	arq_tx.window     = (window < 1) ? 1 : (window > FSK_ARQ_MAX_WINDOW) ? FSK_ARQ_MAX_WINDOW : window;
+	arq_tx.dst        = dst;
+	arq_tx.session++;
+	arq_tx.retries    = 0;
+	arq_tx.srtt_x8    = 0;
+	arq_tx.rttvar_x4  = 0;
+	arq_tx.rtt_sample = true;
+	arq_tx.done       = done;
+
+	FSK_ARQ_next_burst();
+
+	return 0;
+}
+
+bool FSK_ARQ_busy(void)
+{
+	return (arq_tx.state != ARQ_TX_IDLE) ? true : false;
+}
+
+// ****************************
+// receiver
+
+static void FSK_ARQ_rx_data(const fsk_link_header_t *hdr, const uint8_t *payload)
+{
+	uint16_t num;
+
+	if (arq_rx.rx == NULL || hdr->dst == FSK_LINK_BROADCAST || hdr->len == 0)
+		return;
+
+	if (!arq_rx.active || hdr->src != arq_rx.src || hdr->seq != arq_rx.session)
+	{	// a new transfer
+		memset(&g_fsk_arq_rx_stats, 0, sizeof(g_fsk_arq_rx_stats));
+
+		arq_rx.active      = true;
+		arq_rx.ack_pending = false;
+		arq_rx.src         = hdr->src;
+		arq_rx.session     = hdr->seq;
+		arq_rx.len         = hdr->len;
+		arq_rx.frames      = (hdr->len + FSK_LINK_PAYLOAD_BYTES - 1) / FSK_LINK_PAYLOAD_BYTES;
+		arq_rx.next        = 0;
+		arq_rx.have        = 0;
+	}
+
+	if (hdr->count & FSK_ARQ_FLAG_POLL)
+		arq_rx.ack_pending = true;
+
+	// the full frame number, it's within a window of the one we're waiting for
+	num = arq_rx.next + (int8_t)(hdr->index - (uint8_t)arq_rx.next);
+
+	if (num < arq_rx.next || (arq_rx.have & (1u << (num - arq_rx.next))))
+	{
+		g_fsk_arq_rx_stats.duplicates++;
+		return;
+	}
+
+	if (num >= (arq_rx.next + FSK_ARQ_MAX_WINDOW) || num >= arq_rx.frames)
+	{
+		g_fsk_arq_rx_stats.out_of_window++;
+		return;
+	}
+
+	memcpy(arq_rx.buf[num % FSK_ARQ_MAX_WINDOW], payload, FSK_LINK_PAYLOAD_BYTES);
+	arq_rx.have |= 1u << (num - arq_rx.next);
+	g_fsk_arq_rx_stats.frames++;
+
+	while (arq_rx.have & 1u)
+	{	// hand up whatever is now in order
+		const uint16_t n = FSK_ARQ_frame_bytes(arq_rx.next, arq_rx.len);
+
+		arq_rx.rx(arq_rx.src, arq_rx.next * FSK_LINK_PAYLOAD_BYTES, arq_rx.buf[arq_rx.next % FSK_ARQ_MAX_WINDOW], n, arq_rx.len);
+		g_fsk_arq_rx_stats.bytes += n;
+
+		arq_rx.next++;
+		arq_rx.have >>= 1;
+	}
+}
+
+static uint16_t FSK_ARQ_build_ack(const unsigned int index, uint8_t *frame)
+{
+	fsk_link_header_t *hdr     = (fsk_link_header_t *)frame;
+	uint16_t           missing = 0;
+	unsigned int       i;
+
+	(void)index;
+
+	for (i = 0; i < FSK_ARQ_MAX_WINDOW && (arq_rx.next + i) < arq_rx.frames; i++)
+		if ((arq_rx.have & (1u << i)) == 0)
+			missing |= 1u << i;
+
+	hdr->type  = FSK_LINK_TYPE_ARQ_ACK;
+	hdr->src   = FSK_LINK_address();
+	hdr->dst   = arq_rx.src;
+	hdr->seq   = arq_rx.session;
+	hdr->index = (uint8_t)arq_rx.next;
+	hdr->count = 0;
+	hdr->len   = missing;
+
+	return FSK_ARQ_ACK_BYTES;
+}
+
+void FSK_ARQ_set_rx(fsk_arq_rx_t rx)
+{
+	arq_rx.rx     = rx;
+	arq_rx.active = false;
+}
+
+// ****************************
+
+void FSK_ARQ_rx_frame(const fsk_link_header_t *hdr, const uint8_t *payload, const uint16_t payload_bytes)
+{
+	if (hdr->type == FSK_LINK_TYPE_ARQ_ACK)
+		FSK_ARQ_rx_ack(hdr);
+	else
+	if (payload_bytes == FSK_LINK_PAYLOAD_BYTES)
+		FSK_ARQ_rx_data(hdr, payload);
+}
+
+void FSK_ARQ_process_10ms(void)
+{
+	if (arq_rx.active && arq_rx.next < arq_rx.frames)
+		g_fsk_arq_rx_stats.ticks_10ms++;
+
+	if (arq_rx.ack_pending && !FSK_LINK_tx_busy())
+	{	// the sender is waiting, answer straight away
+		if (FSK_LINK_send_burst(FSK_ARQ_build_ack, 1, FSK_LINK_FRAME_BYTES, NULL) == 0)
+		{
+			arq_rx.ack_pending = false;
+			g_fsk_arq_rx_stats.acks++;
+		}
+	}
+
+	if (arq_tx.state == ARQ_TX_IDLE)
+		return;
+
+	g_fsk_arq_tx_stats.ticks_10ms++;
+
+	if (!FSK_LINK_is_open())
+	{
+		FSK_ARQ_tx_end(false);
+		return;
+	}
+
+	if (arq_tx.state == ARQ_TX_WAIT && ++arq_tx.timer_10ms >= g_fsk_arq_tx_stats.rto_10ms)
+	{	// no ACK, poll again with the oldest frame it hasn't got and back off
+		g_fsk_arq_tx_stats.timeouts++;
+		FSK_LINK_rate_failed(arq_tx.dst);   // it may not be listening at the rate we're using
+
+		if (++arq_tx.retries > FSK_ARQ_MAX_RETRIES)
+		{
+			FSK_ARQ_tx_end(false);
+			return;
+		}
+
+		g_fsk_arq_tx_stats.rto_10ms = (g_fsk_arq_tx_stats.rto_10ms >= (FSK_ARQ_MAX_RTO_10ms / 2)) ? FSK_ARQ_MAX_RTO_10ms : g_fsk_arq_tx_stats.rto_10ms * 2;
+		g_fsk_arq_tx_stats.retransmits++;
+
+		arq_tx.burst[0]    = arq_tx.base;
+		arq_tx.burst_count = 1;
+		arq_tx.rtt_sample  = false;
+		arq_tx.state       = ARQ_TX_SEND;
+	}
+
+	if (arq_tx.state == ARQ_TX_SEND && !FSK_LINK_tx_busy())
+	{
+		arq_tx.state = ARQ_TX_BURST;
+		if (FSK_LINK_send_burst(FSK_ARQ_build_data, arq_tx.burst_count, FSK_ARQ_ACK_BYTES, FSK_ARQ_burst_done) == 0)
+			g_fsk_arq_tx_stats.bursts++;
+		else
+			arq_tx.state = ARQ_TX_SEND;
+	}
+}
@@ -0,0 +1,94 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#ifndef FSK_ARQ_H
+#define FSK_ARQ_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "fsk_link.h"
+
+// selective repeat ARQ for bulk transfers over the FSK link
+//
+// the sender puts up to 'window' frames on the air in one burst, the last one asks for an ACK (poll),
+// then it listens for the short ACK .. the next frame the receiver is waiting for plus a bitmap of the
+// ones after it that are still missing. Missing frames go again at the front of the next burst along
+// with new ones. If no ACK comes back in time the oldest unacknowledged frame goes again as a poll, the
+// retransmit time follows the measured round trip (SRTT + 4 x RTTVAR) and doubles on each timeout.
+//
+//   data  [ARQ_DATA][source][destination][session][frame number][flags][transfer length LE][payload]
+//   ack   [ARQ_ACK ][source][destination][session][next wanted ][0    ][missing bitmap LE]
+//
+// the receiver hands the data up in order as it goes, so a transfer can be far bigger than RAM, only
+// the window is held. A window of 1 is the old stop-and-wait.
+
+#ifndef FSK_ARQ_MAX_WINDOW
+	#define FSK_ARQ_MAX_WINDOW        8         // frames the receiver holds out of order, FSK_LINK_PAYLOAD_BYTES each
+#endif
+#define FSK_ARQ_ACK_BYTES             FSK_LINK_HEADER_BYTES
+#define FSK_ARQ_MAX_RETRIES           8         // timeouts in a row before the transfer is given up
+#define FSK_ARQ_INITIAL_RTO_10ms      (1000 / 10)
+#define FSK_ARQ_MIN_RTO_10ms          (200 / 10)
+#define FSK_ARQ_MAX_RTO_10ms          (5000 / 10)
+
+#define FSK_ARQ_FLAG_POLL             (1u << 0)
+
+#if FSK_ARQ_MAX_WINDOW < 1 || FSK_ARQ_MAX_WINDOW > 16
+	#error "FSK_ARQ_MAX_WINDOW must be 1 ~ 16, the missing bitmap is 16 bits"
+#endif
+
+typedef struct {                    // the last transfer we sent, cleared when the next one starts
+	uint16_t bytes;
+	uint16_t frames;                // new frames sent
+	uint16_t retransmits;
+	uint16_t bursts;
+	uint16_t acks;
+	uint16_t timeouts;
+	uint16_t srtt_10ms;             // smoothed round trip, end of the poll frame to the ACK
+	uint16_t rto_10ms;              // retransmit time now
+	uint32_t ticks_10ms;            // start to finish
+} fsk_arq_tx_stats_t;
+
+typedef struct {                    // the last transfer we received
+	uint16_t bytes;                 // handed up so far
+	uint16_t frames;                // new frames
+	uint16_t duplicates;
+	uint16_t out_of_window;
+	uint16_t acks;
+	uint32_t ticks_10ms;            // first frame to the last one handed up
+} fsk_arq_rx_stats_t;
+
+extern fsk_arq_tx_stats_t g_fsk_arq_tx_stats;
+extern fsk_arq_rx_stats_t g_fsk_arq_rx_stats;
+
+// 'len' bytes of the transfer at 'offset', always in order .. 'data' is only valid during the call
+typedef void (*fsk_arq_rx_t)(const uint8_t src, const uint16_t offset, const uint8_t *data, const uint16_t len, const uint16_t total);
+
+// starts a transfer and returns straight away (0 = started, -1 = busy, closed or bad length),
+// the data must stay put until the done callback
+int  FSK_ARQ_send(const uint8_t dst, const void *data, const uint16_t len, const unsigned int window, fsk_link_tx_done_t done);
+bool FSK_ARQ_busy(void);
+
+// transfers sent to us are only accepted once there's somewhere for them to go
+void FSK_ARQ_set_rx(fsk_arq_rx_t rx);
+
+// from fsk_link.c
+void FSK_ARQ_rx_frame(const fsk_link_header_t *hdr, const uint8_t *payload, const uint16_t payload_bytes);
+void FSK_ARQ_process_10ms(void);
+
+#endif
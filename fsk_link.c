@@ -0,0 +1,811 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#include <string.h>
+
+#include "driver/bk4819.h"
+#include "driver/system.h"
+#include "fsk_arq.h"
+#include "fsk_link.h"
+#include "functions.h"
+#include "misc.h"
+#include "radio.h"
+
+typedef struct {
+	uint8_t  src;
+	uint8_t  seq;
+	uint8_t  count;
+	bool     used;
+	uint16_t len;
+	uint16_t offset;                // where the message goes in the pool
+	uint16_t timeout_10ms;
+	uint32_t have;                  // fragments received, one bit each
+} fsk_link_slot_t;
+
+typedef struct {
+	uint8_t  address;
+	uint8_t  rate;                  // what it last asked to be sent at
+	uint8_t  fails;                 // polls in a row it didn't answer
+	bool     used;
+	uint16_t age_10ms;              // since we last heard it
+} fsk_link_peer_t;
+
+fsk_link_stats_t g_fsk_link_stats;
+
+// the RSSI/noise steps are starting points, not yet tuned on the air
+const fsk_link_rate_t g_fsk_link_rates[FSK_LINK_RATES] = {
+	{FSK_MODULATION_TYPE_FSK1K2,       127, 1200, FSK_LINK_DBM(-160), 127},   // the fall back, full deviation
+	{FSK_MODULATION_TYPE_MSK1200_1800, 120, 1200, FSK_LINK_DBM(-118),  80},
+	{FSK_MODULATION_TYPE_MSK1200_2400, 120, 2400, FSK_LINK_DBM(-110),  64},
+	{FSK_MODULATION_TYPE_FSK2K4,       120, 2400, FSK_LINK_DBM(-104),  56}
+};
+
+static struct {
+	bool                  open;
+	uint8_t               address;
+	FSK_MODULATION_TYPE_t modulation;
+	uint8_t               tone2_gain;
+	fsk_link_rx_t         rx;
+	uint16_t              rx_bytes;         // packet length the receiver is set for, less any FEC parity
+	#ifdef ENABLE_FSK_FEC
+		uint8_t           fec_parity;       // 0 = off
+		uint8_t           fec_depth;
+	#endif
+} link;
+
+static struct {
+	fsk_link_build_t      build;
+	uint8_t               index;
+	uint8_t               count;
+	uint16_t              listen_bytes;     // receiver packet length once the burst is out
+	bool                  busy;
+	fsk_link_tx_done_t    done;
+} tx;
+
+static struct {                             // adaptive rate, our receiving side
+	bool                  on;
+	uint8_t               rate;             // what we listen at
+	uint8_t               next;             // what we ask for, listened at once a packet asking for it has gone out
+	uint8_t               up_frames;        // clean frames needed before the next step up
+	bool                  probing;          // the last change was a step up that hasn't proved itself yet
+	bool                  changed;          // nothing heard since the last change
+	uint16_t              quiet_10ms;       // since the last good frame
+	uint16_t              syncs;            // g_fsk_rx_stats.sync_found when the window started
+	uint16_t              last_sync;
+	uint8_t               good;             // frames this window
+	uint8_t               bad;
+	uint8_t               unicast;          // .. of the good ones, those sent to us rather than broadcast
+	uint16_t              samples;          // RSSI/noise taken while a packet was coming in
+	uint32_t              rssi_sum;
+	uint32_t              noise_sum;
+} adapt;
+
+static fsk_link_peer_t    peers[FSK_LINK_PEERS];
+
+static struct {                             // the message FSK_LINK_send() is sending
+	const uint8_t        *data;
+	uint16_t              len;
+	uint8_t               dst;
+	uint8_t               seq;
+} msg;
+
+// word arrays, the packet engine moves 16 bits at a time
+static uint16_t        tx_frame[FSK_LINK_MAX_AIR_BYTES / 2];
+static uint16_t        rx_frame[FSK_LINK_MAX_AIR_BYTES / 2];
+
+static fsk_link_slot_t rx_slots[FSK_LINK_RX_SLOTS];
+static uint8_t         rx_pool[FSK_LINK_POOL_BYTES];
+
+// ****************************
+
+static uint16_t FSK_LINK_parity_bytes(void)
+{
+	#ifdef ENABLE_FSK_FEC
+		return link.fec_parity * link.fec_depth;
+	#else
+		return 0;
+	#endif
+}
+
+static void FSK_LINK_modem(const FSK_TX_RX_t txRx, const unsigned int rate)
+{	// 16 byte preamble, it gives the far end's receiver time to settle after its own TX .. no chip CRC with FEC,
+	// the decoder says whether the packet is good
+	const FSK_MODULATION_TYPE_t modulation = adapt.on ? g_fsk_link_rates[rate].modulation : link.modulation;
+	const uint8_t               tone2_gain = adapt.on ? g_fsk_link_rates[rate].tone2_gain : link.tone2_gain;
+
+	BK4819_FskEnterMode(txRx, modulation, tone2_gain, FSK_NO_SYNC_BYTES_4, 15, false, FSK_LINK_parity_bytes() == 0, false);
+}
+
+void FSK_LINK_listen(const uint16_t bytes)
+{
+	link.rx_bytes = bytes;
+	BK4819_FskStopReceive();
+	FSK_LINK_modem(FSK_RX, adapt.rate);
+	BK4819_FskStartReceive(bytes + FSK_LINK_parity_bytes());
+}
+
+static uint8_t FSK_LINK_fragments(const uint16_t len)
+{
+	return (len == 0) ? 1 : (len + FSK_LINK_PAYLOAD_BYTES - 1) / FSK_LINK_PAYLOAD_BYTES;
+}
+
+// ****************************
+// adaptive rate
+
+static fsk_link_peer_t *FSK_LINK_peer(const uint8_t address)
+{
+	unsigned int i;
+
+	for (i = 0; i < FSK_LINK_PEERS; i++)
+		if (peers[i].used && peers[i].address == address)
+			return &peers[i];
+
+	return NULL;
+}
+
+static void FSK_LINK_peer_heard(const uint8_t address, const uint8_t rate)
+{	// keep the rate it asks for, a new station takes the place of the one longest unheard
+	fsk_link_peer_t *p = FSK_LINK_peer(address);
+	unsigned int     i;
+
+	if (p == NULL)
+	{
+		p = &peers[0];
+		for (i = 0; i < FSK_LINK_PEERS; i++)
+		{
+			if (!peers[i].used)
+			{
+				p = &peers[i];
+				break;
+			}
+			if (peers[i].age_10ms > p->age_10ms)
+				p = &peers[i];
+		}
+		p->address = address;
+		p->used    = true;
+	}
+
+	p->rate     = (rate < FSK_LINK_RATES) ? rate : 0;
+	p->fails    = 0;
+	p->age_10ms = 0;
+}
+
+static uint8_t FSK_LINK_tx_rate(const uint8_t dst)
+{	// what to send 'dst' at, the slowest if we don't know or haven't heard it for a while
+	const fsk_link_peer_t *p = (dst == FSK_LINK_BROADCAST) ? NULL : FSK_LINK_peer(dst);
+
+	return (p == NULL || p->age_10ms >= FSK_LINK_RATE_IDLE_10ms) ? 0 : p->rate;
+}
+
+void FSK_LINK_rate_failed(const uint8_t dst)
+{
+	fsk_link_peer_t *p = FSK_LINK_peer(dst);
+
+	if (p != NULL && ++p->fails >= FSK_LINK_RATE_TX_FAILS)
+		p->rate = 0;
+}
+
+static void FSK_LINK_rate_window(void)
+{
+	adapt.syncs     = g_fsk_rx_stats.sync_found;
+	adapt.good      = 0;
+	adapt.bad       = 0;
+	adapt.unicast   = 0;
+	adapt.samples   = 0;
+	adapt.rssi_sum  = 0;
+	adapt.noise_sum = 0;
+}
+
+static void FSK_LINK_rate_reset(void)
+{	// back to where both ends start
+	if (adapt.rate != 0 || adapt.next != 0)
+		g_fsk_link_stats.rate_resets++;
+
+	adapt.rate    = 0;
+	adapt.next    = 0;
+	adapt.probing = false;
+	adapt.changed = false;
+	FSK_LINK_rate_window();
+
+	if (link.open && !tx.busy)
+		FSK_LINK_listen(link.rx_bytes);
+}
+
+static void FSK_LINK_rate_check(void)
+{	// after each packet .. step down on losses or a signal too weak for the rate, up after a clean run with signal to spare
+	const uint16_t     syncs  = g_fsk_rx_stats.sync_found - adapt.syncs;
+	const unsigned int frames = adapt.good + adapt.bad;
+	unsigned int       lost   = adapt.bad;
+	unsigned int       rssi   = 0;
+	unsigned int       noise  = 0;
+
+	if (syncs > (frames + 1))
+		lost += syncs - frames - 1;   // syncs that never made a packet, less one that may still be coming in
+
+	if (adapt.samples > 0)
+	{
+		rssi  = adapt.rssi_sum  / adapt.samples;
+		noise = adapt.noise_sum / adapt.samples;
+	}
+
+	if (adapt.rate > 0 &&
+	   ((lost >= 2 && (lost * 4) >= (adapt.good + lost)) ||
+	    (adapt.samples >= 4 && (rssi + FSK_LINK_RATE_RSSI_MARGIN) < g_fsk_link_rates[adapt.rate].min_rssi)))
+	{
+		if (adapt.probing && adapt.up_frames < FSK_LINK_RATE_MAX_UP_FRAMES)
+			adapt.up_frames *= 2;     // that step up didn't work, wait longer before the next try
+		adapt.probing = false;
+		adapt.next    = adapt.rate - 1;
+		g_fsk_link_stats.rate_downs++;
+		FSK_LINK_rate_window();
+	}
+	else
+	if ((adapt.rate + 1) < FSK_LINK_RATES &&
+	    adapt.unicast >= adapt.up_frames && lost == 0 &&
+	    rssi  >= g_fsk_link_rates[adapt.rate + 1].min_rssi &&
+	    noise <= g_fsk_link_rates[adapt.rate + 1].max_noise)
+	{
+		if (adapt.probing)
+			adapt.up_frames = FSK_LINK_RATE_UP_FRAMES;   // the last one held
+		adapt.probing = true;
+		adapt.next    = adapt.rate + 1;
+		g_fsk_link_stats.rate_ups++;
+		FSK_LINK_rate_window();
+	}
+	else
+	if ((adapt.good + lost) >= FSK_LINK_RATE_WINDOW)
+	{
+		if (adapt.probing && (lost * 8) < (adapt.good + lost))
+		{
+			adapt.probing   = false;
+			adapt.up_frames = FSK_LINK_RATE_UP_FRAMES;
+		}
+		FSK_LINK_rate_window();
+	}
+}
+
+static void FSK_LINK_rate_frame(const bool ok, const bool unicast)
+{
+	if (!adapt.on)
+		return;
+
+	if (ok)
+	{
+		adapt.good++;
+		if (unicast)
+			adapt.unicast++;
+		adapt.quiet_10ms = 0;
+		adapt.changed    = false;
+	}
+	else
+		adapt.bad++;
+
+	FSK_LINK_rate_check();
+}
+
+static void FSK_LINK_rate_10ms(void)
+{
+	unsigned int i;
+
+	if (!adapt.on)
+		return;
+
+	for (i = 0; i < FSK_LINK_PEERS; i++)
+		if (peers[i].used && peers[i].age_10ms < 0xFFFF)
+			peers[i].age_10ms++;
+
+	if (adapt.last_sync != g_fsk_rx_stats.sync_found)
+	{	// a packet is coming in, see how strong
+		adapt.last_sync  = g_fsk_rx_stats.sync_found;
+		adapt.rssi_sum  += BK4819_GetRSSI();
+		adapt.noise_sum += BK4819_GetExNoiceIndicator();
+		adapt.samples++;
+	}
+
+	if (adapt.quiet_10ms < 0xFFFF)
+		adapt.quiet_10ms++;
+
+	if ((adapt.changed && adapt.quiet_10ms >= FSK_LINK_RATE_CONFIRM_10ms) ||
+	    (adapt.rate > 0 && adapt.quiet_10ms >= FSK_LINK_RATE_IDLE_10ms))
+	{
+		if (adapt.probing && adapt.up_frames < FSK_LINK_RATE_MAX_UP_FRAMES)
+			adapt.up_frames *= 2;     // nobody followed us up, wait longer before trying again
+		FSK_LINK_rate_reset();
+	}
+}
+
+void FSK_LINK_set_adaptive(const bool on)
+{
+	memset(peers, 0, sizeof(peers));
+
+	adapt.on        = on;
+	adapt.up_frames = FSK_LINK_RATE_UP_FRAMES;
+	adapt.last_sync = g_fsk_rx_stats.sync_found;
+	FSK_LINK_rate_reset();
+}
+
+uint8_t FSK_LINK_rate(void)
+{
+	return adapt.rate;
+}
+
+// ****************************
+// TX
+
+static void FSK_LINK_tx_done(const bool ok);
+
+static uint16_t FSK_LINK_next_frame(void)
+{	// build the next frame of the burst, put our receive rate in it and add the parity
+	uint8_t       *frame = (uint8_t *)tx_frame;
+	const uint16_t bytes = tx.build(tx.index, frame);
+
+	frame[0] = (frame[0] & FSK_LINK_TYPE_MASK) | (adapt.on ? (adapt.next + 1) << FSK_LINK_RATE_SHIFT : 0);
+
+	#ifdef ENABLE_FSK_FEC
+		if (link.fec_parity > 0)
+			FEC_encode(frame, bytes, link.fec_parity, link.fec_depth);
+	#endif
+
+	return bytes + FSK_LINK_parity_bytes();
+}
+
+static int FSK_LINK_tx_frame(const uint16_t bytes)
+{
+	return BK4819_FskTransmitPacket(tx_frame, bytes, FSK_LINK_tx_done);
+}
+
+static void FSK_LINK_tx_end(const bool ok)
+{
+	const fsk_link_tx_done_t done = tx.done;
+
+	tx.busy = false;
+	tx.done = NULL;
+
+	if (adapt.next != adapt.rate)
+	{	// the far end has been told, listen at the new rate from now on
+		adapt.rate       = adapt.next;
+		adapt.changed    = true;
+		adapt.quiet_10ms = 0;
+		FSK_LINK_rate_window();
+	}
+
+	// back to receive
+	RADIO_disableTX(false);
+	RADIO_setup_registers(false);
+	if (link.open)
+		FSK_LINK_listen(tx.listen_bytes);
+	else
+		BK4819_FskExitMode();
+
+	if (done != NULL)
+		done(ok);
+}
+
+static void FSK_LINK_tx_done(const bool ok)
+{	// called from the FSK TX engine each time a frame has gone out, the TX stays keyed up for the whole burst
+	if (ok)
+	{
+		g_fsk_link_stats.tx_frames++;
+
+		if (++tx.index >= tx.count)
+		{
+			FSK_LINK_tx_end(true);
+			return;
+		}
+
+		if (FSK_LINK_tx_frame(FSK_LINK_next_frame()) == 0)
+			return;
+	}
+
+	FSK_LINK_tx_end(false);
+}
+
+int FSK_LINK_send_burst(fsk_link_build_t build, const unsigned int count, const uint16_t listen_bytes, fsk_link_tx_done_t done)
+{	// every frame of a burst goes to the same station, the first one says which and so the rate
+	uint16_t bytes;
+
+	if (!link.open || tx.busy || count == 0 || BK4819_FskTxBusy())
+		return -1;
+
+	tx.build        = build;
+	tx.index        = 0;
+	tx.count        = count;
+	tx.listen_bytes = listen_bytes;
+	tx.done         = done;
+	tx.busy         = true;
+
+	bytes = FSK_LINK_next_frame();
+
+	BK4819_FskStopReceive();
+
+	RADIO_enableTX(true);
+	BK4819_EnableTXLink();
+	BK4819_SetAF(BK4819_AF_MUTE);
+	SYSTEM_DelayMs(10);
+
+	FSK_LINK_modem(FSK_TX, FSK_LINK_tx_rate(((const fsk_link_header_t *)tx_frame)->dst));
+
+	if (FSK_LINK_tx_frame(bytes) < 0)
+	{
+		tx.done = NULL;
+		FSK_LINK_tx_end(false);
+		return -1;
+	}
+
+	return 0;
+}
+
+static uint16_t FSK_LINK_build_fragment(const unsigned int index, uint8_t *frame)
+{
+	fsk_link_header_t *hdr     = (fsk_link_header_t *)frame;
+	uint8_t           *payload = frame + FSK_LINK_HEADER_BYTES;
+	const uint16_t     offset  = index * FSK_LINK_PAYLOAD_BYTES;
+	uint16_t           n       = msg.len - offset;
+
+	if (n > FSK_LINK_PAYLOAD_BYTES)
+		n = FSK_LINK_PAYLOAD_BYTES;
+
+	hdr->type  = FSK_LINK_TYPE_DATA;
+	hdr->src   = link.address;
+	hdr->dst   = msg.dst;
+	hdr->seq   = msg.seq;
+	hdr->index = index;
+	hdr->count = tx.count;
+	hdr->len   = msg.len;
+
+	memcpy(payload, msg.data + offset, n);
+	memset(payload + n, 0, FSK_LINK_PAYLOAD_BYTES - n);   // pad the last one out to the frame size
+
+	return FSK_LINK_FRAME_BYTES;
+}
+
+static fsk_link_tx_done_t msg_done;
+
+static void FSK_LINK_msg_done(const bool ok)
+{
+	const fsk_link_tx_done_t done = msg_done;
+
+	msg_done = NULL;
+
+	if (ok)
+		g_fsk_link_stats.tx_messages++;
+	else
+		g_fsk_link_stats.tx_failed++;
+
+	if (done != NULL)
+		done(ok);
+}
+
+int FSK_LINK_send(const uint8_t dst, const void *data, const uint16_t len, fsk_link_tx_done_t done)
+{
+	if (tx.busy || len > FSK_LINK_MAX_MESSAGE_BYTES)
+		return -1;
+
+	msg.data = (const uint8_t *)data;
+	msg.len  = len;
+	msg.dst  = dst;
+	msg.seq++;
+	msg_done = done;
+
+	if (FSK_LINK_send_burst(FSK_LINK_build_fragment, FSK_LINK_fragments(len), FSK_LINK_FRAME_BYTES, FSK_LINK_msg_done) < 0)
+	{
+		msg_done = NULL;
+		return -1;
+	}
+
+	return 0;
+}
+
+bool FSK_LINK_tx_busy(void)
+{
+	return tx.busy;
+}
+
+uint8_t FSK_LINK_address(void)
+{
+	return link.address;
+}
+
+// ****************************
+// RX
+
+static bool FSK_LINK_pool_alloc(fsk_link_slot_t *p_slot, const uint16_t len)
+{	// first fit .. try the start of the pool then the end of each message already in it
+	unsigned int i;
+
+	for (i = 0; i <= FSK_LINK_RX_SLOTS; i++)
+	{
+		uint16_t     offset = 0;
+		unsigned int k;
+
+		if (i < FSK_LINK_RX_SLOTS)
+		{
+			if (!rx_slots[i].used)
+				continue;
+			offset = rx_slots[i].offset + rx_slots[i].len;
+		}
+
+		if ((offset + len) > FSK_LINK_POOL_BYTES)
+			continue;
+
+		for (k = 0; k < FSK_LINK_RX_SLOTS; k++)
+		{
+			const fsk_link_slot_t *p = &rx_slots[k];
+			if (p->used && offset < (p->offset + p->len) && p->offset < (offset + len))
+				break;   // overlaps
+		}
+
+		if (k >= FSK_LINK_RX_SLOTS)
+		{
+			p_slot->offset = offset;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static fsk_link_slot_t *FSK_LINK_slot(const fsk_link_header_t *hdr)
+{
+	fsk_link_slot_t *p_free = NULL;
+	unsigned int     i;
+
+	for (i = 0; i < FSK_LINK_RX_SLOTS; i++)
+	{
+		fsk_link_slot_t *p = &rx_slots[i];
+
+		if (!p->used)
+		{
+			if (p_free == NULL)
+				p_free = p;
+			continue;
+		}
+
+		if (p->src == hdr->src && p->seq == hdr->seq)
+		{
+			if (p->count == hdr->count && p->len == hdr->len)
+				return p;
+
+			p->used = false;    // the sender has moved on and reused the sequence number
+			if (p_free == NULL)
+				p_free = p;
+		}
+	}
+
+	while (p_free == NULL || !FSK_LINK_pool_alloc(p_free, hdr->len))
+	{	// full, push out the partial message that's gone longest without a fragment
+		fsk_link_slot_t *p_stale = NULL;
+
+		for (i = 0; i < FSK_LINK_RX_SLOTS; i++)
+			if (rx_slots[i].used && (p_stale == NULL || rx_slots[i].timeout_10ms < p_stale->timeout_10ms))
+				p_stale = &rx_slots[i];
+
+		if (p_stale == NULL)
+			return NULL;
+
+		p_stale->used = false;
+		g_fsk_link_stats.rx_evicted++;
+		if (p_free == NULL)
+			p_free = p_stale;
+	}
+
+	p_free->src   = hdr->src;
+	p_free->seq   = hdr->seq;
+	p_free->count = hdr->count;
+	p_free->len   = hdr->len;
+	p_free->have  = 0;
+	p_free->used  = true;
+
+	return p_free;
+}
+
+static void FSK_LINK_rx_message(const fsk_link_header_t *hdr, const uint8_t *payload, const uint16_t bytes)
+{
+	fsk_link_slot_t *p_slot;
+	uint16_t         offset;
+	uint16_t         n;
+
+	if (bytes != FSK_LINK_FRAME_BYTES ||
+	    hdr->count == 0 ||
+	    hdr->count > FSK_LINK_MAX_FRAGMENTS ||
+	    hdr->index >= hdr->count ||
+	    hdr->len > FSK_LINK_MAX_MESSAGE_BYTES ||
+	    FSK_LINK_fragments(hdr->len) != hdr->count)
+	{
+		g_fsk_link_stats.rx_bad_headers++;
+		return;
+	}
+
+	if (hdr->count == 1)
+	{	// the whole message is in this frame, no need to copy it anywhere
+		g_fsk_link_stats.rx_messages++;
+		if (link.rx != NULL)
+			link.rx(hdr->src, hdr->dst, payload, hdr->len);
+		return;
+	}
+
+	p_slot = FSK_LINK_slot(hdr);
+	if (p_slot == NULL)
+		return;   // only if the message is bigger than the pool, and it can't be
+
+	p_slot->timeout_10ms = FSK_LINK_RX_TIMEOUT_10ms;
+
+	if (p_slot->have & (1u << hdr->index))
+	{
+		g_fsk_link_stats.rx_duplicates++;
+		return;
+	}
+
+	offset = hdr->index * FSK_LINK_PAYLOAD_BYTES;
+	n      = hdr->len - offset;
+	if (n > FSK_LINK_PAYLOAD_BYTES)
+		n = FSK_LINK_PAYLOAD_BYTES;
+
+	memcpy(&rx_pool[p_slot->offset + offset], payload, n);
+	p_slot->have |= 1u << hdr->index;
+
+	if (p_slot->have == (0xFFFFFFFFu >> (32 - p_slot->count)))
+	{	// all there
+		p_slot->used = false;
+		g_fsk_link_stats.rx_messages++;
+		if (link.rx != NULL)
+			link.rx(hdr->src, hdr->dst, &rx_pool[p_slot->offset], hdr->len);
+	}
+}
+
+static void FSK_LINK_rx_frame(const uint16_t bytes)
+{
+	const fsk_link_header_t *hdr     = (const fsk_link_header_t *)rx_frame;
+	const uint8_t           *payload = (const uint8_t *)rx_frame + FSK_LINK_HEADER_BYTES;
+	const uint8_t            rate    = ((uint8_t *)rx_frame)[0] >> FSK_LINK_RATE_SHIFT;
+
+	((uint8_t *)rx_frame)[0] &= FSK_LINK_TYPE_MASK;   // the layers above only see the type
+
+	if (adapt.on && rate > 0 && hdr->src != link.address)
+		FSK_LINK_peer_heard(hdr->src, rate - 1);         // whoever it was sent to, that's the rate it listens at
+
+	if (hdr->src == link.address || (hdr->dst != link.address && hdr->dst != FSK_LINK_BROADCAST))
+		return;   // not for us
+
+	switch (hdr->type)
+	{
+		case FSK_LINK_TYPE_DATA:
+			FSK_LINK_rx_message(hdr, payload, bytes);
+			break;
+
+		case FSK_LINK_TYPE_ARQ_DATA:
+		case FSK_LINK_TYPE_ARQ_ACK:
+			FSK_ARQ_rx_frame(hdr, payload, bytes - FSK_LINK_HEADER_BYTES);
+			break;
+
+		default:
+			g_fsk_link_stats.rx_bad_headers++;
+			break;
+	}
+}
+
+void FSK_LINK_process_10ms(void)
+{
+	unsigned int i;
+	bool         crc_ok;
+	int16_t      len;
+
+	if (!link.open)
+		return;
+
+	while ((len = BK4819_FskReadPacket(rx_frame, ARRAY_SIZE(rx_frame), &crc_ok)) >= 0)
+	{
+		const uint16_t bytes = (len * 2) - FSK_LINK_parity_bytes();
+
+		if (!crc_ok || (len * 2) < (FSK_LINK_HEADER_BYTES + FSK_LINK_parity_bytes()))
+		{
+			g_fsk_link_stats.rx_crc_errors++;
+			FSK_LINK_rate_frame(false, false);
+			continue;
+		}
+
+		#ifdef ENABLE_FSK_FEC
+			if (link.fec_parity > 0)
+			{
+				const int fixed = FEC_decode((uint8_t *)rx_frame, bytes, link.fec_parity, link.fec_depth);
+				if (fixed < 0)
+				{
+					g_fsk_link_stats.rx_crc_errors++;
+					FSK_LINK_rate_frame(false, false);
+					continue;
+				}
+				if (fixed > 0)
+				{
+					g_fsk_link_stats.rx_fec_frames++;
+					g_fsk_link_stats.rx_fec_bytes += fixed;
+				}
+			}
+		#endif
+
+		g_fsk_link_stats.rx_frames++;
+		FSK_LINK_rate_frame(true, ((const fsk_link_header_t *)rx_frame)->dst == link.address);
+		FSK_LINK_rx_frame(bytes);
+	}
+
+	for (i = 0; i < FSK_LINK_RX_SLOTS; i++)
+	{
+		fsk_link_slot_t *p = &rx_slots[i];
+		if (p->used && --p->timeout_10ms == 0)
+		{	// the rest of it isn't coming
+			p->used = false;
+			g_fsk_link_stats.rx_timeouts++;
+		}
+	}
+
+	FSK_LINK_rate_10ms();
+
+	if (!tx.busy && !BK4819_FskRxActive() && !BK4819_FskTxBusy() && g_current_function != FUNCTION_TRANSMIT)
+		FSK_LINK_listen(link.rx_bytes);      // something else had the receiver off
+
+	FSK_ARQ_process_10ms();
+}
+
+// ****************************
+
+void FSK_LINK_open(const uint8_t address, const FSK_MODULATION_TYPE_t modulation, const uint8_t tone2_gain, fsk_link_rx_t rx)
+{
+	memset(rx_slots, 0, sizeof(rx_slots));
+
+	link.address    = address;
+	link.modulation = modulation;
+	link.tone2_gain = tone2_gain;
+	link.rx         = rx;
+	link.open       = true;
+
+	if (!tx.busy)
+		FSK_LINK_listen(FSK_LINK_FRAME_BYTES);
+}
+
+void FSK_LINK_close(void)
+{
+	if (!link.open)
+		return;
+
+	link.open = false;
+
+	if (!tx.busy)
+	{	// a message going out finishes on its own and doesn't restart the receiver
+		BK4819_FskStopReceive();
+		BK4819_FskExitMode();
+	}
+}
+
+bool FSK_LINK_is_open(void)
+{
+	return link.open;
+}
+
+#ifdef ENABLE_FSK_FEC
+	int FSK_LINK_set_fec(const uint8_t parity, const uint8_t depth)
+	{	// the packets have to stay a whole number of words
+		if ((parity & 1u) != 0 || parity > FEC_MAX_PARITY || depth == 0 || depth > FEC_MAX_DEPTH)
+			return -1;
+
+		link.fec_parity = parity;
+		link.fec_depth  = depth;
+
+		if (link.open && !tx.busy)
+			FSK_LINK_listen(link.rx_bytes);   // the packet length has changed
+
+		return 0;
+	}
+#endif
@@ -0,0 +1,193 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#ifndef FSK_LINK_H
+#define FSK_LINK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "driver/bk4819.h"
+#ifdef ENABLE_FSK_FEC
+	#include "fec.h"
+#endif
+
+// FSK link layer .. addressed messages of any length (up to the reassembly pool) over the BK4819 packet engine
+//
+// the chip's receiver has to be told the packet length before the packet arrives, so every frame on
+// the air is the same FSK_LINK_FRAME_BYTES .. an 8 byte header then the payload, the last fragment of
+// a message padded out. Bigger frames waste less on preamble/sync/header, smaller ones lose less to a
+// bit error, 128 bytes is 0.5s at 2400bps.
+//
+//   [type][source][destination][sequence][fragment index][fragment count][message length LE]
+//
+// a message is split into as few frames as it takes, the receiver collects them in a fixed RAM pool
+// and hands the message up once it's whole. Partial messages that stop getting fragments are thrown
+// away after FSK_LINK_RX_TIMEOUT_10ms, or sooner if a new message needs their room.
+//
+// the pool is the limit on message size, not the frames .. the default 1kB is what the RAM allows next
+// to everything else, so messages are smaller than the 2kB one hardware packet could carry. The 32
+// fragment bitmap goes up to 3840 bytes with 128 byte frames, build with -DFSK_LINK_POOL_BYTES=3840
+// in the CFLAGS (and a KISS_TNC_TX_QUEUE_BYTES to match for the KISS TNC) where the RAM is there.
+//
+// with FEC on (FSK_LINK_set_fec()) every packet, frames and ACKs alike, has Reed-Solomon parity added
+// on the end, and the chip's CRC is turned off .. a packet the decoder can't put right counts as a CRC
+// error. Both ends have to be set the same.
+//
+// adaptive rate (FSK_LINK_set_adaptive()) .. the chip receives one modulation at a time and has to be
+// set for it before the packet arrives, so each station picks the rate it listens at from how well it
+// hears (frames lost against syncs found, RSSI and noise while a packet comes in) and puts it in the
+// top nibble of the type byte of everything it sends. Senders keep what each peer last asked for and
+// use that rate and its Tone2 gain. A station steps up a rate after a run of clean frames with signal
+// to spare, down after losses or when the signal drops below what the rate needs, and listens at the
+// new rate once a packet asking for it has gone out. If nothing is heard after a change, or a peer
+// stops answering polls, both ends drop back to the slowest rate, which is where they start, and a
+// step up that nobody followed makes the next one wait twice as long.
+//
+// broadcasts always go at the slowest rate, as there's no one rate every station listens at, so a
+// station that has stepped up misses them. Only frames sent to our own address count towards a step
+// up, a station that only ever hears broadcasts stays at the slowest rate. Leave adaptive rate off
+// where most of the traffic is broadcast .. the KISS TNC only turns it on for a SetHardware peer.
+
+#ifndef FSK_LINK_FRAME_BYTES
+	#define FSK_LINK_FRAME_BYTES      128
+#endif
+#ifndef FSK_LINK_POOL_BYTES
+	#define FSK_LINK_POOL_BYTES       1024      // reassembly pool, also the biggest message
+#endif
+#define FSK_LINK_RX_SLOTS             4         // messages being reassembled at the same time
+#define FSK_LINK_RX_TIMEOUT_10ms      (5000 / 10)
+
+#define FSK_LINK_HEADER_BYTES         8
+#define FSK_LINK_PAYLOAD_BYTES        (FSK_LINK_FRAME_BYTES - FSK_LINK_HEADER_BYTES)
+#define FSK_LINK_MAX_FRAGMENTS        32        // one bit each in the reassembly bitmap
+#define FSK_LINK_MAX_MESSAGE_BYTES    FSK_LINK_POOL_BYTES
+
+#define FSK_LINK_BROADCAST            0xFF
+
+#define FSK_LINK_TYPE_MASK            0x0F      // the top nibble of the type byte is the sender's receive rate + 1, 0 = not adaptive
+#define FSK_LINK_RATE_SHIFT           4
+
+#define FSK_LINK_RATES                4
+#define FSK_LINK_PEERS                4         // stations whose receive rate we keep
+#define FSK_LINK_RATE_UP_FRAMES       8         // clean frames before trying the next rate up, doubled each time a try fails
+#define FSK_LINK_RATE_MAX_UP_FRAMES   64
+#define FSK_LINK_RATE_WINDOW          32        // frames the loss count is kept over
+#define FSK_LINK_RATE_RSSI_MARGIN     12        // 6dB below what a rate needs before we leave it for that alone
+#define FSK_LINK_RATE_CONFIRM_10ms    (3000 / 10)     // after a change, back to the slowest rate if nothing is heard
+#define FSK_LINK_RATE_IDLE_10ms       (10000 / 10)    // a rate nobody has used for this long is forgotten
+#define FSK_LINK_RATE_TX_FAILS        2         // unanswered polls before a peer is sent the slowest rate
+
+#define FSK_LINK_DBM(dBm)             (((dBm) + 160) * 2)   // REG_67 RSSI units
+
+#ifdef ENABLE_FSK_FEC
+	#define FSK_LINK_MAX_AIR_BYTES    (FSK_LINK_FRAME_BYTES + (FEC_MAX_PARITY * FEC_MAX_DEPTH))
+#else
+	#define FSK_LINK_MAX_AIR_BYTES    FSK_LINK_FRAME_BYTES
+#endif
+
+#if (FSK_LINK_FRAME_BYTES & 1) != 0 || (FSK_LINK_MAX_AIR_BYTES / 2) > BK4819_MAX_PACKET_LEN_WORDS || (FSK_LINK_MAX_AIR_BYTES / 2) >= (BK4819_FSK_RX_RING_WORDS / 2)
+	#error "FSK_LINK_FRAME_BYTES must be even and fit twice in the BK4819 RX ring"
+#endif
+#if defined(ENABLE_FSK_FEC) && (FSK_LINK_FRAME_BYTES + FEC_MAX_PARITY) > 255
+	#error "FSK_LINK_FRAME_BYTES is too big for a single Reed-Solomon codeword"
+#endif
+#if FSK_LINK_MAX_MESSAGE_BYTES > (FSK_LINK_MAX_FRAGMENTS * FSK_LINK_PAYLOAD_BYTES)
+	#error "FSK_LINK_POOL_BYTES needs more fragments than the reassembly bitmap has"
+#endif
+
+enum fsk_link_type_e {
+	FSK_LINK_TYPE_DATA = 1,         // a fragment of a message
+	FSK_LINK_TYPE_ARQ_DATA,         // fsk_arq.c
+	FSK_LINK_TYPE_ARQ_ACK
+};
+
+typedef struct {
+	uint8_t  type;
+	uint8_t  src;
+	uint8_t  dst;
+	uint8_t  seq;                   // message number, per sender
+	uint8_t  index;                 // fragment index 0 ~ count - 1
+	uint8_t  count;                 // fragments in the message
+	uint16_t len;                   // message length in bytes
+} fsk_link_header_t;
+
+typedef struct {
+	FSK_MODULATION_TYPE_t modulation;
+	uint8_t               tone2_gain;
+	uint16_t              bps;
+	uint16_t              min_rssi;         // REG_67 units, heard before stepping up to this rate
+	uint8_t               max_noise;        // REG_65 ex-noise indicator
+} fsk_link_rate_t;
+
+typedef struct {
+	uint16_t tx_messages;
+	uint16_t tx_frames;
+	uint16_t tx_failed;             // messages the TX engine gave up on
+	uint16_t rx_frames;             // frames with a good CRC
+	uint16_t rx_crc_errors;         // or too many errors for the FEC
+	uint16_t rx_fec_frames;         // frames the FEC had to put right
+	uint16_t rx_fec_bytes;          // bytes it put right
+	uint16_t rx_bad_headers;        // good CRC but the header makes no sense
+	uint16_t rx_messages;           // handed up complete
+	uint16_t rx_duplicates;         // fragments we already had
+	uint16_t rx_timeouts;           // partial messages thrown away
+	uint16_t rx_evicted;            // partial messages pushed out to make room for a new one
+	uint16_t rate_ups;
+	uint16_t rate_downs;
+	uint16_t rate_resets;           // back to the slowest rate, nothing heard
+} fsk_link_stats_t;
+
+// 'data' is only valid during the call
+typedef void (*fsk_link_rx_t)(const uint8_t src, const uint8_t dst, const uint8_t *data, const uint16_t len);
+typedef void (*fsk_link_tx_done_t)(const bool ok);
+
+extern fsk_link_stats_t g_fsk_link_stats;
+extern const fsk_link_rate_t g_fsk_link_rates[FSK_LINK_RATES];   // slowest first
+
+void FSK_LINK_open(const uint8_t address, const FSK_MODULATION_TYPE_t modulation, const uint8_t tone2_gain, fsk_link_rx_t rx);
+void FSK_LINK_close(void);
+bool FSK_LINK_is_open(void);
+
+// starts sending and returns straight away (0 = started, -1 = busy, closed or too long),
+// the data must stay put until the done callback
+int  FSK_LINK_send(const uint8_t dst, const void *data, const uint16_t len, fsk_link_tx_done_t done);
+bool FSK_LINK_tx_busy(void);
+uint8_t FSK_LINK_address(void);
+
+// frame level access for the layers above .. 'build' fills in frame 'index' of the burst and returns its
+// length in bytes, the whole burst goes out on one key up and then the receiver is set for 'listen_bytes'
+// packets, anything but FSK_LINK_FRAME_BYTES only suits a station that knows what's coming back
+typedef uint16_t (*fsk_link_build_t)(const unsigned int index, uint8_t *frame);
+
+int  FSK_LINK_send_burst(fsk_link_build_t build, const unsigned int count, const uint16_t listen_bytes, fsk_link_tx_done_t done);
+void FSK_LINK_listen(const uint16_t bytes);
+
+// off .. the modulation and gain given to FSK_LINK_open() both ways, on .. starts at the slowest rate
+void    FSK_LINK_set_adaptive(const bool on);
+uint8_t FSK_LINK_rate(void);                      // the rate we listen at, g_fsk_link_rates[]
+void    FSK_LINK_rate_failed(const uint8_t dst);  // a poll to 'dst' went unanswered
+
+#ifdef ENABLE_FSK_FEC
+	// 'parity' bytes per codeword (even, 0 = FEC off) and 'depth' codewords interleaved per packet,
+	// -1 if the sizes won't do
+	int  FSK_LINK_set_fec(const uint8_t parity, const uint8_t depth);
+#endif
+
+void FSK_LINK_process_10ms(void);
+
+#endif
@@ -0,0 +1,1814 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef ENABLE_AM_FIX
+	#include "am_fix.h"
+#endif
+#include "app/app.h"
+#include "app/dtmf.h"
+#include "board.h"
+#include "driver/backlight.h"
+#include "driver/bk4819.h"
+#include "driver/eeprom.h"
+#include "driver/st7565.h"
+#include "driver/systick.h"
+#include "font.h"
+#include "frequencies.h"
+#ifdef ENABLE_FSK_LINK
+	#include "fsk_arq.h"
+	#include "fsk_link.h"
+#endif
+#include "functions.h"
+#include "helper/battery.h"
+#include "host/hal.h"
+#ifdef ENABLE_KISS_TNC
+	#include "kiss_tnc.h"
+#endif
+#include "misc.h"
+#include "radio.h"
+#include "settings.h"
+#include "ui/helper.h"
+#include "ui/menu.h"
+#include "ui/ui.h"
+
+// host bench .. runs the application on the simulated hardware with a virtual 10ms clock
+//
+//   make host
+//   ./host/bench                     # all the scenarios, blank (factory fresh) eeprom
+//   ./host/bench -e radio.bin        # .. starting from an eeprom image read from a radio
+//   ./host/bench -s scan -d          # one scenario, show the screen at the end of it
+//   ./host/bench -s fsktx -b         # .. and list every BK4819 register access it made
+//   make host ENABLE_FSK_LINK=1      # adds the link layer scenarios
+//
+// the host times are only good for spotting changes between two builds on the same machine,
+// the bus/eeprom/lcd counts are exact and don't change from run to run
+
+#define BENCH_CHANNELS  100     // memory channels set up for the scan
+#define BENCH_FSK_WORDS 300     // FSK packet size, more than the TX FIFO holds so it has to be topped up
+
+typedef struct {
+	const char  *name;
+	void       (*setup)(void);            // not counted
+	void       (*tick)(const unsigned int i);  // before each 10ms tick
+	void       (*report)(void);           // extra results, after the counts
+	unsigned int ticks;
+} bench_t;
+
+static bool show_screen;
+static bool show_bus_log;
+
+// ****************************
+
+static uint64_t bench_now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000u) + ts.tv_nsec;
+}
+
+static void bench_default_eeprom(void)
+{	// what a factory fresh chip would hold, plus a battery calibration so we don't boot into power save
+	static const uint16_t battery_calibration[6] = {1900, 2000, 2050, 2100, 2150, 2300};
+
+	memset(g_host_eeprom, 0xff, sizeof(g_host_eeprom));
+	memcpy(&g_host_eeprom[0x1F40], battery_calibration, sizeof(battery_calibration));
+}
+
+static bool bench_load_eeprom(const char *filename)
+{
+	FILE  *f = fopen(filename, "rb");
+	size_t size;
+
+	if (f == NULL)
+		return false;
+
+	bench_default_eeprom();
+	size = fread(g_host_eeprom, 1, sizeof(g_host_eeprom), f);
+	fclose(f);
+
+	return (size > 0) ? true : false;
+}
+
+static void bench_main_loop_once(uint64_t *p_max_ns)
+{	// same as the end of Main()
+	const uint64_t start = bench_now_ns();
+	uint64_t       ns;
+
+	APP_process();
+
+	if (g_next_time_slice)
+	{
+		APP_time_slice_10ms();
+		g_next_time_slice = false;
+	}
+
+	if (g_next_time_slice_500ms)
+	{
+		APP_time_slice_500ms();
+		g_next_time_slice_500ms = false;
+	}
+
+	ns = bench_now_ns() - start;
+	if (*p_max_ns < ns)
+		*p_max_ns = ns;
+}
+
+// ****************************
+// scenarios
+
+static void bench_boot(void)
+{	// Main() without the clock/pin set up and the welcome screen wait
+	unsigned int i;
+
+	SYSTICK_Init();
+	ST7565_Init(true);
+
+	memset(&g_eeprom, 0, sizeof(g_eeprom));
+
+	memset(g_dtmf_string, '-', sizeof(g_dtmf_string));
+	g_dtmf_string[sizeof(g_dtmf_string) - 1] = 0;
+
+	FREQUENCY_init();
+
+	BK4819_Init();
+
+	BOARD_ADC_GetBatteryInfo(&g_usb_current_voltage, &g_usb_current);
+
+	BOARD_EEPROM_boot_load();
+
+	RADIO_configure_channel(0, VFO_CONFIGURE_RELOAD);
+	RADIO_configure_channel(1, VFO_CONFIGURE_RELOAD);
+
+	RADIO_select_vfos();
+
+	RADIO_setup_registers(true);
+
+	for (i = 0; i < ARRAY_SIZE(g_battery_voltages); i++)
+		BOARD_ADC_GetBatteryInfo(&g_battery_voltages[i], &g_usb_current);
+
+	BATTERY_GetReadings(false);
+
+	#ifdef ENABLE_AM_FIX
+		AM_fix_init();
+	#endif
+
+	UI_SortMenu(true);
+
+	backlight_turn_on(0);
+
+	g_update_status = true;
+}
+
+static void bench_render_tick(const unsigned int i)
+{	// redraw everything every tick
+	(void)i;
+	g_update_display = true;
+	g_update_status  = true;
+}
+
+static void bench_keys_tick(const unsigned int i)
+{	// into the menu, down through it, back out .. 40ms presses 80ms apart
+	static const key_code_t script[] = {
+		KEY_MENU,
+		KEY_DOWN, KEY_DOWN, KEY_DOWN, KEY_DOWN, KEY_DOWN, KEY_DOWN, KEY_DOWN, KEY_DOWN,
+		KEY_DOWN, KEY_DOWN, KEY_DOWN, KEY_DOWN, KEY_DOWN, KEY_DOWN, KEY_DOWN, KEY_DOWN,
+		KEY_MENU, KEY_UP, KEY_EXIT, KEY_EXIT,
+		KEY_UP, KEY_UP, KEY_DOWN, KEY_DOWN
+	};
+	const unsigned int step = i / 8;
+
+	if (step < ARRAY_SIZE(script) && (i % 8) < 4)
+		HOST_key_press(script[step]);
+	else
+		HOST_key_release();
+}
+
+static void bench_save_tick(const unsigned int i)
+{	// a settings save every 100ms, a channel save every 500ms
+	if ((i % 10) == 0)
+	{
+		g_eeprom.squelch_level = (i / 10) % 10;
+		SETTINGS_save();
+	}
+
+	if ((i % 50) == 25)
+	{
+		vfo_info_t vfo;
+		RADIO_InitInfo(&vfo, (i / 50) % BENCH_CHANNELS, 14500000 + ((i / 50) * 2500));
+		SETTINGS_save_channel(vfo.channel_save, 0, &vfo, 2);
+	}
+}
+
+static void bench_scan_setup(void)
+{	// channel mode on VFO A, scanning forward
+	g_eeprom.screen_channel[0] = 0;
+	g_eeprom.user_channel[0]   = 0;
+	g_eeprom.tx_vfo            = 0;
+	g_eeprom.dual_watch        = DUAL_WATCH_OFF;
+
+	RADIO_configure_channel(0, VFO_CONFIGURE_RELOAD);
+	RADIO_select_vfos();
+	RADIO_setup_registers(true);
+
+	APP_channel_next(true, SCAN_STATE_DIR_FORWARD);
+}
+
+static void bench_add_channels(void)
+{	// memory channels spread over the 2m/70cm bands for the scan to walk through
+	unsigned int chan;
+
+	for (chan = 0; chan < BENCH_CHANNELS; chan++)
+	{
+		const uint32_t frequency = (chan & 1) ? 43000000 + (chan * 12500) : 14400000 + (chan * 12500);
+		vfo_info_t     vfo;
+
+		RADIO_InitInfo(&vfo, chan, frequency);
+		snprintf(vfo.name, sizeof(vfo.name), "CH %u", chan);
+		SETTINGS_save_channel(chan, 0, &vfo, 3);
+	}
+}
+
+// the 3x5 text renderer against the per pixel one it replaced, kept here as the reference
+
+static void bench_glyph_pixels(const char *str, unsigned int x, const unsigned int y, const bool statusbar, const bool fill)
+{
+	int c;
+
+	while ((c = (uint8_t)*str++) != 0)
+	{
+		c -= ' ';
+		if (c >= 0 && c < (int)ARRAY_SIZE(g_font3x5))
+		{
+			unsigned int xx;
+			for (xx = 0; xx < ARRAY_SIZE(g_font3x5[0]); xx++)
+			{
+				uint8_t      pixels = g_font3x5[c][xx];
+				unsigned int yy;
+				for (yy = 0; yy <= 5; yy++, pixels >>= 1)
+				{
+					if ((pixels & 1u) == 0)
+						continue;
+					if (statusbar)
+					{
+						if ((y + yy) < 8)
+						{
+							if (fill)
+								g_status_line[x + xx] |=  (uint8_t)(1u << (y + yy));
+							else
+								g_status_line[x + xx] &= (uint8_t)~(1u << (y + yy));
+						}
+					}
+					else
+					{
+						if (fill)
+							g_frame_buffer[(y + yy) >> 3][x + xx] |=  (uint8_t)(1u << ((y + yy) & 7u));
+						else
+							g_frame_buffer[(y + yy) >> 3][x + xx] &= (uint8_t)~(1u << ((y + yy) & 7u));
+					}
+				}
+			}
+		}
+		x += ARRAY_SIZE(g_font3x5[0]) + 1;
+	}
+}
+
+static void bench_glyph_report(void)
+{	// every pixel row, status line and main screen, drawn then rubbed out
+	static const char *strings[] = {"145.500", "VOX", "DW", "123", "C", "12.3V", "-99dBm"};
+	uint8_t            frame_buffer[sizeof(g_frame_buffer)];
+	uint8_t            status_line[sizeof(g_status_line)];
+	uint8_t            frame_buffer_ref[sizeof(g_frame_buffer)];
+	uint8_t            status_line_ref[sizeof(g_status_line)];
+	uint64_t           ns[2];
+	unsigned int       pass;
+	unsigned int       count = 0;
+	bool               same  = true;
+
+	memcpy(frame_buffer, g_frame_buffer, sizeof(frame_buffer));
+	memcpy(status_line,  g_status_line,  sizeof(status_line));
+
+	for (pass = 0; pass < 2; pass++)
+	{
+		const uint64_t start = bench_now_ns();
+		unsigned int   n;
+
+		memset(g_frame_buffer, 0, sizeof(g_frame_buffer));
+		memset(g_status_line,  0, sizeof(g_status_line));
+		count = 0;
+
+		for (n = 0; n < 1000; n++)
+		{
+			unsigned int y;
+			unsigned int i;
+			for (y = 0; y < 50; y++)
+			{
+				for (i = 0; i < ARRAY_SIZE(strings); i++)
+				{
+					const unsigned int x     = (i * 13) + (y & 7);
+					const bool         fill  = ((n & 1) == 0) ? true : false;
+					const bool         state = (y < 3) ? true : false;
+
+					if (pass == 0)
+						bench_glyph_pixels(strings[i], x, y, state, fill);
+					else
+						UI_PrintStringSmallest(strings[i], x, y, state, fill);
+					count++;
+				}
+			}
+
+			if (n == 0)
+			{	// compare after the first, all drawing, round
+				if (pass == 0)
+				{
+					memcpy(frame_buffer_ref, g_frame_buffer, sizeof(frame_buffer_ref));
+					memcpy(status_line_ref,  g_status_line,  sizeof(status_line_ref));
+				}
+				else
+				if (memcmp(frame_buffer_ref, g_frame_buffer, sizeof(frame_buffer_ref)) != 0 ||
+				    memcmp(status_line_ref,  g_status_line,  sizeof(status_line_ref))  != 0)
+				{
+					same = false;
+				}
+			}
+		}
+
+		ns[pass] = bench_now_ns() - start;
+	}
+
+	memcpy(g_frame_buffer, frame_buffer, sizeof(frame_buffer));
+	memcpy(g_status_line,  status_line,  sizeof(status_line));
+
+	printf("         3x5 text per pixel %.1fns/string, by column %.1fns/string .. %s\n",
+		(double)ns[0] / count, (double)ns[1] / count, same ? "same pixels" : "PIXELS DIFFER");
+}
+
+// the display number formatters against the sprintf() calls they replaced
+
+static unsigned int bench_format_one(const unsigned int kind, const uint32_t v, char *s, const bool by_sprintf)
+{
+	switch (kind)
+	{
+		case 0:   // frequency
+			if (by_sprintf)
+				return sprintf(s, "%03u.%05u", v / 100000, v % 100000);
+			return NUMBER_format_frequency(s, v, false) - s;
+		case 1:   // frequency, trailing zeros trimmed
+			if (by_sprintf)
+			{
+				sprintf(s, "%03u.%05u", v / 100000, v % 100000);
+				NUMBER_trim_trailing_zeros(s);
+				return strlen(s);
+			}
+			return NUMBER_format_frequency(s, v, true) - s;
+		case 2:   // dBm
+			if (by_sprintf)
+				return sprintf(s, "%4d", (int)v - 160);
+			return NUMBER_format_int(s, (int)v - 160, 4) - s;
+		case 3:   // battery voltage
+			if (by_sprintf)
+				return sprintf(s, "%u.%02uV", v / 100, v % 100);
+			return NUMBER_format_voltage(s, v) - s;
+		default:  // channel number
+			if (by_sprintf)
+				return sprintf(s, "%03u", v);
+			return NUMBER_format_uint(s, v, 3, '0') - s;
+	}
+}
+
+static void bench_format_report(void)
+{
+	static const char *names[]      = {"frequency", "trimmed", "dBm", "voltage", "channel"};
+	static const struct {
+		uint32_t first;
+		uint32_t last;
+		uint32_t step;
+	} ranges[] = {
+		{  1800000, 130000000, 1250},   // 18MHz ~ 1.3GHz
+		{  1800000, 130000000, 1250},
+		{        0,       160,    1},   // -160 ~ 0dBm
+		{        0,       999,    1},   // 0.00 ~ 9.99V
+		{        1,       999,    1}
+	};
+	unsigned int kind;
+
+	for (kind = 0; kind < ARRAY_SIZE(ranges); kind++)
+	{
+		uint64_t     ns[2];
+		unsigned int count = 0;
+		unsigned int sum   = 0;
+		bool         same  = true;
+		unsigned int pass;
+		uint32_t     v;
+
+		for (pass = 0; pass < 2; pass++)
+		{
+			const uint64_t start = bench_now_ns();
+
+			count = 0;
+			for (v = ranges[kind].first; v <= ranges[kind].last; v += ranges[kind].step)
+			{
+				char s[16];
+				sum += bench_format_one(kind, v, s, (pass == 0) ? true : false);
+				count++;
+			}
+			ns[pass] = bench_now_ns() - start;
+		}
+
+		for (v = ranges[kind].first; v <= ranges[kind].last && same; v += ranges[kind].step)
+		{
+			char a[16];
+			char b[16];
+			bench_format_one(kind, v, a, true);
+			bench_format_one(kind, v, b, false);
+			if (strcmp(a, b) != 0)
+			{
+				printf("         %s %u .. \"%s\" vs \"%s\"\n", names[kind], v, a, b);
+				same = false;
+			}
+		}
+
+		printf("         %-9s sprintf %5.1fns, formatter %5.1fns .. %u values %s\n",
+			names[kind], (double)ns[0] / count, (double)ns[1] / count, count, same ? "same text" : "TEXT DIFFERS");
+		(void)sum;
+	}
+}
+
+#ifdef ENABLE_FSK_MODEM
+	// FSK .. the far end of the link is BK4819 unit 1, handled here the way the firmware handles unit 0
+
+	static uint16_t bench_fsk_data[BENCH_FSK_WORDS];
+
+	static struct {
+		uint16_t        reg59;
+		uint16_t        len_words;
+		const uint16_t *tx_data;
+		uint16_t        tx_index;
+		bool            tx_busy;
+		uint16_t        rx_buf[BENCH_FSK_WORDS];
+		uint16_t        rx_index;
+		uint32_t        rx_ok;
+		uint32_t        rx_bad;
+		void          (*rx_frame)(const bool ok);   // if set, takes each packet instead of the check below
+	} peer;
+
+	static uint32_t fsk_tx_done_ok;
+	static uint32_t fsk_tx_done_fail;
+	static bool     fsk_tx_running;
+
+	static void bench_peer_length(const uint16_t len_words)
+	{	// packet length (bytes - 1) for both directions
+		const uint16_t size = (len_words * 2u) - 1u;
+
+		HOST_bk4819_write(1, BK4819_REG_5D,
+			((size << BK4819_REG_5D_SHIFT_FSK_DATA_LENGTH_LOW) & BK4819_REG_5D_MASK_FSK_DATA_LENGTH_LOW) |
+			(((size >> 8) << BK4819_REG_5D_SHIFT_FSK_DATA_LENGTH_HIGH) & BK4819_REG_5D_MASK_FSK_DATA_LENGTH_HIGH));
+
+		peer.len_words = len_words;
+	}
+
+	static void bench_peer_tune(const uint16_t len_words)
+	{	// same channel and modem settings as the firmware's chip
+		static const uint8_t regs[] = {
+			BK4819_REG_38, BK4819_REG_39, BK4819_REG_58, BK4819_REG_5A, BK4819_REG_5B, BK4819_REG_5C, BK4819_REG_70, BK4819_REG_72
+		};
+		unsigned int i;
+
+		HOST_bk4819_write(1, BK4819_REG_00, 0x8000);
+		HOST_bk4819_write(1, BK4819_REG_00, 0x0000);
+		for (i = 0; i < ARRAY_SIZE(regs); i++)
+			HOST_bk4819_write(1, regs[i], HOST_bk4819_peek(regs[i]));
+
+		memset(&peer, 0, sizeof(peer));
+		bench_peer_length(len_words);
+		peer.reg59 = HOST_bk4819_peek(BK4819_REG_59) & ~(
+			  BK4819_REG_59_MASK_FSK_CLEAR_TX_FIFO
+			| BK4819_REG_59_MASK_FSK_CLEAR_RX_FIFO
+			| BK4819_REG_59_MASK_FSK_ENABLE_TX
+			| BK4819_REG_59_MASK_FSK_ENABLE_RX);
+	}
+
+	static void bench_peer_listen(void)
+	{
+		HOST_bk4819_write(1, BK4819_REG_3F, BK4819_REG_3F_FSK_RX_SYNC | BK4819_REG_3F_FSK_RX_FINISHED | BK4819_REG_3F_FSK_FIFO_ALMOST_FULL);
+		HOST_bk4819_write(1, BK4819_REG_59, peer.reg59 | BK4819_REG_59_MASK_FSK_CLEAR_RX_FIFO);
+		HOST_bk4819_write(1, BK4819_REG_59, peer.reg59 | BK4819_REG_59_MASK_FSK_ENABLE_RX);
+	}
+
+	static void bench_peer_fill(unsigned int words)
+	{
+		while (words-- > 0 && peer.tx_index < peer.len_words)
+			HOST_bk4819_write(1, BK4819_REG_5F, peer.tx_data[peer.tx_index++]);
+	}
+
+	static void bench_peer_send(const uint16_t *data)
+	{
+		peer.tx_data  = data;
+		peer.tx_index = 0;
+		peer.tx_busy  = true;
+
+		HOST_bk4819_write(1, BK4819_REG_3F, BK4819_REG_3F_FSK_TX_FINISHED | BK4819_REG_3F_FSK_FIFO_ALMOST_EMPTY);
+		HOST_bk4819_write(1, BK4819_REG_59, peer.reg59 | BK4819_REG_59_MASK_FSK_CLEAR_TX_FIFO);
+		HOST_bk4819_write(1, BK4819_REG_59, peer.reg59);
+		bench_peer_fill(BK4819_FSK_TX_FIFO_LEN_WORDS);
+		HOST_bk4819_write(1, BK4819_REG_59, peer.reg59 | BK4819_REG_59_MASK_FSK_ENABLE_TX);
+	}
+
+	static void bench_peer_drain(unsigned int words)
+	{
+		while (words-- > 0 && peer.rx_index < peer.len_words)
+			peer.rx_buf[peer.rx_index++] = HOST_bk4819_read(1, BK4819_REG_5F);
+	}
+
+	static void bench_peer_poll(void)
+	{	// the far end's interrupt handling, once a tick
+		while (HOST_bk4819_read(1, BK4819_REG_0C) & 1u)
+		{
+			uint16_t bits;
+
+			HOST_bk4819_write(1, BK4819_REG_02, 0);
+			bits = HOST_bk4819_read(1, BK4819_REG_02);
+
+			if (bits & BK4819_REG_02_FSK_FIFO_ALMOST_EMPTY)
+				bench_peer_fill(BK4819_FSK_TX_FIFO_LEN_WORDS - 64);   // the default threshold
+
+			if (bits & BK4819_REG_02_FSK_TX_FINISHED)
+			{
+				HOST_bk4819_write(1, BK4819_REG_59, peer.reg59);
+				peer.tx_busy = false;
+			}
+
+			if (bits & BK4819_REG_02_FSK_FIFO_ALMOST_FULL)
+				bench_peer_drain(4);                                  // the default threshold
+
+			if (bits & BK4819_REG_02_FSK_RX_FINISHED)
+			{
+				bench_peer_drain(BK4819_FSK_RX_FIFO_LEN_WORDS);
+				if (peer.rx_frame != NULL)
+					peer.rx_frame(peer.rx_index == peer.len_words && (HOST_bk4819_read(1, BK4819_REG_0B) & (1u << 4)) == 0);
+				else
+				if (peer.rx_index == peer.len_words &&
+					memcmp(peer.rx_buf, bench_fsk_data, peer.len_words * sizeof(uint16_t)) == 0 &&
+					(HOST_bk4819_read(1, BK4819_REG_0B) & (1u << 4)) == 0)
+					peer.rx_ok++;
+				else
+					peer.rx_bad++;
+				peer.rx_index = 0;
+			}
+		}
+	}
+
+	static void bench_fsk_tx_done(const bool ok)
+	{	// back to back packets for as long as the scenario runs
+		if (ok)
+			fsk_tx_done_ok++;
+		else
+			fsk_tx_done_fail++;
+
+		if (fsk_tx_running)
+			BK4819_FskTransmitPacket(bench_fsk_data, sizeof(bench_fsk_data), bench_fsk_tx_done);
+	}
+
+	static void bench_fsk_data_setup(void)
+	{
+		unsigned int i;
+		for (i = 0; i < ARRAY_SIZE(bench_fsk_data); i++)
+			bench_fsk_data[i] = (uint16_t)((i * 0x9E37u) ^ (i >> 3));
+	}
+
+	static void bench_fsk_channel(void)
+	{	// VFO A on a 70cm memory channel the save scenario leaves alone, no dual watch to retune
+		// the chip (and rewrite its interrupt mask) under the FSK engine's feet
+		g_eeprom.screen_channel[0] = 11;    // 430.1375MHz
+		g_eeprom.user_channel[0]   = 11;
+		g_eeprom.tx_vfo            = 0;
+		g_eeprom.dual_watch        = DUAL_WATCH_OFF;
+
+		RADIO_configure_channel(0, VFO_CONFIGURE_RELOAD);
+		RADIO_select_vfos();
+		RADIO_setup_registers(true);
+	}
+
+	static void bench_fsktx_setup(void)
+	{	// the firmware sends 2400bps FSK with CRC, the far end checks every packet
+		bench_fsk_data_setup();
+		bench_fsk_channel();
+
+		BK4819_FskEnterMode(FSK_TX, FSK_MODULATION_TYPE_FSK2K4, 120, FSK_NO_SYNC_BYTES_4, 15, false, true, false);
+
+		bench_peer_tune(BENCH_FSK_WORDS);
+		bench_peer_listen();
+
+		fsk_tx_done_ok   = 0;
+		fsk_tx_done_fail = 0;
+		fsk_tx_running   = true;
+		memset(g_host_bk4819_fsk_stats, 0, sizeof(g_host_bk4819_fsk_stats));
+
+		BK4819_FskTransmitPacket(bench_fsk_data, sizeof(bench_fsk_data), bench_fsk_tx_done);
+	}
+
+	static void bench_fsktx_tick(const unsigned int i)
+	{
+		(void)i;
+		bench_peer_poll();
+	}
+
+	static unsigned int bench_fsk_bus_accesses(void)
+	{	// unit 0 accesses to the FSK/interrupt registers
+		const uint32_t count = (g_host_bk4819_log_count < HOST_BK4819_LOG_SIZE) ? g_host_bk4819_log_count : HOST_BK4819_LOG_SIZE;
+		unsigned int   n     = 0;
+		uint32_t       i;
+
+		for (i = 0; i < count; i++)
+		{
+			const unsigned int reg = g_host_bk4819_log[i].reg & 0x7Fu;
+			if (g_host_bk4819_log[i].unit == 0 && (reg == BK4819_REG_02 || reg == BK4819_REG_0B || reg == BK4819_REG_0C || reg == BK4819_REG_3F || (reg >= BK4819_REG_59 && reg <= BK4819_REG_5F)))
+				n++;
+		}
+
+		return n;
+	}
+
+	static void bench_fsktx_report(void)
+	{
+		const unsigned int packets  = fsk_tx_done_ok + fsk_tx_done_fail;
+		const unsigned int accesses = bench_fsk_bus_accesses();
+
+		fsk_tx_running = false;
+		while (BK4819_FskTxBusy())
+		{	// let the last one go out so the next scenario starts clean
+			HOST_next_tick();
+			APP_time_slice_10ms();
+			bench_peer_poll();
+		}
+		BK4819_FskExitMode();
+
+		printf("         fsk tx %u ok %u failed, %u underruns .. far end %u ok %u bad, %u overruns .. %u FSK bus accesses/packet\n",
+			fsk_tx_done_ok, fsk_tx_done_fail, g_host_bk4819_fsk_stats[0].tx_underruns,
+			peer.rx_ok, peer.rx_bad, g_host_bk4819_fsk_stats[1].rx_overruns,
+			(packets > 0) ? accesses / packets : 0);
+	}
+
+	static void bench_fskrx_setup(void)
+	{	// the firmware's own FSK RX test mode (MSK 1200, 430~440MHz) receiving from the far end
+		bench_fsk_data_setup();
+		bench_fsk_channel();
+
+		g_setting_fsk_modem_txrx = FSK_RX;
+		g_setting_fsk_modem_mode = FSK_MODULATION_TYPE_MSK1200_1800;
+		memset(&g_fsk_rx_stats, 0, sizeof(g_fsk_rx_stats));
+		memset(g_host_bk4819_fsk_stats, 0, sizeof(g_host_bk4819_fsk_stats));
+		memset(&peer, 0, sizeof(peer));
+	}
+
+	static void bench_fskrx_tick(const unsigned int i)
+	{	// the receiver starts on the first 500ms slice, then a packet every so often
+		if (i == 60)
+			bench_peer_tune(250);          // MEMORY_PACKET_LEN_WORDS in app.c
+		else
+		if (i > 60 && !peer.tx_busy && (i % 50) == 0)
+			bench_peer_send(bench_fsk_data);
+
+		if (i > 60)
+			bench_peer_poll();
+	}
+
+	static void bench_fskrx_report(void)
+	{
+		const unsigned int packets = g_fsk_rx_stats.packets;
+
+		g_setting_fsk_modem_txrx = FSK_OFF;
+		BK4819_FskStopReceive();
+		BK4819_FskExitMode();
+
+		printf("         fsk rx %u sent, %u received %u crc errors %u short, %u overruns .. %u FSK bus accesses/packet\n",
+			g_host_bk4819_fsk_stats[1].tx_packets, g_fsk_rx_stats.packets, g_fsk_rx_stats.crc_errors, g_fsk_rx_stats.short_packets,
+			g_host_bk4819_fsk_stats[0].rx_overruns,
+			(packets > 0) ? bench_fsk_bus_accesses() / packets : 0);
+	}
+
+	#ifdef ENABLE_FSK_LINK
+		// link layer .. the firmware (address 1) sends a 9 frame message to the far end (address 2),
+		// then the far end sends a 6 frame one back, after the first fragment of a message it never finishes
+
+		#define BENCH_LINK_TX_BYTES  1000
+		#define BENCH_LINK_RX_BYTES  700
+
+		static uint8_t  bench_link_data[4096];     // the link messages and the ARQ transfer
+		static uint16_t bench_link_frames[8][FSK_LINK_FRAME_BYTES / 2];
+
+		static struct {
+			uint8_t      rx_buf[FSK_LINK_MAX_MESSAGE_BYTES];
+			uint32_t     rx_have;
+			unsigned int rx_ok;
+			unsigned int frames_sent;
+			unsigned int frames;
+			bool         listening;
+		} link_peer;
+
+		static unsigned int link_tick;
+		static unsigned int link_tx_ticks;       // firmware send to far end holding the whole message
+		static unsigned int link_rx_ticks;       // far end's first frame to the firmware's RX callback
+		static unsigned int link_rx_start;
+		static unsigned int link_rx_ok;
+		static unsigned int link_rx_bad;
+		static bool         link_tx_done;
+		static bool         link_tx_ok;
+
+		static void bench_link_rx(const uint8_t src, const uint8_t dst, const uint8_t *data, const uint16_t len)
+		{	// the firmware's link layer handing up a whole message
+			if (src == 2 && dst == 1 && len == BENCH_LINK_RX_BYTES && memcmp(data, bench_link_data, len) == 0)
+				link_rx_ok++;
+			else
+				link_rx_bad++;
+			link_rx_ticks = link_tick - link_rx_start;
+		}
+
+		static void bench_link_tx_done(const bool ok)
+		{
+			link_tx_done = true;
+			link_tx_ok   = ok;
+		}
+
+		static void bench_link_peer_frame(const bool ok)
+		{	// the far end's reassembly, nothing clever
+			const fsk_link_header_t *hdr = (const fsk_link_header_t *)peer.rx_buf;
+			const unsigned int       offset = hdr->index * FSK_LINK_PAYLOAD_BYTES;
+
+			if (!ok || hdr->type != FSK_LINK_TYPE_DATA || hdr->dst != 2 || hdr->len != BENCH_LINK_TX_BYTES || hdr->index >= hdr->count)
+				return;
+
+			memcpy(&link_peer.rx_buf[offset], (const uint8_t *)peer.rx_buf + FSK_LINK_HEADER_BYTES,
+				((offset + FSK_LINK_PAYLOAD_BYTES) <= hdr->len) ? FSK_LINK_PAYLOAD_BYTES : hdr->len - offset);
+			link_peer.rx_have |= 1u << hdr->index;
+
+			if (link_peer.rx_have == (0xFFFFFFFFu >> (32 - hdr->count)))
+			{
+				link_peer.rx_have = 0;
+				if (memcmp(link_peer.rx_buf, bench_link_data, hdr->len) == 0)
+					link_peer.rx_ok++;
+				link_tx_ticks = link_tick;
+			}
+		}
+
+		static void bench_link_peer_build(const uint8_t seq, const uint16_t len, const unsigned int count)
+		{	// the far end's frames, what the firmware's link layer would put on the air
+			unsigned int i;
+
+			for (i = 0; i < count; i++)
+			{
+				fsk_link_header_t *hdr    = (fsk_link_header_t *)bench_link_frames[link_peer.frames];
+				const unsigned int offset = i * FSK_LINK_PAYLOAD_BYTES;
+
+				memset(hdr, 0, FSK_LINK_FRAME_BYTES);
+				hdr->type  = FSK_LINK_TYPE_DATA;
+				hdr->src   = 2;
+				hdr->dst   = 1;
+				hdr->seq   = seq;
+				hdr->index = i;
+				hdr->count = (len + FSK_LINK_PAYLOAD_BYTES - 1) / FSK_LINK_PAYLOAD_BYTES;
+				hdr->len   = len;
+				memcpy((uint8_t *)hdr + FSK_LINK_HEADER_BYTES, &bench_link_data[offset],
+					((offset + FSK_LINK_PAYLOAD_BYTES) <= len) ? FSK_LINK_PAYLOAD_BYTES : len - offset);
+
+				link_peer.frames++;
+			}
+		}
+
+		static void bench_link_data_setup(void)
+		{
+			unsigned int i;
+			for (i = 0; i < ARRAY_SIZE(bench_link_data); i++)
+				bench_link_data[i] = (uint8_t)((i * 7u) ^ (i >> 8));
+		}
+
+		static void bench_link_setup(void)
+		{
+			bench_link_data_setup();
+			bench_fsk_channel();
+
+			FSK_LINK_open(1, FSK_MODULATION_TYPE_FSK2K4, 120, bench_link_rx);
+
+			bench_peer_tune(FSK_LINK_FRAME_BYTES / 2);
+			bench_peer_listen();
+			peer.rx_frame = bench_link_peer_frame;
+
+			memset(&link_peer, 0, sizeof(link_peer));
+			link_peer.listening = true;
+			bench_link_peer_build(77, 2 * FSK_LINK_PAYLOAD_BYTES, 1);   // only the first of 2
+			bench_link_peer_build(5, BENCH_LINK_RX_BYTES, (BENCH_LINK_RX_BYTES + FSK_LINK_PAYLOAD_BYTES - 1) / FSK_LINK_PAYLOAD_BYTES);
+
+			link_tick     = 0;
+			link_tx_ticks = 0;
+			link_rx_ticks = 0;
+			link_rx_ok    = 0;
+			link_rx_bad   = 0;
+			link_tx_done  = false;
+			link_tx_ok    = false;
+			memset(&g_fsk_link_stats, 0, sizeof(g_fsk_link_stats));
+			memset(g_host_bk4819_fsk_stats, 0, sizeof(g_host_bk4819_fsk_stats));
+
+			FSK_LINK_send(2, bench_link_data, BENCH_LINK_TX_BYTES, bench_link_tx_done);
+		}
+
+		static void bench_link_tick(const unsigned int i)
+		{
+			link_tick = i;
+
+			bench_peer_poll();
+
+			if (!link_tx_done || peer.tx_busy)
+				return;
+
+			if (link_peer.frames_sent < link_peer.frames)
+			{	// the firmware has finished, the far end's turn
+				if (link_peer.frames_sent == 1)
+					link_rx_start = i;
+				link_peer.listening = false;
+				bench_peer_send(bench_link_frames[link_peer.frames_sent++]);
+			}
+			else
+			if (!link_peer.listening)
+			{
+				link_peer.listening = true;
+				bench_peer_listen();
+			}
+		}
+
+		static void bench_link_report(void)
+		{
+			const fsk_link_stats_t *p = &g_fsk_link_stats;
+
+			FSK_LINK_close();
+			peer.rx_frame = NULL;
+
+			printf("         link tx %u bytes %s, far end has it after %ums (%u bps) .. rx %u bytes %u ok %u bad in %ums (%u bps)\n",
+				BENCH_LINK_TX_BYTES, link_tx_ok ? "ok" : "FAILED", link_tx_ticks * 10, (link_tx_ticks > 0) ? (BENCH_LINK_TX_BYTES * 800u) / link_tx_ticks : 0,
+				BENCH_LINK_RX_BYTES, link_rx_ok, link_rx_bad, link_rx_ticks * 10, (link_rx_ticks > 0) ? (BENCH_LINK_RX_BYTES * 800u) / link_rx_ticks : 0);
+			printf("         link %u/%u frames tx/rx, %u messages tx/rx, %u crc %u bad header %u dup %u timeouts %u evicted .. far end %u ok\n",
+				p->tx_frames, p->rx_frames, p->tx_messages + p->rx_messages, p->rx_crc_errors, p->rx_bad_headers, p->rx_duplicates,
+				p->rx_timeouts, p->rx_evicted, link_peer.rx_ok);
+		}
+
+		// selective repeat ARQ .. the firmware sends a transfer to the far end over a link with bit errors,
+		// the far end keeps every frame it gets and answers each poll with the next frame it wants and
+		// a bitmap of the missing ones after it
+
+		#define BENCH_ARQ_BYTES      3600           // 30 frames
+		#define BENCH_ARQ_BIT_ERRORS 3000           // 1 in .. about 1 frame in 3 spoilt
+
+		static struct {
+			uint8_t      rx_buf[BENCH_ARQ_BYTES];
+			uint64_t     have;
+			uint16_t     ack[FSK_LINK_MAX_AIR_BYTES / 2];
+			uint8_t      session;
+			bool         ack_due;
+			bool         acking;
+			unsigned int lost;               // frames with bit errors
+			unsigned int fec_frames;         // frames the FEC put right
+			unsigned int fec_bytes;
+		} arq_peer;
+
+		static bool arq_done;
+		static bool arq_ok;
+
+		#ifdef ENABLE_FSK_FEC
+			static uint8_t arq_fec_parity;   // FEC on both ends, 0 = off
+			static uint8_t arq_fec_depth  = 1;
+		#endif
+
+		static uint16_t bench_arq_air_words(const uint16_t bytes)
+		{	// packet length on the air, parity and all
+			#ifdef ENABLE_FSK_FEC
+				return (bytes + (arq_fec_parity * arq_fec_depth)) / 2;
+			#else
+				return bytes / 2;
+			#endif
+		}
+
+		static void bench_arq_done(const bool ok)
+		{
+			arq_done = true;
+			arq_ok   = ok;
+		}
+
+		static void bench_arq_peer_frame(const bool ok)
+		{
+			const fsk_link_header_t *hdr    = (const fsk_link_header_t *)peer.rx_buf;
+			const unsigned int       frames = (BENCH_ARQ_BYTES + FSK_LINK_PAYLOAD_BYTES - 1) / FSK_LINK_PAYLOAD_BYTES;
+			unsigned int             num;
+
+			if (!ok)
+			{
+				arq_peer.lost++;
+				return;
+			}
+
+			#ifdef ENABLE_FSK_FEC
+				if (arq_fec_parity > 0)
+				{
+					const int fixed = FEC_decode((uint8_t *)peer.rx_buf, FSK_LINK_FRAME_BYTES, arq_fec_parity, arq_fec_depth);
+					if (fixed < 0)
+					{
+						arq_peer.lost++;
+						return;
+					}
+					if (fixed > 0)
+					{
+						arq_peer.fec_frames++;
+						arq_peer.fec_bytes += fixed;
+					}
+				}
+			#endif
+
+			if (hdr->type != FSK_LINK_TYPE_ARQ_DATA || hdr->dst != 2 || hdr->len != BENCH_ARQ_BYTES)
+				return;
+
+			// full frame number, the transfer is short enough for only the window to matter
+			for (num = hdr->index; num < frames; num += 256)
+			{
+				const unsigned int offset = num * FSK_LINK_PAYLOAD_BYTES;
+				if ((arq_peer.have & (1ull << num)) == 0)
+				{
+					memcpy(&arq_peer.rx_buf[offset], (const uint8_t *)peer.rx_buf + FSK_LINK_HEADER_BYTES,
+						((offset + FSK_LINK_PAYLOAD_BYTES) <= BENCH_ARQ_BYTES) ? FSK_LINK_PAYLOAD_BYTES : BENCH_ARQ_BYTES - offset);
+					arq_peer.have |= 1ull << num;
+				}
+				break;
+			}
+
+			arq_peer.session = hdr->seq;
+			if (hdr->count & FSK_ARQ_FLAG_POLL)
+				arq_peer.ack_due = true;
+		}
+
+		static void bench_arq_peer_ack(void)
+		{
+			fsk_link_header_t *hdr    = (fsk_link_header_t *)arq_peer.ack;
+			const unsigned int frames = (BENCH_ARQ_BYTES + FSK_LINK_PAYLOAD_BYTES - 1) / FSK_LINK_PAYLOAD_BYTES;
+			unsigned int       next   = 0;
+			unsigned int       i;
+
+			while (next < frames && (arq_peer.have & (1ull << next)))
+				next++;
+
+			hdr->type  = FSK_LINK_TYPE_ARQ_ACK;
+			hdr->src   = 2;
+			hdr->dst   = 1;
+			hdr->seq   = arq_peer.session;
+			hdr->index = (uint8_t)next;
+			hdr->count = 0;
+			hdr->len   = 0;
+			for (i = 0; i < 16 && (next + i) < frames; i++)
+				if ((arq_peer.have & (1ull << (next + i))) == 0)
+					hdr->len |= 1u << i;
+
+			#ifdef ENABLE_FSK_FEC
+				if (arq_fec_parity > 0)
+					FEC_encode((uint8_t *)arq_peer.ack, FSK_ARQ_ACK_BYTES, arq_fec_parity, arq_fec_depth);
+			#endif
+
+			bench_peer_length(bench_arq_air_words(FSK_ARQ_ACK_BYTES));
+			bench_peer_send(arq_peer.ack);
+		}
+
+		static void bench_arq_start(const unsigned int window)
+		{
+			bench_link_data_setup();
+			bench_fsk_channel();
+
+			FSK_LINK_open(1, FSK_MODULATION_TYPE_FSK2K4, 120, NULL);
+			#ifdef ENABLE_FSK_FEC
+				FSK_LINK_set_fec(arq_fec_parity, arq_fec_depth);   // before the far end copies the modem settings
+			#endif
+
+			bench_peer_tune(bench_arq_air_words(FSK_LINK_FRAME_BYTES));
+			bench_peer_listen();
+			peer.rx_frame = bench_arq_peer_frame;
+
+			memset(&arq_peer, 0, sizeof(arq_peer));
+			arq_done = false;
+			arq_ok   = false;
+			memset(&g_fsk_link_stats, 0, sizeof(g_fsk_link_stats));
+			memset(g_host_bk4819_fsk_stats, 0, sizeof(g_host_bk4819_fsk_stats));
+
+			HOST_bk4819_set_bit_errors(BENCH_ARQ_BIT_ERRORS);
+
+			FSK_ARQ_send(2, bench_link_data, BENCH_ARQ_BYTES, window, bench_arq_done);
+		}
+
+		static void bench_arq_setup(void)
+		{
+			bench_arq_start(FSK_ARQ_MAX_WINDOW);
+		}
+
+		#ifdef ENABLE_FSK_FEC
+			static void bench_arqfec_setup(void)
+			{	// 16 parity bytes per codeword, 2 codewords per frame .. up to 8 bad bytes in each put right
+				arq_fec_parity = 16;
+				arq_fec_depth  = 2;
+				bench_arq_start(FSK_ARQ_MAX_WINDOW);
+			}
+		#endif
+
+		static void bench_arq1_setup(void)
+		{	// stop-and-wait for comparison
+			bench_arq_start(1);
+		}
+
+		static void bench_arq_tick(const unsigned int i)
+		{
+			(void)i;
+
+			bench_peer_poll();
+
+			if (arq_peer.acking && !peer.tx_busy)
+			{	// ACK is out, back to listening for frames
+				arq_peer.acking = false;
+				bench_peer_length(bench_arq_air_words(FSK_LINK_FRAME_BYTES));
+				bench_peer_listen();
+			}
+
+			if (arq_peer.ack_due && !peer.tx_busy)
+			{
+				arq_peer.ack_due = false;
+				arq_peer.acking  = true;
+				bench_arq_peer_ack();
+			}
+		}
+
+		static void bench_arq_report(void)
+		{
+			const fsk_arq_tx_stats_t *p    = &g_fsk_arq_tx_stats;
+			const bool                same = memcmp(arq_peer.rx_buf, bench_link_data, BENCH_ARQ_BYTES) == 0;
+
+			HOST_bk4819_set_bit_errors(0);
+			FSK_LINK_close();
+			peer.rx_frame = NULL;
+
+			printf("         arq %u bytes %s in %ums (%u bps) .. far end %s, %u frame errors\n",
+				p->bytes, !arq_done ? "NOT DONE" : arq_ok ? "ok" : "FAILED", p->ticks_10ms * 10,
+				(arq_done && p->ticks_10ms > 0) ? (p->bytes * 800u) / p->ticks_10ms : 0,
+				same ? "same data" : "DATA DIFFERS", arq_peer.lost + g_fsk_link_stats.rx_crc_errors);
+			printf("         arq %u frames %u retransmits %u bursts %u acks %u timeouts, srtt %ums rto %ums\n",
+				p->frames, p->retransmits, p->bursts, p->acks, p->timeouts, p->srtt_10ms * 10, p->rto_10ms * 10);
+
+			#ifdef ENABLE_FSK_FEC
+				if (arq_fec_parity > 0)
+					printf("         arq fec %u parity x %u, frames/bytes put right %u/%u here %u/%u far end\n",
+						arq_fec_parity, arq_fec_depth, g_fsk_link_stats.rx_fec_frames, g_fsk_link_stats.rx_fec_bytes,
+						arq_peer.fec_frames, arq_peer.fec_bytes);
+
+				arq_fec_parity = 0;
+				arq_fec_depth  = 1;
+				FSK_LINK_set_fec(0, 1);
+			#endif
+		}
+
+		// adaptive rate .. the far end (address 2) streams an ARQ transfer to the firmware with both ends adaptive,
+		// 40s of a strong signal, 40s at -112dBm with 1 bit in 200 wrong at 2400bps, then strong again. The far end
+		// sends at the rate the firmware's ACKs ask for, and drops to the slowest after 2 polls go unanswered, the
+		// same as the firmware would
+
+		#define BENCH_RATE_BYTES       60000          // more than can get through
+		#define BENCH_RATE_PHASE_TICKS 4000
+		#define BENCH_RATE_ACK_TICKS   150            // far end's ACK timeout
+		#define BENCH_RATE_BIT_ERRORS  200
+
+		static struct {
+			uint16_t     frame[FSK_LINK_FRAME_BYTES / 2];
+			uint16_t     base;
+			uint16_t     next;
+			uint16_t     acked;
+			uint16_t     burst[FSK_ARQ_MAX_WINDOW];
+			uint8_t      burst_count;
+			uint8_t      burst_index;
+			uint8_t      rate;
+			uint8_t      timeouts;       // in a row
+			bool         waiting;        // for an ACK
+			uint16_t     timer;
+			unsigned int phase;
+			unsigned int rx_bytes[3];    // handed up by the firmware in each phase
+			unsigned int rate_ticks[3][FSK_LINK_RATES];
+			unsigned int rx_bad;
+		} rate_peer;
+
+		static uint8_t bench_rate_byte(const unsigned int offset)
+		{
+			return (uint8_t)((offset * 13u) ^ (offset >> 7));
+		}
+
+		static void bench_rate_rx(const uint8_t src, const uint16_t offset, const uint8_t *data, const uint16_t len, const uint16_t total)
+		{	// the firmware's ARQ receiver handing up the transfer in order
+			unsigned int i;
+
+			for (i = 0; i < len; i++)
+				if (data[i] != bench_rate_byte(offset + i))
+					break;
+
+			if (src != 2 || total != BENCH_RATE_BYTES || i < len)
+				rate_peer.rx_bad++;
+
+			rate_peer.rx_bytes[rate_peer.phase] += len;
+		}
+
+		static void bench_rate_peer_set(const uint8_t rate)
+		{	// the model only goes by the bit rate, with REG_58's modes at 0 that comes from the tone 2 frequency
+			rate_peer.rate = rate;
+			HOST_bk4819_write(1, BK4819_REG_72, ((g_fsk_link_rates[rate].bps * 103244u) + 5000u) / 10000u);
+		}
+
+		static void bench_rate_peer_burst(void)
+		{	// the frames the firmware is missing, then new ones up to a window ahead
+			unsigned int i;
+
+			rate_peer.burst_count = 0;
+			rate_peer.burst_index = 0;
+
+			for (i = 0; i < (unsigned int)(rate_peer.next - rate_peer.base); i++)
+				if ((rate_peer.acked & (1u << i)) == 0)
+					rate_peer.burst[rate_peer.burst_count++] = rate_peer.base + i;
+
+			while (rate_peer.burst_count < FSK_ARQ_MAX_WINDOW && rate_peer.next < (rate_peer.base + FSK_ARQ_MAX_WINDOW))
+				rate_peer.burst[rate_peer.burst_count++] = rate_peer.next++;
+		}
+
+		static void bench_rate_peer_frame(const bool ok)
+		{	// an ACK from the firmware
+			const fsk_link_header_t *hdr = (const fsk_link_header_t *)peer.rx_buf;
+			const uint8_t            rate = hdr->type >> FSK_LINK_RATE_SHIFT;
+			uint16_t                 step;
+
+			if (!ok || !rate_peer.waiting || (hdr->type & FSK_LINK_TYPE_MASK) != FSK_LINK_TYPE_ARQ_ACK || hdr->dst != 2)
+				return;
+
+			step = (uint8_t)(hdr->index - (uint8_t)rate_peer.base);
+			if (step > (rate_peer.next - rate_peer.base))
+				return;
+
+			rate_peer.base    += step;
+			rate_peer.acked    = ~hdr->len;
+			rate_peer.timeouts = 0;
+			rate_peer.waiting  = false;
+
+			if (rate > 0 && (rate - 1) != rate_peer.rate)
+				bench_rate_peer_set(rate - 1);
+
+			bench_rate_peer_burst();
+			bench_peer_length(FSK_LINK_FRAME_BYTES / 2);
+		}
+
+		static void bench_rate_peer_send(void)
+		{
+			fsk_link_header_t *hdr    = (fsk_link_header_t *)rate_peer.frame;
+			const uint16_t     num    = rate_peer.burst[rate_peer.burst_index++];
+			uint8_t           *data   = (uint8_t *)rate_peer.frame + FSK_LINK_HEADER_BYTES;
+			unsigned int       i;
+
+			hdr->type  = FSK_LINK_TYPE_ARQ_DATA | ((rate_peer.rate + 1) << FSK_LINK_RATE_SHIFT);
+			hdr->src   = 2;
+			hdr->dst   = 1;
+			hdr->seq   = 1;
+			hdr->index = (uint8_t)num;
+			hdr->count = (rate_peer.burst_index >= rate_peer.burst_count) ? FSK_ARQ_FLAG_POLL : 0;
+			hdr->len   = BENCH_RATE_BYTES;
+			for (i = 0; i < FSK_LINK_PAYLOAD_BYTES; i++)
+				data[i] = bench_rate_byte((num * FSK_LINK_PAYLOAD_BYTES) + i);
+
+			bench_peer_send(rate_peer.frame);
+		}
+
+		static void bench_rate_setup(void)
+		{
+			bench_fsk_channel();
+
+			FSK_LINK_open(1, FSK_MODULATION_TYPE_FSK2K4, 120, NULL);
+			FSK_LINK_set_adaptive(true);
+			FSK_ARQ_set_rx(bench_rate_rx);
+
+			bench_peer_tune(FSK_LINK_FRAME_BYTES / 2);   // the firmware starts listening at the slowest rate
+			peer.rx_frame = bench_rate_peer_frame;
+
+			memset(&rate_peer, 0, sizeof(rate_peer));
+			bench_rate_peer_set(0);
+			bench_rate_peer_burst();
+
+			memset(&g_fsk_link_stats, 0, sizeof(g_fsk_link_stats));
+			memset(g_host_bk4819_fsk_stats, 0, sizeof(g_host_bk4819_fsk_stats));
+			HOST_bk4819_set_rssi(FSK_LINK_DBM(-80));
+		}
+
+		static void bench_rate_tick(const unsigned int i)
+		{
+			const unsigned int phase = i / BENCH_RATE_PHASE_TICKS;
+
+			if (phase != rate_peer.phase && phase < 3)
+			{
+				rate_peer.phase = phase;
+				HOST_bk4819_set_rssi(FSK_LINK_DBM((phase == 1) ? -112 : -80));
+				HOST_bk4819_set_bit_errors((phase == 1) ? BENCH_RATE_BIT_ERRORS : 0);
+			}
+
+			rate_peer.rate_ticks[rate_peer.phase][FSK_LINK_rate()]++;
+
+			bench_peer_poll();
+
+			if (peer.tx_busy)
+				return;
+
+			if (rate_peer.waiting)
+			{
+				if (++rate_peer.timer < BENCH_RATE_ACK_TICKS)
+					return;
+
+				// no ACK, poll with the oldest frame it's missing
+				rate_peer.waiting = false;
+				if (++rate_peer.timeouts >= FSK_LINK_RATE_TX_FAILS)
+					bench_rate_peer_set(0);
+				rate_peer.burst[0]    = rate_peer.base;
+				rate_peer.burst_count = 1;
+				rate_peer.burst_index = 0;
+				bench_peer_length(FSK_LINK_FRAME_BYTES / 2);
+			}
+
+			if (rate_peer.burst_index < rate_peer.burst_count)
+				bench_rate_peer_send();
+			else
+			{	// the poll is out, listen for the ACK
+				rate_peer.waiting = true;
+				rate_peer.timer   = 0;
+				bench_peer_length(FSK_ARQ_ACK_BYTES / 2);
+				bench_peer_listen();
+			}
+		}
+
+		static void bench_rate_report(void)
+		{
+			static const char *names[] = {"strong", "weak", "strong"};
+			const fsk_link_stats_t *p = &g_fsk_link_stats;
+			unsigned int            i;
+
+			HOST_bk4819_set_bit_errors(0);
+			HOST_bk4819_set_rssi(0x0060);
+			FSK_LINK_set_adaptive(false);
+			FSK_ARQ_set_rx(NULL);
+			FSK_LINK_close();
+			peer.rx_frame = NULL;
+
+			for (i = 0; i < 3; i++)
+			{
+				const unsigned int *t = rate_peer.rate_ticks[i];
+				printf("         rate %-6s %5u bytes (%4u bps) .. %3u%% %3u%% %3u%% %3u%% of the time at %u/%u/%u/%u bps\n",
+					names[i], rate_peer.rx_bytes[i], (rate_peer.rx_bytes[i] * 800u) / BENCH_RATE_PHASE_TICKS,
+					(t[0] * 100u) / BENCH_RATE_PHASE_TICKS, (t[1] * 100u) / BENCH_RATE_PHASE_TICKS,
+					(t[2] * 100u) / BENCH_RATE_PHASE_TICKS, (t[3] * 100u) / BENCH_RATE_PHASE_TICKS,
+					g_fsk_link_rates[0].bps, g_fsk_link_rates[1].bps, g_fsk_link_rates[2].bps, g_fsk_link_rates[3].bps);
+			}
+			printf("         rate %u up %u down %u resets, %u crc errors .. data %s\n",
+				p->rate_ups, p->rate_downs, p->rate_resets, p->rx_crc_errors, (rate_peer.rx_bad == 0) ? "same" : "DIFFERS");
+		}
+
+		#ifdef ENABLE_KISS_TNC
+			// KISS TNC .. the PC on the programming lead sends 12 frames to the far end through the TNC,
+			// then the far end sends 8 back. The kiss run uses ACKMODE and keeps 2 frames in the TNC at a
+			// time, kissraw sends everything as fast as the UART goes
+
+			#define BENCH_KISS_TX_FRAMES   12
+			#define BENCH_KISS_RX_FRAMES   8
+			#define BENCH_KISS_BYTES       300
+			#define BENCH_KISS_WINDOW      2          // ACKMODE frames in the TNC at once
+			#define BENCH_KISS_UART_TICK   38         // bytes the PC gets through at 38400 baud in 10ms
+			#define BENCH_KISS_RX_TICK     2400       // the far end starts sending back
+
+			static struct {
+				bool         ackmode;
+				uint8_t      in[(BENCH_KISS_TX_FRAMES * ((BENCH_KISS_BYTES * 2) + 8)) + 16];   // still to go down the UART
+				unsigned int in_len;
+				unsigned int in_pos;
+				unsigned int tx_next;                  // frames given to the TNC
+				unsigned int acks;
+				uint8_t      out[FSK_LINK_MAX_MESSAGE_BYTES + 8];   // a frame coming back up the UART
+				unsigned int out_len;
+				bool         out_escape;
+				unsigned int rx_ok;                    // frames from the far end the PC got intact
+				unsigned int rx_bad;
+				unsigned int rx_ticks;
+			} kiss_pc;
+
+			static struct {
+				uint8_t      buf[BENCH_KISS_BYTES];
+				uint32_t     have;
+				uint8_t      seq;
+				unsigned int rx_ok;                    // frames from the PC it got intact
+				unsigned int rx_bad;
+				unsigned int rx_ticks;
+				unsigned int sent;                     // link frames sent back
+				bool         listening;
+			} kiss_peer;
+
+			static unsigned int kiss_tick;
+
+			static uint8_t bench_kiss_byte(const unsigned int frame, const unsigned int i)
+			{	// plenty of FENDs and FESCs to escape
+				return (uint8_t)((i * 7u) + (frame * 61u));
+			}
+
+			static bool bench_kiss_check(const uint8_t *data, const unsigned int len, const unsigned int frame)
+			{
+				unsigned int i;
+
+				if (len != BENCH_KISS_BYTES)
+					return false;
+
+				for (i = 0; i < len; i++)
+					if (data[i] != bench_kiss_byte(frame, i))
+						return false;
+
+				return true;
+			}
+
+			static void bench_kiss_put(const uint8_t b)
+			{
+				if (b == KISS_FEND || b == KISS_FESC)
+				{
+					kiss_pc.in[kiss_pc.in_len++] = KISS_FESC;
+					kiss_pc.in[kiss_pc.in_len++] = (b == KISS_FEND) ? KISS_TFEND : KISS_TFESC;
+				}
+				else
+					kiss_pc.in[kiss_pc.in_len++] = b;
+			}
+
+			static void bench_kiss_queue_frame(void)
+			{	// the PC's next frame onto the end of what's still going down the UART
+				const unsigned int frame = kiss_pc.tx_next++;
+				unsigned int       i;
+
+				kiss_pc.in[kiss_pc.in_len++] = KISS_FEND;
+				if (kiss_pc.ackmode)
+				{
+					kiss_pc.in[kiss_pc.in_len++] = KISS_CMD_ACKMODE;
+					bench_kiss_put(0x12);
+					bench_kiss_put((uint8_t)frame);
+				}
+				else
+					kiss_pc.in[kiss_pc.in_len++] = KISS_CMD_DATA;
+				for (i = 0; i < BENCH_KISS_BYTES; i++)
+					bench_kiss_put(bench_kiss_byte(frame, i));
+				kiss_pc.in[kiss_pc.in_len++] = KISS_FEND;
+			}
+
+			static void bench_kiss_uart_tx(const uint8_t *data, const uint32_t len)
+			{	// the PC's KISS decoder on what the TNC sends
+				uint32_t i;
+
+				for (i = 0; i < len; i++)
+				{
+					uint8_t b = data[i];
+
+					if (b == KISS_FEND)
+					{
+						if (kiss_pc.out_len == 3 && kiss_pc.out[0] == KISS_CMD_ACKMODE)
+							kiss_pc.acks++;
+						else
+						if (kiss_pc.out_len > 0 && kiss_pc.out[0] == KISS_CMD_DATA)
+						{
+							if (bench_kiss_check(&kiss_pc.out[1], kiss_pc.out_len - 1, 100 + kiss_pc.rx_ok + kiss_pc.rx_bad))
+								kiss_pc.rx_ok++;
+							else
+								kiss_pc.rx_bad++;
+							kiss_pc.rx_ticks = kiss_tick + 1 - BENCH_KISS_RX_TICK;
+						}
+						kiss_pc.out_len    = 0;
+						kiss_pc.out_escape = false;
+						continue;
+					}
+
+					if (kiss_pc.out_escape)
+						b = (b == KISS_TFEND) ? KISS_FEND : KISS_FESC;
+					else
+					if (b == KISS_FESC)
+					{
+						kiss_pc.out_escape = true;
+						continue;
+					}
+					kiss_pc.out_escape = false;
+
+					if (kiss_pc.out_len < sizeof(kiss_pc.out))
+						kiss_pc.out[kiss_pc.out_len++] = b;
+				}
+			}
+
+			static void bench_kiss_peer_frame(const bool ok)
+			{	// the far end putting the PC's frames back together
+				const fsk_link_header_t *hdr    = (const fsk_link_header_t *)peer.rx_buf;
+				const unsigned int       offset = hdr->index * FSK_LINK_PAYLOAD_BYTES;
+
+				if (!ok || hdr->type != FSK_LINK_TYPE_DATA || hdr->dst != FSK_LINK_BROADCAST || hdr->len != BENCH_KISS_BYTES || hdr->index >= hdr->count)
+					return;
+
+				if (hdr->seq != kiss_peer.seq)
+				{	// a new message, whatever is left of the last one isn't coming
+					kiss_peer.seq  = hdr->seq;
+					kiss_peer.have = 0;
+				}
+
+				memcpy(&kiss_peer.buf[offset], (const uint8_t *)peer.rx_buf + FSK_LINK_HEADER_BYTES,
+					((offset + FSK_LINK_PAYLOAD_BYTES) <= hdr->len) ? FSK_LINK_PAYLOAD_BYTES : hdr->len - offset);
+				kiss_peer.have |= 1u << hdr->index;
+
+				if (kiss_peer.have == (0xFFFFFFFFu >> (32 - hdr->count)))
+				{	// they come in order, so the frame number is how many have arrived
+					kiss_peer.have = 0;
+					if (bench_kiss_check(kiss_peer.buf, hdr->len, kiss_peer.rx_ok))
+						kiss_peer.rx_ok++;
+					else
+						kiss_peer.rx_bad++;
+					kiss_peer.rx_ticks = kiss_tick + 1;
+				}
+			}
+
+			static void bench_kiss_peer_send(void)
+			{	// the far end's frames back, one link frame at a time
+				const unsigned int frames = (BENCH_KISS_BYTES + FSK_LINK_PAYLOAD_BYTES - 1) / FSK_LINK_PAYLOAD_BYTES;
+				const unsigned int msg    = kiss_peer.sent / frames;
+				const unsigned int index  = kiss_peer.sent % frames;
+				fsk_link_header_t *hdr    = (fsk_link_header_t *)bench_link_frames[0];
+				uint8_t           *data   = (uint8_t *)hdr + FSK_LINK_HEADER_BYTES;
+				unsigned int       i;
+
+				memset(hdr, 0, FSK_LINK_FRAME_BYTES);
+				hdr->type  = FSK_LINK_TYPE_DATA;
+				hdr->src   = 2;
+				hdr->dst   = FSK_LINK_BROADCAST;
+				hdr->seq   = (uint8_t)(200 + msg);
+				hdr->index = index;
+				hdr->count = frames;
+				hdr->len   = BENCH_KISS_BYTES;
+				for (i = 0; i < FSK_LINK_PAYLOAD_BYTES && ((index * FSK_LINK_PAYLOAD_BYTES) + i) < BENCH_KISS_BYTES; i++)
+					data[i] = bench_kiss_byte(100 + msg, (index * FSK_LINK_PAYLOAD_BYTES) + i);
+
+				kiss_peer.sent++;
+				bench_peer_send(bench_link_frames[0]);
+			}
+
+			static void bench_kiss_start(const bool ackmode)
+			{
+				static const uint8_t settings[] = {
+					KISS_FEND, KISS_CMD_SETHARDWARE, 1, KISS_FEND,      // link address 1
+					KISS_FEND, KISS_CMD_P, 255, KISS_FEND               // only the two of us, no need to hold back
+				};
+				unsigned int i;
+
+				bench_fsk_channel();
+				g_setting_fsk_modem_mode = FSK_MODULATION_TYPE_FSK2K4;
+
+				memset(&kiss_pc, 0, sizeof(kiss_pc));
+				memset(&kiss_peer, 0, sizeof(kiss_peer));
+				memset(&g_kiss_tnc_stats, 0, sizeof(g_kiss_tnc_stats));
+				memset(&g_fsk_link_stats, 0, sizeof(g_fsk_link_stats));
+				memset(g_host_bk4819_fsk_stats, 0, sizeof(g_host_bk4819_fsk_stats));
+				HOST_uart_set_tx(bench_kiss_uart_tx);
+
+				// the first KISS frame opens the link
+				for (i = 0; i < ARRAY_SIZE(settings); i++)
+					KISS_TNC_uart_byte(settings[i]);
+
+				bench_peer_tune(FSK_LINK_FRAME_BYTES / 2);
+				bench_peer_listen();
+				peer.rx_frame       = bench_kiss_peer_frame;
+				kiss_peer.seq       = 0xFF;
+				kiss_peer.listening = true;
+
+				kiss_pc.ackmode = ackmode;
+				while (kiss_pc.tx_next < (ackmode ? BENCH_KISS_WINDOW : BENCH_KISS_TX_FRAMES))
+					bench_kiss_queue_frame();
+			}
+
+			static void bench_kiss_setup(void)
+			{
+				bench_kiss_start(true);
+			}
+
+			static void bench_kissraw_setup(void)
+			{
+				bench_kiss_start(false);
+			}
+
+			static void bench_kiss_tick(const unsigned int i)
+			{
+				unsigned int n;
+
+				kiss_tick = i;
+
+				// the PC .. another frame for every ack, and the UART's worth of bytes
+				if (kiss_pc.ackmode)
+					while (kiss_pc.tx_next < BENCH_KISS_TX_FRAMES && kiss_pc.tx_next < (kiss_pc.acks + BENCH_KISS_WINDOW))
+						bench_kiss_queue_frame();
+
+				for (n = 0; n < BENCH_KISS_UART_TICK && kiss_pc.in_pos < kiss_pc.in_len; n++)
+					KISS_TNC_uart_byte(kiss_pc.in[kiss_pc.in_pos++]);
+
+				// the far end
+				bench_peer_poll();
+
+				if (i < BENCH_KISS_RX_TICK || peer.tx_busy)
+					return;
+
+				if (kiss_peer.sent < (BENCH_KISS_RX_FRAMES * ((BENCH_KISS_BYTES + FSK_LINK_PAYLOAD_BYTES - 1) / FSK_LINK_PAYLOAD_BYTES)))
+				{
+					kiss_peer.listening = false;
+					bench_kiss_peer_send();
+				}
+				else
+				if (!kiss_peer.listening)
+				{
+					kiss_peer.listening = true;
+					bench_peer_listen();
+				}
+			}
+
+			static void bench_kiss_report(void)
+			{
+				const kiss_tnc_stats_t *p = &g_kiss_tnc_stats;
+
+				KISS_TNC_uart_byte(KISS_FEND);
+				KISS_TNC_uart_byte(KISS_CMD_RETURN);
+				KISS_TNC_uart_byte(KISS_FEND);
+				HOST_uart_set_tx(NULL);
+				peer.rx_frame = NULL;
+
+				printf("         kiss pc->air %u frames, far end %u ok %u bad after %ums (%u bps) .. %u acks, tx queue high %u bytes, %u dropped\n",
+					BENCH_KISS_TX_FRAMES, kiss_peer.rx_ok, kiss_peer.rx_bad, kiss_peer.rx_ticks * 10,
+					(kiss_peer.rx_ticks > 0) ? (kiss_peer.rx_ok * BENCH_KISS_BYTES * 800u) / kiss_peer.rx_ticks : 0,
+					kiss_pc.acks, p->tx_high_water, p->tx_dropped);
+				printf("         kiss air->pc %u frames, pc %u ok %u bad after %ums (%u bps) .. rx queue high %u bytes, %u dropped, %u bad KISS frames\n",
+					BENCH_KISS_RX_FRAMES, kiss_pc.rx_ok, kiss_pc.rx_bad, kiss_pc.rx_ticks * 10,
+					(kiss_pc.rx_ticks > 0) ? (kiss_pc.rx_ok * BENCH_KISS_BYTES * 800u) / kiss_pc.rx_ticks : 0,
+					p->rx_high_water, p->rx_dropped, p->uart_bad);
+			}
+		#endif
+
+		#ifdef ENABLE_FSK_FEC
+			// the Reed-Solomon codec on its own, a link frame with 16 parity bytes per codeword at each
+			// interleaving depth .. the time per frame byte to encode, to check a clean frame and to put
+			// right 8 bad bytes in every codeword, then whether a 64 bit burst (9 bytes) is put right
+
+			#define BENCH_FEC_PARITY 16
+			#define BENCH_FEC_LOOPS  2000
+
+			static void bench_fec_spoil(uint8_t *frame, const unsigned int depth)
+			{	// the most bad bytes each codeword can take, spread through it
+				unsigned int k;
+				unsigned int e;
+
+				for (k = 0; k < depth; k++)
+					for (e = 0; e < (BENCH_FEC_PARITY / 2); e++)
+						frame[k + (e * 4 * depth)] ^= (uint8_t)(0x5A + e);
+			}
+
+			static void bench_fec_report(void)
+			{
+				static uint8_t sent[FSK_LINK_MAX_AIR_BYTES];
+				static uint8_t frame[FSK_LINK_MAX_AIR_BYTES];
+				unsigned int   depth;
+				unsigned int   i;
+
+				for (i = 0; i < FSK_LINK_FRAME_BYTES; i++)
+					sent[i] = (uint8_t)((i * 0x9Du) ^ (i >> 2));
+
+				for (depth = 1; depth <= FEC_MAX_DEPTH; depth++)
+				{
+					const unsigned int air   = FSK_LINK_FRAME_BYTES + (BENCH_FEC_PARITY * depth);
+					bool               same  = true;
+					int                fixed = 0;
+					uint64_t           ns[3];
+					uint64_t           start;
+					unsigned int       n;
+
+					start = bench_now_ns();
+					for (n = 0; n < BENCH_FEC_LOOPS; n++)
+						FEC_encode(sent, FSK_LINK_FRAME_BYTES, BENCH_FEC_PARITY, depth);
+					ns[0] = bench_now_ns() - start;
+
+					start = bench_now_ns();
+					for (n = 0; n < BENCH_FEC_LOOPS; n++)
+					{
+						memcpy(frame, sent, air);
+						fixed |= FEC_decode(frame, FSK_LINK_FRAME_BYTES, BENCH_FEC_PARITY, depth);
+					}
+					ns[1] = bench_now_ns() - start;
+					same = same && fixed == 0 && memcmp(frame, sent, air) == 0;
+
+					start = bench_now_ns();
+					for (n = 0; n < BENCH_FEC_LOOPS; n++)
+					{
+						memcpy(frame, sent, air);
+						bench_fec_spoil(frame, depth);
+						fixed = FEC_decode(frame, FSK_LINK_FRAME_BYTES, BENCH_FEC_PARITY, depth);
+					}
+					ns[2] = bench_now_ns() - start;
+					same = same && fixed == (int)((BENCH_FEC_PARITY / 2) * depth) && memcmp(frame, sent, air) == 0;
+
+					// 64 bits in a row from the middle of the frame
+					memcpy(frame, sent, air);
+					for (i = 0; i < 64; i++)
+						frame[40 + ((i + 4) / 8)] ^= 1u << ((i + 4) & 7u);
+					fixed = FEC_decode(frame, FSK_LINK_FRAME_BYTES, BENCH_FEC_PARITY, depth);
+
+					printf("         fec %u x %u: encode %5.1fns, check %5.1fns, correct %5.1fns per byte .. %s, burst %s\n",
+						BENCH_FEC_PARITY, depth,
+						(double)ns[0] / (BENCH_FEC_LOOPS * FSK_LINK_FRAME_BYTES),
+						(double)ns[1] / (BENCH_FEC_LOOPS * FSK_LINK_FRAME_BYTES),
+						(double)ns[2] / (BENCH_FEC_LOOPS * FSK_LINK_FRAME_BYTES),
+						same ? "same data" : "DATA DIFFERS",
+						(fixed < 0) ? "lost" : (memcmp(frame, sent, air) == 0) ? "put right" : "WRONG");
+				}
+			}
+		#endif
+	#endif
+#endif
+
+static const bench_t benches[] = {
+	{"idle",   NULL,              NULL,              NULL,               1000},
+	{"render", NULL,              bench_render_tick, NULL,                500},
+	{"keys",   NULL,              bench_keys_tick,   NULL,                250},
+	{"save",   NULL,              bench_save_tick,   NULL,                500},
+	{"scan",   bench_scan_setup,  NULL,              NULL,               1000},
+	{"glyph",  NULL,              NULL,              bench_glyph_report,    0},
+	{"format", NULL,              NULL,              bench_format_report,   0},
+#ifdef ENABLE_FSK_MODEM
+	{"fsktx",  bench_fsktx_setup, bench_fsktx_tick,  bench_fsktx_report, 1000},
+	{"fskrx",  bench_fskrx_setup, bench_fskrx_tick,  bench_fskrx_report, 1500},
+	#ifdef ENABLE_FSK_LINK
+		{"link",   bench_link_setup,  bench_link_tick,   bench_link_report,  1400},
+		{"arq",    bench_arq_setup,   bench_arq_tick,    bench_arq_report,   4000},
+		{"arq1",   bench_arq1_setup,  bench_arq_tick,    bench_arq_report,   4000},
+		{"rate",   bench_rate_setup,  bench_rate_tick,   bench_rate_report, 12000},
+		#ifdef ENABLE_KISS_TNC
+			{"kiss",    bench_kiss_setup,    bench_kiss_tick, bench_kiss_report, 4000},
+			{"kissraw", bench_kissraw_setup, bench_kiss_tick, bench_kiss_report, 4000},
+		#endif
+		#ifdef ENABLE_FSK_FEC
+			{"fec",    NULL,              NULL,              bench_fec_report,      0},
+			{"arqfec", bench_arqfec_setup, bench_arq_tick,   bench_arq_report,   4000},
+		#endif
+	#endif
+#endif
+};
+
+// ****************************
+
+static void bench_print_header(void)
+{
+	printf("%-8s %6s %10s %9s %8s %8s %9s %8s %6s %6s %8s %9s %8s\n",
+		"", "ticks", "host us", "max us",
+		"bk rd", "bk wr", "bk clks",
+		"ee bytes", "lcd", "stat", "lcd B",
+		"delay ms", "lcd hash");
+}
+
+static void bench_print(const char *name, const unsigned int ticks, const uint64_t ns, const uint64_t max_ns, const uint64_t delay_us)
+{
+	printf("%-8s %6u %10.1f %9.1f %8u %8u %9u %8u %6u %6u %8u %9.1f %08X\n",
+		name, ticks, ns / 1000.0, max_ns / 1000.0,
+		g_host_bk4819_stats.reads, g_host_bk4819_stats.writes, g_host_bk4819_stats.bits,
+		g_eeprom_write_stats.bytes_written,
+		g_host_lcd_stats.full_blits, g_host_lcd_stats.status_blits, g_host_lcd_stats.bytes,
+		delay_us / 1000.0,
+		HOST_lcd_hash());
+
+	if (show_screen)
+		HOST_lcd_print();
+}
+
+static void bench_print_bus_log(void)
+{
+	const uint32_t count = (g_host_bk4819_log_count < HOST_BK4819_LOG_SIZE) ? g_host_bk4819_log_count : HOST_BK4819_LOG_SIZE;
+	uint32_t       i;
+
+	for (i = 0; i < count; i++)
+	{
+		const HOST_bk4819_log_t *p = &g_host_bk4819_log[i];
+		printf("%12.3fms  %u  %s REG_%02X  %04X\n", p->time_us / 1000.0, p->unit, (p->reg & 0x80u) ? "rd" : "wr", p->reg & 0x7Fu, p->value);
+	}
+	if (g_host_bk4819_log_count > count)
+		printf("  .. %u more\n", g_host_bk4819_log_count - count);
+}
+
+static void bench_clear_stats(void)
+{
+	g_host_bk4819_log_count = 0;
+	memset(&g_host_bk4819_stats,  0, sizeof(g_host_bk4819_stats));
+	memset(&g_eeprom_write_stats, 0, sizeof(g_eeprom_write_stats));
+	memset(&g_host_lcd_stats,     0, sizeof(g_host_lcd_stats));
+}
+
+static void bench_run(const bench_t *p_bench)
+{
+	uint64_t     start_delay_us;
+	uint64_t     start_ns;
+	uint64_t     max_ns = 0;
+	unsigned int i;
+
+	if (p_bench->setup != NULL)
+		p_bench->setup();
+
+	bench_clear_stats();
+	start_delay_us = g_host_delay_us;
+	start_ns       = bench_now_ns();
+
+	for (i = 0; i < p_bench->ticks; i++)
+	{
+		if (p_bench->tick != NULL)
+			p_bench->tick(i);
+		HOST_next_tick();
+		bench_main_loop_once(&max_ns);
+	}
+
+	bench_print(p_bench->name, p_bench->ticks, bench_now_ns() - start_ns, max_ns, g_host_delay_us - start_delay_us);
+
+	if (show_bus_log)
+		bench_print_bus_log();
+
+	if (p_bench->report != NULL)
+		p_bench->report();
+
+	HOST_key_release();
+	if (g_scan_state_dir != SCAN_STATE_DIR_OFF)
+		APP_stop_scan();
+}
+
+int main(int argc, char *argv[])
+{
+	const char  *scenario = NULL;
+	const char  *image    = NULL;
+	uint64_t     start_ns;
+	uint64_t     start_delay_us;
+	unsigned int i;
+	int          opt;
+
+	for (opt = 1; opt < argc; opt++)
+	{
+		if (strcmp(argv[opt], "-e") == 0 && (opt + 1) < argc)
+			image = argv[++opt];
+		else
+		if (strcmp(argv[opt], "-s") == 0 && (opt + 1) < argc)
+			scenario = argv[++opt];
+		else
+		if (strcmp(argv[opt], "-d") == 0)
+			show_screen = true;
+		else
+		if (strcmp(argv[opt], "-b") == 0)
+			show_bus_log = true;
+		else
+		{
+			printf("usage: %s [-e eeprom.bin] [-s boot|idle|render|keys|save|scan|glyph|format|fsktx|fskrx|link|arq|arq1|rate|kiss|kissraw|fec|arqfec] [-d] [-b]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	HOST_init();
+
+	if (image == NULL)
+		bench_default_eeprom();
+	else
+	if (!bench_load_eeprom(image))
+	{
+		printf("can't read %s\n", image);
+		return 1;
+	}
+
+	bench_print_header();
+
+	start_delay_us = g_host_delay_us;
+	start_ns       = bench_now_ns();
+	bench_boot();
+	if (scenario == NULL || strcmp(scenario, "boot") == 0)
+		bench_print("boot", 0, bench_now_ns() - start_ns, 0, g_host_delay_us - start_delay_us);
+
+	if (image == NULL)
+		bench_add_channels();
+
+	for (i = 0; i < ARRAY_SIZE(benches); i++)
+		if (scenario == NULL || strcmp(scenario, benches[i].name) == 0)
+			bench_run(&benches[i]);
+
+	return 0;
+}
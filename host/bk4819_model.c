@@ -0,0 +1,604 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <string.h>
+
+#include "driver/bk4819-regs.h"
+#include "driver/gpio.h"
+#include "host/hal.h"
+
+// BK4819 model, unit 0 is driven from the pins of the firmware's own bit-banged bus code,
+// unit 1 is a second chip at the far end of a virtual RF link that the bench talks to directly
+//
+// frames are SCN low, 8 bits of register (bit 7 set for a read) then 16 data bits, MSB
+// first, the chip samples SDA on the rising edge of SCL and latches a write when SCN goes
+// high again. On a read the chip drives SDA with the next bit while SCL is low.
+//
+// it's a register file .. reads give back what was last written, apart from the read only
+// status/measurement registers which give fixed "quiet band" values, and the FSK modem:
+//
+//   REG_5F      TX FIFO (128 words) on a write, RX FIFO (8 words) on a read
+//   REG_5E      <9:3> TX almost empty, <2:0> RX almost full FIFO thresholds
+//   REG_59      FIFO clears, TX/RX enables, preamble/sync length, scramble/invert
+//   REG_5D      packet length in bytes - 1
+//   REG_3F      interrupt enables, only enabled flags are raised
+//   REG_0C <0>  interrupt request, set while any flag is pending
+//   REG_02      writing it moves the pending flags into what a read gives back, clearing them
+//   REG_0B <4>  FSK RX CRC fail (that's how the firmware reads it)
+//
+// air time runs off the virtual clock .. [preamble][sync] then one payload word every 16 bit
+// times then the CRC, at 1200 or 2400 bps depending on REG_58/REG_72. A receiving unit on the
+// same frequency with the same modem/sync/scramble/invert settings syncs after the sync bytes
+// and gets each word as it comes off the air.
+
+HOST_bk4819_stats_t     g_host_bk4819_stats;
+HOST_bk4819_fsk_stats_t g_host_bk4819_fsk_stats[HOST_BK4819_UNITS];
+
+HOST_bk4819_log_t g_host_bk4819_log[HOST_BK4819_LOG_SIZE];
+uint32_t          g_host_bk4819_log_count;
+
+#define TX_FIFO_WORDS   128u
+#define RX_FIFO_WORDS   8u
+
+enum {
+	TX_PHASE_SYNC = 0,           // end of the preamble + sync bytes
+	TX_PHASE_WORD,               // end of a payload word
+	TX_PHASE_END                 // end of the CRC
+};
+
+typedef struct {
+	uint16_t regs[128];
+	uint16_t reg_0b;             // status bits we drive
+	uint16_t irq;                // pending interrupt flags
+	uint16_t irq_latched;        // what REG_02 reads back
+	uint32_t bit_rate;           // forced bit rate, 0 = from the registers
+
+	uint16_t tx_fifo[TX_FIFO_WORDS];
+	uint8_t  tx_rd;
+	uint8_t  tx_level;
+
+	uint16_t rx_fifo[RX_FIFO_WORDS];
+	uint8_t  rx_rd;
+	uint8_t  rx_level;
+
+	struct {                     // the packet going out
+		bool     active;
+		uint8_t  phase;          // what the next event is
+		uint64_t start_us;
+		uint64_t next_us;        // time of the next event
+		uint32_t bps;
+		uint32_t bits;           // air time up to the next event
+		uint16_t len_words;
+		uint16_t sent;           // payload words gone out
+	} tx;
+
+	struct {                     // the packet coming in
+		bool     synced;
+		uint8_t  from;           // transmitting unit
+		uint16_t words;          // payload words received
+		bool     errors;         // bit errors in this packet
+	} rx;
+} bk4819_t;
+
+static bk4819_t bk4819[HOST_BK4819_UNITS];
+
+static struct {
+	uint8_t  scn;
+	uint8_t  scl;
+	uint8_t  sda;          // driven by the MCU
+	uint8_t  bits;         // clocked in this frame
+	bool     reading;
+	uint8_t  read_bit;
+	uint16_t read_value;
+	uint32_t shift;
+} bus = {1, 1, 1, 0, false, 0, 0, 0};
+
+static uint16_t rssi = 0x0060;   // about -130dBm
+
+static uint32_t bit_error_one_in;   // 0 = a clean link
+static uint32_t bit_error_seed = 1;
+
+void HOST_bk4819_set_rssi(const uint16_t value)
+{
+	rssi = value;
+}
+
+uint16_t HOST_bk4819_peek(const unsigned int reg)
+{
+	return bk4819[0].regs[reg & 0x7Fu];
+}
+
+void HOST_bk4819_set_bit_rate(const unsigned int unit, const uint32_t bps)
+{
+	bk4819[unit].bit_rate = bps;
+}
+
+void HOST_bk4819_set_bit_errors(const uint32_t one_in)
+{
+	bit_error_one_in = one_in;
+	bit_error_seed   = 1;
+}
+
+static void BK4819_model_log(const unsigned int unit, const unsigned int reg, const uint16_t value)
+{
+	if (g_host_bk4819_log_count < HOST_BK4819_LOG_SIZE)
+	{
+		HOST_bk4819_log_t *p = &g_host_bk4819_log[g_host_bk4819_log_count];
+		p->time_us = g_host_time_us;
+		p->unit    = unit;
+		p->reg     = reg;
+		p->value   = value;
+	}
+	g_host_bk4819_log_count++;
+}
+
+static void BK4819_model_reset(bk4819_t *p)
+{
+	const uint32_t bit_rate = p->bit_rate;
+
+	memset(p, 0, sizeof(*p));
+
+	p->bit_rate   = bit_rate;
+	p->regs[0x5A] = 0x85CF;      // default sync bytes
+	p->regs[0x5B] = 0xAB45;
+	p->regs[0x5E] = (64u << BK4819_REG_5E_SHIFT_FSK_TX_FIFO_THRESHOLD) | (4u << BK4819_REG_5E_SHIFT_FSK_RX_FIFO_THRESHOLD);
+}
+
+void HOST_bk4819_init(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < HOST_BK4819_UNITS; i++)
+	{
+		bk4819[i].bit_rate = 0;
+		BK4819_model_reset(&bk4819[i]);
+	}
+
+	memset(g_host_bk4819_fsk_stats, 0, sizeof(g_host_bk4819_fsk_stats));
+	g_host_bk4819_log_count = 0;
+}
+
+static void BK4819_model_irq(bk4819_t *p, const uint16_t flag)
+{
+	if (p->regs[BK4819_REG_3F] & flag)
+		p->irq |= flag;
+}
+
+// ****************************
+// FSK
+
+static bool BK4819_model_fsk_enabled(const bk4819_t *p)
+{
+	return (p->regs[BK4819_REG_58] & BK4819_REG_58_MASK_FSK_ENABLE) ? true : false;
+}
+
+static uint32_t BK4819_model_bps(const bk4819_t *p, const bool tx)
+{	// same split as BK4819_FskEnterMode() .. the plain FSK modes take their rate from the tone 2 frequency
+	const unsigned int mode = tx ?
+		(p->regs[BK4819_REG_58] & BK4819_REG_58_MASK_FSK_TX_MODE) >> BK4819_REG_58_SHIFT_FSK_TX_MODE :
+		(p->regs[BK4819_REG_58] & BK4819_REG_58_MASK_FSK_RX_MODE) >> BK4819_REG_58_SHIFT_FSK_RX_MODE;
+
+	if (p->bit_rate > 0)
+		return p->bit_rate;
+
+	if (mode == 0)
+		return (p->regs[BK4819_REG_72] < 18584u) ? 1200 : 2400;   // 18584 = 1800Hz
+
+	return (mode == (tx ? 1u : 7u)) ? 1200 : 2400;                   // FFSK 1200/1800 or FFSK 1200/2400
+}
+
+static uint16_t BK4819_model_fsk_len_words(const bk4819_t *p)
+{
+	const uint16_t reg  = p->regs[BK4819_REG_5D];
+	const uint16_t size = ((reg & BK4819_REG_5D_MASK_FSK_DATA_LENGTH_LOW) >> BK4819_REG_5D_SHIFT_FSK_DATA_LENGTH_LOW) |
+		(((reg & BK4819_REG_5D_MASK_FSK_DATA_LENGTH_HIGH) >> BK4819_REG_5D_SHIFT_FSK_DATA_LENGTH_HIGH) << 8);
+	return (size + 2u) / 2u;
+}
+
+static bool BK4819_model_can_hear(const bk4819_t *rx, const bk4819_t *tx)
+{	// same channel, same modem, and the sync word comes out the same at both ends
+	const uint16_t mask = BK4819_REG_59_MASK_FSK_SCRAMBLE | BK4819_REG_59_MASK_FSK_SYNC_LENGTH;
+	const bool     rx_invert = (rx->regs[BK4819_REG_59] & BK4819_REG_59_MASK_FSK_INVERT_WHEN_RX) ? true : false;
+	const bool     tx_invert = (tx->regs[BK4819_REG_59] & BK4819_REG_59_MASK_FSK_INVERT_WHEN_TX) ? true : false;
+
+	if (!BK4819_model_fsk_enabled(rx) || (rx->regs[BK4819_REG_59] & BK4819_REG_59_MASK_FSK_ENABLE_RX) == 0 || rx->tx.active)
+		return false;
+
+	return
+		rx->regs[BK4819_REG_38] == tx->regs[BK4819_REG_38] &&
+		rx->regs[BK4819_REG_39] == tx->regs[BK4819_REG_39] &&
+		BK4819_model_bps(rx, false) == tx->tx.bps &&
+		rx->regs[BK4819_REG_5A] == tx->regs[BK4819_REG_5A] &&
+		rx->regs[BK4819_REG_5B] == tx->regs[BK4819_REG_5B] &&
+		(rx->regs[BK4819_REG_59] & mask) == (tx->regs[BK4819_REG_59] & mask) &&
+		rx_invert == tx_invert;
+}
+
+static uint16_t BK4819_model_air_errors(uint16_t word, const uint32_t bps, bool *p_errors)
+{	// flip each bit with a 1 in 'bit_error_one_in' chance at 2400bps, same sequence every run .. at 1200bps
+	// each bit has twice the energy, for non-coherent FSK that makes the chance 2 x p^2
+	uint64_t     one_in = bit_error_one_in;
+	unsigned int i;
+
+	if (one_in == 0)
+		return word;
+
+	if (bps < 2400)
+	{
+		one_in = ((one_in * one_in) + 1) / 2;
+		if (one_in > 0xFFFFFFFFu)
+			one_in = 0xFFFFFFFFu;
+	}
+
+	for (i = 0; i < 16; i++)
+	{
+		bit_error_seed = (bit_error_seed * 1103515245u) + 12345u;
+		if (((bit_error_seed >> 8) % one_in) == 0)
+		{
+			word     ^= 1u << i;
+			*p_errors = true;
+		}
+	}
+
+	return word;
+}
+
+static void BK4819_model_rx_word(const unsigned int unit, uint16_t word)
+{
+	bk4819_t          *p         = &bk4819[unit];
+	const unsigned int threshold = (p->regs[BK4819_REG_5E] & BK4819_REG_5E_MASK_FSK_RX_FIFO_THRESHOLD) >> BK4819_REG_5E_SHIFT_FSK_RX_FIFO_THRESHOLD;
+
+	if (p->rx.words >= BK4819_model_fsk_len_words(p))
+		return;                  // longer than we were told to expect
+
+	word = BK4819_model_air_errors(word, bk4819[p->rx.from].tx.bps, &p->rx.errors);
+	p->rx.words++;
+	g_host_bk4819_fsk_stats[unit].rx_words++;
+
+	if (p->rx_level >= RX_FIFO_WORDS)
+	{	// the MCU didn't keep up
+		g_host_bk4819_fsk_stats[unit].rx_overruns++;
+		return;
+	}
+
+	p->rx_fifo[(p->rx_rd + p->rx_level) % RX_FIFO_WORDS] = word;
+	if (++p->rx_level == threshold)
+		BK4819_model_irq(p, BK4819_REG_02_FSK_FIFO_ALMOST_FULL);
+}
+
+static void BK4819_model_tx_schedule(bk4819_t *p, const uint32_t bits)
+{
+	p->tx.bits   += bits;
+	p->tx.next_us = p->tx.start_us + ((((uint64_t)p->tx.bits * 1000000u) + p->tx.bps - 1) / p->tx.bps);
+}
+
+static void BK4819_model_tx_start(const unsigned int unit)
+{
+	bk4819_t      *p      = &bk4819[unit];
+	const uint16_t reg59  = p->regs[BK4819_REG_59];
+	const uint32_t header = ((reg59 & BK4819_REG_59_MASK_FSK_PREAMBLE_LENGTH) >> BK4819_REG_59_SHIFT_FSK_PREAMBLE_LENGTH) + 1u +
+		((reg59 & BK4819_REG_59_MASK_FSK_SYNC_LENGTH) ? 4u : 2u);
+
+	if (p->tx.active || !BK4819_model_fsk_enabled(p))
+		return;
+
+	p->tx.active    = true;
+	p->tx.phase     = TX_PHASE_SYNC;
+	p->tx.start_us  = g_host_time_us;
+	p->tx.bps       = BK4819_model_bps(p, true);
+	p->tx.bits      = 0;
+	p->tx.len_words = BK4819_model_fsk_len_words(p);
+	p->tx.sent      = 0;
+
+	BK4819_model_tx_schedule(p, header * 8u);
+}
+
+static void BK4819_model_tx_abort(const unsigned int unit)
+{
+	unsigned int i;
+
+	bk4819[unit].tx.active = false;
+
+	for (i = 0; i < HOST_BK4819_UNITS; i++)
+		if (bk4819[i].rx.synced && bk4819[i].rx.from == unit)
+			bk4819[i].rx.synced = false;     // the receivers never see the end of it
+}
+
+static void BK4819_model_tx_event(const unsigned int unit)
+{
+	bk4819_t    *p = &bk4819[unit];
+	unsigned int i;
+
+	switch (p->tx.phase)
+	{
+		case TX_PHASE_SYNC:
+			for (i = 0; i < HOST_BK4819_UNITS; i++)
+			{
+				bk4819_t *rx = &bk4819[i];
+				if (i != unit && !rx->rx.synced && BK4819_model_can_hear(rx, p))
+				{
+					rx->rx.synced = true;
+					rx->rx.from   = unit;
+					rx->rx.words  = 0;
+					rx->rx.errors = false;
+					BK4819_model_irq(rx, BK4819_REG_02_FSK_RX_SYNC);
+				}
+			}
+			p->tx.phase = TX_PHASE_WORD;
+			BK4819_model_tx_schedule(p, 16);
+			break;
+
+		case TX_PHASE_WORD:
+		{
+			const unsigned int threshold = (p->regs[BK4819_REG_5E] & BK4819_REG_5E_MASK_FSK_TX_FIFO_THRESHOLD) >> BK4819_REG_5E_SHIFT_FSK_TX_FIFO_THRESHOLD;
+			uint16_t           word      = 0;
+
+			if (p->tx_level == 0)
+			{	// the MCU didn't keep up, the chip sends whatever
+				g_host_bk4819_fsk_stats[unit].tx_underruns++;
+			}
+			else
+			{
+				word     = p->tx_fifo[p->tx_rd];
+				p->tx_rd = (p->tx_rd + 1) % TX_FIFO_WORDS;
+				if (--p->tx_level == threshold)
+					BK4819_model_irq(p, BK4819_REG_02_FSK_FIFO_ALMOST_EMPTY);
+			}
+
+			g_host_bk4819_fsk_stats[unit].tx_words++;
+
+			for (i = 0; i < HOST_BK4819_UNITS; i++)
+				if (bk4819[i].rx.synced && bk4819[i].rx.from == unit)
+					BK4819_model_rx_word(i, word);
+
+			if (++p->tx.sent < p->tx.len_words)
+			{
+				BK4819_model_tx_schedule(p, 16);
+			}
+			else
+			{
+				p->tx.phase = TX_PHASE_END;
+				BK4819_model_tx_schedule(p, (p->regs[BK4819_REG_5C] & BK4819_REG_5C_MASK_FSK_CRC) ? 16 : 0);
+			}
+			break;
+		}
+
+		case TX_PHASE_END:
+			p->tx.active = false;
+			g_host_bk4819_fsk_stats[unit].tx_packets++;
+			BK4819_model_irq(p, BK4819_REG_02_FSK_TX_FINISHED);
+
+			for (i = 0; i < HOST_BK4819_UNITS; i++)
+			{
+				bk4819_t *rx = &bk4819[i];
+				if (rx->rx.synced && rx->rx.from == unit)
+				{	// the CRC can only come out right if all of it arrived unharmed
+					const bool crc = (rx->regs[BK4819_REG_5C] & BK4819_REG_5C_MASK_FSK_CRC) ? true : false;
+					const bool bad = crc && (rx->rx.errors || rx->rx.words != p->tx.len_words || (p->regs[BK4819_REG_5C] & BK4819_REG_5C_MASK_FSK_CRC) == 0);
+
+					rx->rx.synced = false;
+					rx->reg_0b    = bad ? (rx->reg_0b | (1u << 4)) : (rx->reg_0b & ~(1u << 4));
+
+					g_host_bk4819_fsk_stats[i].rx_packets++;
+					if (bad)
+						g_host_bk4819_fsk_stats[i].rx_crc_errors++;
+
+					BK4819_model_irq(rx, BK4819_REG_02_FSK_RX_FINISHED);
+				}
+			}
+			break;
+	}
+}
+
+void HOST_bk4819_run(const uint64_t now_us)
+{	// play out the air time up to 'now', oldest event first so the units see the link in order
+	for (;;)
+	{
+		unsigned int unit = HOST_BK4819_UNITS;
+		unsigned int i;
+
+		for (i = 0; i < HOST_BK4819_UNITS; i++)
+			if (bk4819[i].tx.active && bk4819[i].tx.next_us <= now_us)
+				if (unit == HOST_BK4819_UNITS || bk4819[i].tx.next_us < bk4819[unit].tx.next_us)
+					unit = i;
+
+		if (unit == HOST_BK4819_UNITS)
+			break;
+
+		BK4819_model_tx_event(unit);
+	}
+}
+
+// ****************************
+// registers
+
+static uint16_t BK4819_model_read(const unsigned int unit, const unsigned int reg)
+{
+	bk4819_t *p = &bk4819[unit];
+	uint16_t  value;
+
+	switch (reg)
+	{
+		case BK4819_REG_0C:       // interrupt request, no CTCSS/CDCSS/DTMF
+			value = (p->irq != 0) ? 1u : 0u;
+			break;
+		case BK4819_REG_02:
+			value = p->irq_latched;
+			break;
+		case BK4819_REG_0B:
+			value = p->reg_0b;
+			break;
+		case BK4819_REG_0D:
+		case BK4819_REG_0E:
+			value = 0;
+			break;
+		case BK4819_REG_5F:       // RX FIFO
+			value = 0;
+			if (p->rx_level > 0)
+			{
+				value    = p->rx_fifo[p->rx_rd];
+				p->rx_rd = (p->rx_rd + 1) % RX_FIFO_WORDS;
+				p->rx_level--;
+			}
+			break;
+		case BK4819_REG_63:       // AF TX/RX input amplitude
+			value = 0x0010;
+			break;
+		case BK4819_REG_65:       // glitch
+			value = 0x0030;
+			break;
+		case BK4819_REG_67:
+			value = (unit == 0) ? rssi : 0x0060;
+			break;
+		default:
+			value = p->regs[reg];
+			break;
+	}
+
+	BK4819_model_log(unit, reg | 0x80u, value);
+
+	return value;
+}
+
+static void BK4819_model_write(const unsigned int unit, const unsigned int reg, const uint16_t value)
+{
+	bk4819_t *p = &bk4819[unit];
+
+	BK4819_model_log(unit, reg, value);
+
+	switch (reg)
+	{
+		case BK4819_REG_00:
+			if (value & 0x8000u)
+			{	// soft reset
+				BK4819_model_tx_abort(unit);
+				BK4819_model_reset(p);
+			}
+			break;
+
+		case BK4819_REG_02:
+			p->irq_latched = p->irq;
+			p->irq         = 0;
+			break;
+
+		case BK4819_REG_59:
+			if (value & BK4819_REG_59_MASK_FSK_CLEAR_TX_FIFO)
+				p->tx_level = 0;
+			if (value & BK4819_REG_59_MASK_FSK_CLEAR_RX_FIFO)
+				p->rx_level = 0;
+			if ((value & BK4819_REG_59_MASK_FSK_ENABLE_RX) == 0)
+				p->rx.synced = false;
+			if ((value & BK4819_REG_59_MASK_FSK_ENABLE_TX) == 0)
+			{
+				if (p->tx.active)
+					BK4819_model_tx_abort(unit);
+			}
+			else
+			if ((p->regs[BK4819_REG_59] & BK4819_REG_59_MASK_FSK_ENABLE_TX) == 0)
+			{
+				p->regs[reg] = value;
+				BK4819_model_tx_start(unit);
+			}
+			break;
+
+		case BK4819_REG_5F:       // TX FIFO
+			if (p->tx_level >= TX_FIFO_WORDS)
+			{
+				g_host_bk4819_fsk_stats[unit].tx_fifo_overflows++;
+				return;
+			}
+			p->tx_fifo[(p->tx_rd + p->tx_level) % TX_FIFO_WORDS] = value;
+			p->tx_level++;
+			break;
+	}
+
+	p->regs[reg] = value;
+}
+
+uint16_t HOST_bk4819_read(const unsigned int unit, const unsigned int reg)
+{
+	HOST_bk4819_run(g_host_time_us);
+	return BK4819_model_read(unit, reg & 0x7Fu);
+}
+
+void HOST_bk4819_write(const unsigned int unit, const unsigned int reg, const uint16_t value)
+{
+	HOST_bk4819_run(g_host_time_us);
+	BK4819_model_write(unit, reg & 0x7Fu, value);
+}
+
+// ****************************
+// unit 0's bus pins
+
+void HOST_bk4819_pin(const unsigned int pin, const unsigned int level)
+{
+	switch (pin)
+	{
+		case GPIOC_PIN_BK4819_SCN:
+			if (bus.scn && !level)
+			{	// start of a frame
+				bus.bits    = 0;
+				bus.shift   = 0;
+				bus.reading = false;
+				HOST_bk4819_run(g_host_time_us);
+			}
+			else
+			if (!bus.scn && level)
+			{	// end of a frame
+				if (!bus.reading && bus.bits == 24)
+				{
+					BK4819_model_write(0, (bus.shift >> 16) & 0x7Fu, bus.shift & 0xFFFFu);
+					g_host_bk4819_stats.writes++;
+				}
+			}
+			bus.scn = level;
+			break;
+
+		case GPIOC_PIN_BK4819_SCL:
+			if (!bus.scl && level && !bus.scn)
+			{	// rising edge inside a frame
+				g_host_bk4819_stats.bits++;
+				if (bus.reading)
+				{
+					bus.read_bit++;
+				}
+				else
+				{
+					bus.shift = (bus.shift << 1) | bus.sda;
+					if (++bus.bits == 8 && (bus.shift & 0x80u))
+					{
+						bus.reading    = true;
+						bus.read_bit   = 0;
+						bus.read_value = BK4819_model_read(0, bus.shift & 0x7Fu);
+						g_host_bk4819_stats.reads++;
+					}
+				}
+			}
+			bus.scl = level;
+			break;
+
+		case GPIOC_PIN_BK4819_SDA:
+			bus.sda = level;
+			break;
+	}
+}
+
+unsigned int HOST_bk4819_sda(void)
+{
+	if (bus.reading && bus.read_bit < 16)
+		return (bus.read_value >> (15 - bus.read_bit)) & 1u;
+	return 1;     // pulled up
+}
@@ -0,0 +1,69 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <string.h>
+
+#include "driver/eeprom.h"
+#include "host/hal.h"
+
+// RAM backed stand-in for driver/eeprom.c, the BL24C64 is 8kB
+
+uint8_t              g_host_eeprom[HOST_EEPROM_SIZE];
+EEPROM_write_stats_t g_eeprom_write_stats;
+
+void EEPROM_ReadBuffer(const uint16_t address, void *p_buffer, const unsigned int size)
+{
+	unsigned int i;
+	uint8_t     *p = (uint8_t *)p_buffer;
+
+	for (i = 0; i < size; i++)
+		p[i] = g_host_eeprom[(address + i) % HOST_EEPROM_SIZE];
+}
+
+void EEPROM_WriteBuffer8(const uint16_t address, const void *p_buffer)
+{
+	if (p_buffer == NULL || (address + 8) > HOST_EEPROM_SIZE)
+		return;
+
+	if (memcmp(&g_host_eeprom[address], p_buffer, 8) == 0)
+	{	// same as what's already there, the firmware doesn't write it either
+		g_eeprom_write_stats.write_skips++;
+		return;
+	}
+
+	memcpy(&g_host_eeprom[address], p_buffer, 8);
+
+	g_eeprom_write_stats.bytes_written += 8;
+	g_eeprom_write_stats.page_writes++;
+}
+
+void EEPROM_StageBegin(const uint16_t address, const unsigned int size)
+{	// nothing to gain, it's all in RAM already
+	(void)address;
+	(void)size;
+}
+
+void EEPROM_StageEnd(void)
+{
+}
+
+void EEPROM_FlushStep(void)
+{
+}
+
+void EEPROM_Flush(void)
+{
+}
@@ -0,0 +1,295 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "ARMCM0.h"
+#include "bsp/dp32g030/gpio.h"
+#include "driver/adc.h"
+#include "driver/crc.h"
+#include "driver/gpio.h"
+#include "driver/systick.h"
+#include "driver/uart.h"
+#ifdef ENABLE_FMRADIO
+	#include "driver/bk1080.h"
+#endif
+#include "host/hal.h"
+#include "misc.h"
+
+void SystickHandler(void);
+
+uint64_t g_host_time_us;
+uint64_t g_host_delay_us;
+
+// ****************************
+// the firmware pokes its peripherals through fixed addresses, give it some memory there
+
+static const struct {
+	uintptr_t address;
+	size_t    size;
+} host_regions[] = {
+	{0x40000000u, 0x00100000u},   // APB peripherals
+	{0xE000E000u, 0x00001000u}    // system control space (SysTick)
+};
+
+static void HOST_map_peripherals(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < sizeof(host_regions) / sizeof(host_regions[0]); i++)
+	{
+		void *p = mmap((void *)host_regions[i].address, host_regions[i].size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+		if (p != (void *)host_regions[i].address)
+		{
+			fprintf(stderr, "host: can't map the peripheral space at %08lX\n", (unsigned long)host_regions[i].address);
+			exit(1);
+		}
+	}
+}
+
+void HOST_init(void)
+{
+	HOST_map_peripherals();
+
+	g_host_time_us  = 0;
+	g_host_delay_us = 0;
+
+	HOST_bk4819_init();
+
+	HOST_set_ptt(false);
+}
+
+void HOST_reset(void)
+{
+	printf("host: firmware asked for a reset\n");
+	exit(0);
+}
+
+void HOST_set_ptt(const bool pressed)
+{	// active low
+	if (pressed)
+		GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_PTT);
+	else
+		GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_PTT);
+}
+
+// ****************************
+// virtual clock .. SysTick counts down from LOAD at 48MHz, SystickHandler() every 10ms
+
+#define HOST_TICK_US  10000u
+
+void HOST_advance_us(const uint32_t us)
+{
+	const uint64_t end = g_host_time_us + us;
+
+	while (g_host_time_us < end)
+	{
+		const uint64_t next_tick = ((g_host_time_us / HOST_TICK_US) + 1) * HOST_TICK_US;
+
+		if (next_tick > end)
+		{
+			g_host_time_us = end;
+			break;
+		}
+
+		g_host_time_us = next_tick;
+		HOST_bk4819_run(g_host_time_us);
+		if (SysTick->CTRL & 1u)
+			SystickHandler();
+	}
+
+	HOST_bk4819_run(g_host_time_us);
+
+	SysTick->VAL = SysTick->LOAD - (uint32_t)((g_host_time_us % HOST_TICK_US) * 48u);
+}
+
+void HOST_next_tick(void)
+{
+	HOST_advance_us(HOST_TICK_US - (uint32_t)(g_host_time_us % HOST_TICK_US));
+}
+
+void SYSTICK_Init(void)
+{
+	SysTick->LOAD = 480000 - 1;
+	SysTick->VAL  = SysTick->LOAD;
+	SysTick->CTRL = 7u;    // enable + interrupt + core clock
+}
+
+void SYSTICK_DelayUs(uint32_t Delay)
+{
+	g_host_delay_us += Delay;
+	HOST_advance_us(Delay);
+}
+
+// ****************************
+// peripherals nobody needs a model of (yet)
+
+void ADC_Configure(ADC_Config_t *pAdc)
+{
+	(void)pAdc;
+}
+
+void ADC_Enable(void)
+{
+}
+
+void ADC_SoftReset(void)
+{
+}
+
+void ADC_Start(void)
+{
+}
+
+bool ADC_CheckEndOfConversion(ADC_CH_MASK Mask)
+{
+	(void)Mask;
+	return true;
+}
+
+uint16_t ADC_GetValue(ADC_CH_MASK Mask)
+{	// battery about 7.8V, no charging current
+	return (Mask == ADC_CH4) ? 2150 : 0;
+}
+
+void CRC_Init(void)
+{
+}
+
+static uint16_t host_crc;
+
+void CRC_Begin(void)
+{
+	host_crc = 0;
+}
+
+static void HOST_crc_byte(const uint8_t data)
+{	// CRC-16/XMODEM, same as the hardware unit is set up for
+	unsigned int i;
+	host_crc ^= (uint16_t)data << 8;
+	for (i = 0; i < 8; i++)
+		host_crc = (host_crc & 0x8000u) ? (uint16_t)((host_crc << 1) ^ 0x1021u) : (uint16_t)(host_crc << 1);
+}
+
+uint16_t CRC_End(void)
+{
+	return host_crc;
+}
+
+uint16_t CRC_Calculate(const void *pBuffer, uint16_t Size)
+{
+	const uint8_t *pData = (const uint8_t *)pBuffer;
+	CRC_Begin();
+	while (Size-- > 0)
+		HOST_crc_byte(*pData++);
+	return CRC_End();
+}
+
+// UART1 .. the firmware's 512 byte TX ring (ENABLE_UART_TX_DMA) going out at 38400 baud, 10 bits a byte
+
+#define HOST_UART_RING_BYTES  512u
+#define HOST_UART_BYTE_NS     260417u
+
+static void   (*host_uart_tx)(const uint8_t *data, const uint32_t len);
+static uint64_t host_uart_empty_ns;         // when the ring will have drained
+
+void HOST_uart_set_tx(void (*tx)(const uint8_t *data, const uint32_t len))
+{
+	host_uart_tx       = tx;
+	host_uart_empty_ns = g_host_time_us * 1000u;
+}
+
+uint16_t UART_TxFree(void)
+{
+	const uint64_t now_ns = g_host_time_us * 1000u;
+	uint64_t       used;
+
+	if (host_uart_empty_ns <= now_ns)
+		return HOST_UART_RING_BYTES - 1;
+
+	used = (host_uart_empty_ns - now_ns + HOST_UART_BYTE_NS - 1) / HOST_UART_BYTE_NS;
+	return (used >= (HOST_UART_RING_BYTES - 1)) ? 0 : (uint16_t)((HOST_UART_RING_BYTES - 1) - used);
+}
+
+void UART_Send(const void *pBuffer, uint32_t Size)
+{
+	const uint64_t now_ns = g_host_time_us * 1000u;
+
+	if (host_uart_tx == NULL)
+	{
+		fwrite(pBuffer, 1, Size, stdout);
+		return;
+	}
+
+	if (host_uart_empty_ns < now_ns)
+		host_uart_empty_ns = now_ns;
+	host_uart_empty_ns += (uint64_t)Size * HOST_UART_BYTE_NS;
+
+	host_uart_tx((const uint8_t *)pBuffer, Size);
+}
+
+void UART_SendText(const void *str)
+{
+	if (str != NULL)
+		UART_Send(str, strlen((const char *)str));
+}
+
+void _putchar(char c)
+{
+	UART_Send(&c, 1);
+}
+
+#ifdef ENABLE_FMRADIO
+	uint16_t BK1080_BaseFrequency;
+	uint16_t BK1080_FrequencyDeviation;
+
+	static uint16_t host_bk1080_regs[0x20];
+
+	void BK1080_Init(uint16_t Frequency, bool bDoScan)
+	{
+		(void)bDoScan;
+		if (Frequency != 0)
+			BK1080_SetFrequency(Frequency);
+	}
+
+	uint16_t BK1080_ReadRegister(BK1080_Register_t Register)
+	{
+		return host_bk1080_regs[Register & 0x1Fu];
+	}
+
+	void BK1080_WriteRegister(BK1080_Register_t Register, uint16_t Value)
+	{
+		host_bk1080_regs[Register & 0x1Fu] = Value;
+	}
+
+	void BK1080_Mute(bool Mute)
+	{
+		(void)Mute;
+	}
+
+	void BK1080_SetFrequency(uint16_t Frequency)
+	{
+		BK1080_BaseFrequency = Frequency;
+	}
+
+	void BK1080_GetFrequencyDeviation(uint16_t Frequency)
+	{
+		BK1080_FrequencyDeviation = Frequency - BK1080_BaseFrequency;
+	}
+#endif
@@ -0,0 +1,124 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef HOST_HAL_H
+#define HOST_HAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "driver/keyboard.h"
+
+// host build of the firmware .. the simulated hardware
+//
+// the peripheral register space is plain mapped memory, the parts the application
+// actually talks to (BK4819, EEPROM, LCD, keypad, SysTick) are modelled here instead
+
+// ****************************
+// virtual clock (hal.c)
+
+extern uint64_t g_host_time_us;             // virtual time since power on
+extern uint64_t g_host_delay_us;            // of which spent in SYSTICK_DelayUs() busy waits
+
+void HOST_init(void);
+void HOST_advance_us(const uint32_t us);    // runs SystickHandler() on each 10ms boundary crossed
+void HOST_next_tick(void);                  // advance to the next 10ms boundary
+void HOST_set_ptt(const bool pressed);
+
+// UART1 .. the bytes the firmware sends go to 'tx' as it sends them, paced as if through the TX DMA ring
+// at 38400 baud for UART_TxFree(), NULL = straight to stdout with no pacing
+void HOST_uart_set_tx(void (*tx)(const uint8_t *data, const uint32_t len));
+
+// ****************************
+// BK4819 (bk4819_model.c)
+//
+// unit 0 is the firmware's chip, unit 1 sits at the other end of a virtual RF link and is
+// driven directly with HOST_bk4819_read()/HOST_bk4819_write()
+
+#define HOST_BK4819_UNITS     2
+#define HOST_BK4819_LOG_SIZE  16384
+
+typedef struct {
+	uint32_t reads;
+	uint32_t writes;
+	uint32_t bits;                          // SCL clocks, the bus cost on the real thing
+} HOST_bk4819_stats_t;
+
+typedef struct {
+	uint32_t tx_packets;
+	uint32_t tx_words;
+	uint32_t tx_underruns;                  // words that went out while the TX FIFO was empty
+	uint32_t tx_fifo_overflows;             // words written to a full TX FIFO
+	uint32_t rx_packets;
+	uint32_t rx_words;
+	uint32_t rx_overruns;                   // words lost to a full RX FIFO
+	uint32_t rx_crc_errors;
+} HOST_bk4819_fsk_stats_t;
+
+typedef struct {
+	uint64_t time_us;
+	uint16_t value;
+	uint8_t  unit;
+	uint8_t  reg;                           // bit 7 set for a read, same as on the bus
+} HOST_bk4819_log_t;
+
+extern HOST_bk4819_stats_t     g_host_bk4819_stats;      // unit 0's bus
+extern HOST_bk4819_fsk_stats_t g_host_bk4819_fsk_stats[HOST_BK4819_UNITS];
+
+extern HOST_bk4819_log_t g_host_bk4819_log[HOST_BK4819_LOG_SIZE];   // every register access of both units
+extern uint32_t          g_host_bk4819_log_count;                    // keeps counting once the log is full
+
+void     HOST_bk4819_init(void);
+void     HOST_bk4819_run(const uint64_t now_us);    // play the FSK air time out up to 'now'
+void     HOST_bk4819_pin(const unsigned int pin, const unsigned int level);
+unsigned int HOST_bk4819_sda(void);
+uint16_t HOST_bk4819_read(const unsigned int unit, const unsigned int reg);
+void     HOST_bk4819_write(const unsigned int unit, const unsigned int reg, const uint16_t value);
+uint16_t HOST_bk4819_peek(const unsigned int reg);
+void     HOST_bk4819_set_rssi(const uint16_t rssi);
+void     HOST_bk4819_set_bit_rate(const unsigned int unit, const uint32_t bps);   // 0 = from REG_58/REG_72
+void     HOST_bk4819_set_bit_errors(const uint32_t one_in);                        // at 2400bps, 0 = a clean link
+
+// ****************************
+// EEPROM (eeprom.c)
+
+#define HOST_EEPROM_SIZE  0x2000
+
+extern uint8_t g_host_eeprom[HOST_EEPROM_SIZE];
+
+// ****************************
+// LCD (st7565.c)
+
+typedef struct {
+	uint32_t full_blits;
+	uint32_t status_blits;
+	uint32_t line_draws;
+	uint32_t refreshes;                     // ST7565_Refresh() full re-sends
+	uint32_t bytes;                         // bytes sent to the LCD
+} HOST_lcd_stats_t;
+
+extern HOST_lcd_stats_t g_host_lcd_stats;
+
+uint32_t HOST_lcd_hash(void);               // of what's on the glass, for spotting rendering changes
+void     HOST_lcd_print(void);              // ASCII art of the screen to stdout
+
+// ****************************
+// keypad (keyboard.c)
+
+void HOST_key_press(const key_code_t key);  // held until HOST_key_release()
+void HOST_key_release(void);
+
+#endif
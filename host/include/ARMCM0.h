@@ -0,0 +1,64 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef HOST_ARMCM0_H
+#define HOST_ARMCM0_H
+
+// host build stand-in for the CMSIS device header
+//
+// only the bits the firmware actually uses .. the SysTick registers live in the same
+// mapped memory as the peripherals (see host/hal.c), the interrupt and barrier
+// intrinsics do nothing as there are no interrupts on the host
+
+#include <stdint.h>
+
+typedef enum {
+	NonMaskableInt_IRQn = -14,
+	HardFault_IRQn      = -13,
+	SVCall_IRQn         = -5,
+	PendSV_IRQn         = -2,
+	SysTick_IRQn        = -1
+} IRQn_Type;
+
+typedef struct {
+	volatile uint32_t CTRL;
+	volatile uint32_t LOAD;
+	volatile uint32_t VAL;
+	volatile uint32_t CALIB;
+} SysTick_Type;
+
+#define SysTick_BASE            0xE000E010UL
+#define SysTick                 ((SysTick_Type *)SysTick_BASE)
+
+#define SysTick_LOAD_RELOAD_Msk 0x00FFFFFFUL
+
+#define __NOP()                 do {} while (0)
+#define __DSB()                 do {} while (0)
+#define __ISB()                 do {} while (0)
+#define __WFI()                 do {} while (0)
+
+static inline void     __disable_irq(void)              {}
+static inline void     __enable_irq(void)               {}
+static inline uint32_t __get_PRIMASK(void)              { return 0; }
+static inline void     __set_PRIMASK(uint32_t primask)  { (void)primask; }
+
+static inline void     NVIC_EnableIRQ(IRQn_Type IRQn)   { (void)IRQn; }
+static inline void     NVIC_DisableIRQ(IRQn_Type IRQn)  { (void)IRQn; }
+
+void                   HOST_reset(void);
+#define NVIC_SystemReset()  HOST_reset()
+
+#endif
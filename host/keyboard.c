@@ -0,0 +1,49 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include "driver/keyboard.h"
+#include "host/hal.h"
+
+// stand-in for driver/keyboard.c, the key is whatever the bench says is held down
+
+uint8_t    g_ptt_debounce;
+uint8_t    g_key_debounce_press;
+uint8_t    g_key_debounce_repeat;
+key_code_t g_key_prev = KEY_INVALID;
+bool       g_key_held;
+bool       g_fkey_pressed;
+bool       g_ptt_is_pressed;
+
+bool       g_ptt_was_released;
+bool       g_ptt_was_pressed;
+uint8_t    g_keypad_locked;
+
+static key_code_t key_down = KEY_INVALID;
+
+void HOST_key_press(const key_code_t key)
+{
+	key_down = key;
+}
+
+void HOST_key_release(void)
+{
+	key_down = KEY_INVALID;
+}
+
+key_code_t KEYBOARD_Poll(void)
+{
+	return key_down;
+}
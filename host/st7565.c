@@ -0,0 +1,150 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "driver/st7565.h"
+#include "host/hal.h"
+
+// stand-in for driver/st7565.c, keeps a copy of what would be on the glass
+
+uint8_t          g_status_line[128];
+uint8_t          g_frame_buffer[7][128];
+
+HOST_lcd_stats_t g_host_lcd_stats;
+
+static uint8_t   lcd_glass[8][LCD_WIDTH];     // page 0 is the status line
+
+#ifdef ENABLE_CONTRAST
+	static uint8_t contrast = 31;
+#endif
+
+void ST7565_DrawLine(const unsigned int Column, const unsigned int Line, const unsigned int Size, const uint8_t *pBitmap)
+{
+	unsigned int i;
+
+	g_host_lcd_stats.line_draws++;
+	g_host_lcd_stats.bytes += Size;
+
+	for (i = 0; i < Size && (Column + i) < LCD_WIDTH && Line < 8; i++)
+		lcd_glass[Line][Column + i] = (pBitmap != NULL) ? pBitmap[i] : 0;
+}
+
+static void ST7565_BlitPage(const unsigned int page, const uint8_t *p_src)
+{	// same as the driver .. only the column span that differs goes out
+	unsigned int first = 0;
+	unsigned int last  = LCD_WIDTH;
+
+	while (first < LCD_WIDTH && p_src[first] == lcd_glass[page][first])
+		first++;
+	if (first >= LCD_WIDTH)
+		return;
+	while (p_src[last - 1] == lcd_glass[page][last - 1])
+		last--;
+
+	g_host_lcd_stats.bytes += 3 + (last - first);    // column/page select + data
+	memcpy(&lcd_glass[page][first], &p_src[first], last - first);
+}
+
+void ST7565_BlitFullScreen(void)
+{
+	unsigned int line;
+
+	g_host_lcd_stats.full_blits++;
+	for (line = 0; line < 7; line++)
+		ST7565_BlitPage(line + 1, g_frame_buffer[line]);
+}
+
+void ST7565_BlitStatusLine(void)
+{
+	g_host_lcd_stats.status_blits++;
+	ST7565_BlitPage(0, g_status_line);
+}
+
+void ST7565_Refresh(void)
+{
+	g_host_lcd_stats.refreshes++;
+	g_host_lcd_stats.bytes += sizeof(lcd_glass) + (8 * 3);
+}
+
+void ST7565_FillScreen(const uint8_t Value)
+{
+	g_host_lcd_stats.bytes += sizeof(lcd_glass);
+	memset(lcd_glass, Value, sizeof(lcd_glass));
+}
+
+void ST7565_Init(const bool full)
+{
+	if (full)
+		ST7565_FillScreen(0x00);
+}
+
+void ST7565_HardwareReset(void)
+{
+}
+
+void ST7565_SelectColumnAndLine(const uint8_t Column, const uint8_t Line)
+{
+	(void)Column;
+	(void)Line;
+}
+
+void ST7565_WriteByte(const uint8_t Value)
+{
+	(void)Value;
+}
+
+#ifdef ENABLE_CONTRAST
+	void ST7565_SetContrast(const uint8_t value)
+	{
+		contrast = (value <= 63) ? value : 63;
+	}
+
+	uint8_t ST7565_GetContrast(void)
+	{
+		return contrast;
+	}
+#endif
+
+uint32_t HOST_lcd_hash(void)
+{	// FNV-1a
+	const uint8_t *p    = &lcd_glass[0][0];
+	uint32_t       hash = 2166136261u;
+	unsigned int   i;
+
+	for (i = 0; i < sizeof(lcd_glass); i++)
+		hash = (hash ^ p[i]) * 16777619u;
+
+	return hash;
+}
+
+void HOST_lcd_print(void)
+{
+	unsigned int y;
+
+	for (y = 0; y < LCD_HEIGHT; y++)
+	{
+		char         line[LCD_WIDTH + 1];
+		unsigned int x;
+
+		for (x = 0; x < LCD_WIDTH; x++)
+			line[x] = ((lcd_glass[y / 8][x] >> (y % 8)) & 1u) ? '#' : ' ';
+		line[LCD_WIDTH] = 0;
+
+		printf("|%s|\n", line);
+	}
+}
@@ -0,0 +1,633 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#include <string.h>
+
+#include "driver/uart.h"
+#include "functions.h"
+#include "kiss_tnc.h"
+#include "misc.h"
+#include "settings.h"
+
+#define KISS_TNC_RECORD_BYTES   4           // [frame length LE][ACKMODE id] in front of each queued frame
+#define KISS_TNC_ACK_WANTED     0x8000u     // in the length, the host wants to hear when it's been sent
+#define KISS_TNC_UART_CHUNK     64          // bytes put in the UART TX ring at a time
+
+// carrier detect .. from a sync word until the packet ends, or the longest frame at the slowest rate if the end is never seen
+#define KISS_TNC_DCD_10ms       ((((FSK_LINK_MAX_AIR_BYTES + 16) * 8) * 100) / 1200)
+
+// KISS spec defaults
+#define KISS_TNC_PERSIST        63
+#define KISS_TNC_SLOT_10ms      10
+
+enum {
+	KISS_IN_IDLE = 0,                       // between frames, the bytes are the programming protocol's
+	KISS_IN_COMMAND,                        // had a FEND, the command byte is next
+	KISS_IN_DATA,
+	KISS_IN_ESCAPE,                         // had a FESC
+	KISS_IN_SKIP                            // not one of ours, or no room for it .. wait for the FEND
+};
+
+typedef struct {
+	uint16_t len;                           // frame bytes, top bit KISS_TNC_ACK_WANTED
+	uint16_t ack;                           // ACKMODE id as it came from the host
+} kiss_tnc_record_t;
+
+// frames kept whole and in order, a frame never wraps round the end of the buffer so the link can send
+// straight out of it .. if there's more room at the start than at the end the next frame goes at the start
+// and the ones after 'head' stop at 'wrap'
+typedef struct {
+	uint16_t *buf;                          // words, the records are halfword aligned
+	uint16_t  size;                         // bytes
+	uint16_t  head;                         // oldest frame
+	uint16_t  tail;                         // where the next one goes
+	uint16_t  wrap;
+	uint16_t  bytes;                        // in use
+	uint8_t   frames;
+	bool      wrapped;
+} kiss_tnc_queue_t;
+
+kiss_tnc_stats_t g_kiss_tnc_stats;
+
+static uint16_t tx_buf[KISS_TNC_TX_QUEUE_BYTES / 2];
+static uint16_t rx_buf[KISS_TNC_RX_QUEUE_BYTES / 2];
+
+static kiss_tnc_queue_t tx_q = {tx_buf, sizeof(tx_buf), 0, 0, 0, 0, 0, false};
+static kiss_tnc_queue_t rx_q = {rx_buf, sizeof(rx_buf), 0, 0, 0, 0, 0, false};
+
+static struct {                             // the frame coming in from the host
+	uint8_t  state;
+	uint8_t  command;
+	uint16_t at;                            // where in the TX queue it's going
+	uint16_t room;                          // most bytes it can be
+	uint16_t len;                           // bytes so far, ACKMODE id included
+	uint8_t  param[5];
+} in;
+
+static struct {                             // the frame going out to the host
+	uint16_t pos;                           // bytes of the oldest RX frame already sent
+	bool     busy;                          // the FEND and command have gone, the rest hasn't
+	uint16_t acks[KISS_TNC_ACKS];
+	uint8_t  ack_count;
+} out;
+
+static struct {
+	bool     open;
+	bool     sending;                       // the oldest TX frame is with the link
+	bool     full_duplex;
+	bool     adaptive;                      // only taken up with a peer, broadcasts always go at the slowest rate
+	uint8_t  address;                       // 0 = from the ANI ID
+	uint8_t  peer;                          // where the frames go, FSK_LINK_BROADCAST for everyone
+	uint8_t  fec_parity;                    // 0 = FEC off
+	uint8_t  fec_depth;
+	uint8_t  persist;                       // P, 0 ~ 255
+	uint8_t  slot_10ms;
+	uint8_t  wait_10ms;                     // to the next persistence draw
+	uint8_t  dcd_10ms;
+	uint16_t last_sync;
+	uint16_t last_packets;
+	uint32_t seed;
+} tnc = {false, false, false, false, 0, FSK_LINK_BROADCAST, 0, 1, KISS_TNC_PERSIST, KISS_TNC_SLOT_10ms, 0, 0, 0, 0, 1};
+
+// ****************************
+
+static kiss_tnc_record_t *KISS_TNC_record(const kiss_tnc_queue_t *q, const uint16_t at)
+{
+	return (kiss_tnc_record_t *)((uint8_t *)q->buf + at);
+}
+
+static uint16_t KISS_TNC_record_bytes(const uint16_t len)
+{	// header, frame and padding out to a word
+	return (KISS_TNC_RECORD_BYTES + len + 1u) & ~1u;
+}
+
+static uint16_t KISS_TNC_q_space(const kiss_tnc_queue_t *q, uint16_t *p_at)
+{	// where the next frame goes and the biggest it can be there
+	uint16_t room;
+
+	if (q->frames == 0)
+	{
+		*p_at = 0;
+		room  = q->size;
+	}
+	else
+	if (q->wrapped)
+	{
+		*p_at = q->tail;
+		room  = q->head - q->tail;
+	}
+	else
+	if ((q->size - q->tail) >= q->head)
+	{
+		*p_at = q->tail;
+		room  = q->size - q->tail;
+	}
+	else
+	{
+		*p_at = 0;
+		room  = q->head;
+	}
+
+	return (room > KISS_TNC_RECORD_BYTES) ? room - KISS_TNC_RECORD_BYTES : 0;
+}
+
+static void KISS_TNC_q_commit(kiss_tnc_queue_t *q, const uint16_t at, const uint16_t len, uint16_t *p_high_water)
+{	// the frame at 'at' is complete, KISS_TNC_q_space() said it could go there
+	const uint16_t bytes = KISS_TNC_record_bytes(len);
+
+	if (q->frames == 0)
+	{
+		q->head    = at;
+		q->wrapped = false;
+	}
+	else
+	if (at != q->tail)
+	{	// gone back to the start
+		q->wrap    = q->tail;
+		q->wrapped = true;
+	}
+
+	q->tail   = at + bytes;
+	q->bytes += bytes;
+	q->frames++;
+
+	if (*p_high_water < q->bytes)
+		*p_high_water = q->bytes;
+}
+
+static void KISS_TNC_q_pop(kiss_tnc_queue_t *q)
+{
+	const uint16_t bytes = KISS_TNC_record_bytes(KISS_TNC_record(q, q->head)->len & ~KISS_TNC_ACK_WANTED);
+
+	q->head  += bytes;
+	q->bytes -= bytes;
+
+	if (--q->frames == 0)
+		q->wrapped = false;
+	else
+	if (q->wrapped && q->head == q->wrap)
+	{
+		q->head    = 0;
+		q->wrapped = false;
+	}
+}
+
+static void KISS_TNC_q_clear(kiss_tnc_queue_t *q, const bool keep_oldest)
+{
+	if (keep_oldest && q->frames > 0)
+	{
+		q->bytes  = KISS_TNC_record_bytes(KISS_TNC_record(q, q->head)->len & ~KISS_TNC_ACK_WANTED);
+		q->tail   = q->head + q->bytes;
+		q->frames = 1;
+	}
+	else
+	{
+		q->head   = 0;
+		q->tail   = 0;
+		q->bytes  = 0;
+		q->frames = 0;
+	}
+
+	q->wrapped = false;
+}
+
+uint8_t KISS_TNC_queued(const bool tx, uint16_t *p_bytes)
+{
+	const kiss_tnc_queue_t *q = tx ? &tx_q : &rx_q;
+
+	if (p_bytes != NULL)
+		*p_bytes = q->bytes;
+
+	return q->frames;
+}
+
+// ****************************
+// air to host
+
+static void KISS_TNC_link_rx(const uint8_t src, const uint8_t dst, const uint8_t *data, const uint16_t len)
+{	// a message off the air, it waits in the RX queue until the UART has room for it
+	kiss_tnc_record_t *rec;
+	uint16_t           at;
+
+	(void)src;
+	(void)dst;
+
+	if (len == 0)
+		return;
+
+	if (KISS_TNC_q_space(&rx_q, &at) < len)
+	{
+		g_kiss_tnc_stats.rx_dropped++;
+		return;
+	}
+
+	rec      = KISS_TNC_record(&rx_q, at);
+	rec->len = len;
+	memcpy((uint8_t *)rec + KISS_TNC_RECORD_BYTES, data, len);
+
+	KISS_TNC_q_commit(&rx_q, at, len, &g_kiss_tnc_stats.rx_high_water);
+}
+
+static unsigned int KISS_TNC_escape(const uint8_t b, uint8_t *p)
+{
+	if (b == KISS_FEND || b == KISS_FESC)
+	{
+		p[0] = KISS_FESC;
+		p[1] = (b == KISS_FEND) ? KISS_TFEND : KISS_TFESC;
+		return 2;
+	}
+
+	p[0] = b;
+	return 1;
+}
+
+static void KISS_TNC_uart_out(void)
+{	// as much as the UART TX ring takes without waiting, acks go between frames
+	uint8_t buf[KISS_TNC_UART_CHUNK];
+
+	while (1)
+	{
+		const kiss_tnc_record_t *rec;
+		const uint8_t           *data;
+		uint16_t                 room = UART_TxFree();
+		unsigned int             n    = 0;
+
+		if (room > sizeof(buf))
+			room = sizeof(buf);
+
+		if (!out.busy)
+		{
+			if (out.ack_count > 0)
+			{
+				const uint16_t ack = out.acks[0];
+
+				if (room < 7)
+					return;
+
+				buf[n++] = KISS_FEND;
+				buf[n++] = KISS_CMD_ACKMODE;
+				n       += KISS_TNC_escape(ack & 0xFFu, &buf[n]);
+				n       += KISS_TNC_escape(ack >> 8, &buf[n]);
+				buf[n++] = KISS_FEND;
+				UART_Send(buf, n);
+
+				memmove(&out.acks[0], &out.acks[1], --out.ack_count * sizeof(out.acks[0]));
+				g_kiss_tnc_stats.acks++;
+				continue;
+			}
+
+			if (rx_q.frames == 0 || room < 4)
+				return;
+
+			buf[n++] = KISS_FEND;
+			buf[n++] = KISS_CMD_DATA;
+			out.busy = true;
+			out.pos  = 0;
+		}
+
+		rec  = KISS_TNC_record(&rx_q, rx_q.head);
+		data = (const uint8_t *)rec + KISS_TNC_RECORD_BYTES;
+
+		while (out.pos < rec->len && (n + 2) <= room)
+			n += KISS_TNC_escape(data[out.pos++], &buf[n]);
+
+		if (out.pos >= rec->len && n < room)
+		{
+			buf[n++] = KISS_FEND;
+			out.busy = false;
+			KISS_TNC_q_pop(&rx_q);
+			g_kiss_tnc_stats.rx_frames++;
+		}
+
+		if (n == 0)
+			return;           // the UART has no room
+
+		UART_Send(buf, n);
+	}
+}
+
+bool KISS_TNC_uart_busy(void)
+{
+	return out.busy;
+}
+
+// ****************************
+// host to air
+
+static uint8_t KISS_TNC_ani_address(void)
+{	// differs from radio to radio without any setting up, never 0 or broadcast
+	unsigned int sum = 0;
+	unsigned int i;
+
+	for (i = 0; i < sizeof(g_eeprom.ani_dtmf_id) && g_eeprom.ani_dtmf_id[i] != 0; i++)
+		sum = (sum * 31u) + (uint8_t)g_eeprom.ani_dtmf_id[i];
+
+	return 1 + (sum % 254u);
+}
+
+static void KISS_TNC_open(void)
+{
+	FSK_LINK_open((tnc.address != 0) ? tnc.address : KISS_TNC_ani_address(),
+		(FSK_MODULATION_TYPE_t)g_setting_fsk_modem_mode, 120, KISS_TNC_link_rx);
+	FSK_LINK_set_adaptive(tnc.adaptive && tnc.peer != FSK_LINK_BROADCAST);
+	#ifdef ENABLE_FSK_FEC
+		if (FSK_LINK_set_fec(tnc.fec_parity, tnc.fec_depth) < 0)
+		{	// sizes the coder can't do, run without
+			tnc.fec_parity = 0;
+			tnc.fec_depth  = 1;
+			FSK_LINK_set_fec(0, 1);
+		}
+	#endif
+
+	tnc.open         = true;
+	tnc.last_sync    = g_fsk_rx_stats.sync_found;
+	tnc.last_packets = g_fsk_rx_stats.packets;
+}
+
+void KISS_TNC_close(void)
+{
+	if (tnc.open)
+		FSK_LINK_close();
+
+	// frames not sent yet are thrown away, one already with the link finishes on its own and its
+	// done callback takes it off the queue
+	KISS_TNC_q_clear(&tx_q, tnc.sending);
+	KISS_TNC_q_clear(&rx_q, false);
+	out.busy      = false;
+	out.ack_count = 0;
+	tnc.open      = false;
+}
+
+bool KISS_TNC_is_open(void)
+{
+	return tnc.open;
+}
+
+static void KISS_TNC_tx_done(const bool ok)
+{
+	const kiss_tnc_record_t *rec = KISS_TNC_record(&tx_q, tx_q.head);
+
+	tnc.sending = false;
+
+	if (ok)
+		g_kiss_tnc_stats.tx_frames++;
+	else
+		g_kiss_tnc_stats.tx_failed++;
+
+	if (rec->len & KISS_TNC_ACK_WANTED)
+	{	// ack it sent or not, the host only wants to know it can send another
+		if (out.ack_count < KISS_TNC_ACKS)
+			out.acks[out.ack_count++] = rec->ack;
+		else
+			g_kiss_tnc_stats.acks_lost++;
+	}
+
+	KISS_TNC_q_pop(&tx_q);
+}
+
+static void KISS_TNC_tx_next(void)
+{	// p-persistent CSMA .. wait for the channel to clear, then each slot send with a chance of (P + 1) / 256
+	const kiss_tnc_record_t *rec;
+
+	if (tnc.sending || tx_q.frames == 0 || FSK_LINK_tx_busy() || g_current_function == FUNCTION_TRANSMIT)
+		return;
+
+	if (!tnc.full_duplex)
+	{
+		if (tnc.dcd_10ms > 0)
+			return;
+
+		if (tnc.wait_10ms > 0)
+		{
+			tnc.wait_10ms--;
+			return;
+		}
+
+		tnc.seed = (tnc.seed * 1103515245u) + 12345u;
+		if (((tnc.seed >> 16) & 0xFFu) > tnc.persist)
+		{
+			tnc.wait_10ms = tnc.slot_10ms;
+			return;
+		}
+	}
+
+	rec = KISS_TNC_record(&tx_q, tx_q.head);
+	if (FSK_LINK_send(tnc.peer, (const uint8_t *)rec + KISS_TNC_RECORD_BYTES, rec->len & ~KISS_TNC_ACK_WANTED, KISS_TNC_tx_done) == 0)
+		tnc.sending = true;
+}
+
+static void KISS_TNC_dcd_10ms(void)
+{	// the channel's busy from a sync word to the end of that packet
+	if (tnc.last_sync != g_fsk_rx_stats.sync_found)
+	{
+		tnc.last_sync = g_fsk_rx_stats.sync_found;
+		tnc.dcd_10ms  = KISS_TNC_DCD_10ms;
+	}
+
+	if (tnc.last_packets != g_fsk_rx_stats.packets)
+	{
+		tnc.last_packets = g_fsk_rx_stats.packets;
+		tnc.dcd_10ms     = 0;
+		tnc.wait_10ms    = tnc.slot_10ms;     // give whoever sent it a slot to carry on or be answered
+	}
+	else
+	if (tnc.dcd_10ms > 0)
+		tnc.dcd_10ms--;
+}
+
+// ****************************
+// frames from the host
+
+static void KISS_TNC_start(const uint8_t command)
+{
+	in.command = command;
+	in.len     = 0;
+	in.state   = KISS_IN_DATA;
+
+	if (command == KISS_CMD_DATA || command == KISS_CMD_ACKMODE)
+	{	// straight into the TX queue, an ACKMODE id lands in the record header
+		in.room = KISS_TNC_q_space(&tx_q, &in.at);
+		if (in.room > FSK_LINK_MAX_MESSAGE_BYTES)
+			in.room = FSK_LINK_MAX_MESSAGE_BYTES;
+		if (command == KISS_CMD_ACKMODE)
+			in.room += 2;
+	}
+}
+
+static void KISS_TNC_put(const uint8_t b)
+{
+	if (in.command == KISS_CMD_DATA || in.command == KISS_CMD_ACKMODE)
+	{
+		if (in.len >= in.room)
+		{	// no room for the rest of it
+			g_kiss_tnc_stats.tx_dropped++;
+			in.state = KISS_IN_SKIP;
+			return;
+		}
+		((uint8_t *)tx_buf)[in.at + ((in.command == KISS_CMD_ACKMODE) ? 2 : KISS_TNC_RECORD_BYTES) + in.len] = b;
+	}
+	else
+	if (in.len < sizeof(in.param))
+		in.param[in.len] = b;
+
+	in.len++;
+}
+
+static void KISS_TNC_end(void)
+{	// the closing FEND
+	if (in.state == KISS_IN_ESCAPE)
+		g_kiss_tnc_stats.uart_bad++;
+
+	if (in.state != KISS_IN_DATA)
+		return;
+
+	switch (in.command)
+	{
+		case KISS_CMD_DATA:
+		case KISS_CMD_ACKMODE:
+		{
+			const uint16_t id  = (in.command == KISS_CMD_ACKMODE) ? 2 : 0;
+			kiss_tnc_record_t *rec;
+
+			if (in.len <= id)
+				return;       // nothing to send
+
+			rec      = KISS_TNC_record(&tx_q, in.at);
+			rec->len = (in.len - id) | ((id > 0) ? KISS_TNC_ACK_WANTED : 0);
+			KISS_TNC_q_commit(&tx_q, in.at, in.len - id, &g_kiss_tnc_stats.tx_high_water);
+			g_kiss_tnc_stats.uart_frames++;
+			break;
+		}
+
+		case KISS_CMD_P:
+			if (in.len > 0)
+				tnc.persist = in.param[0];
+			break;
+
+		case KISS_CMD_SLOTTIME:
+			if (in.len > 0)
+				tnc.slot_10ms = in.param[0];
+			break;
+
+		case KISS_CMD_FULLDUPLEX:
+			if (in.len > 0)
+				tnc.full_duplex = (in.param[0] != 0);
+			break;
+
+		case KISS_CMD_SETHARDWARE:
+			if (in.len > 0)
+				tnc.address = (in.param[0] == FSK_LINK_BROADCAST) ? 0 : in.param[0];
+			if (in.len > 1)
+				tnc.peer = (in.param[1] == 0) ? FSK_LINK_BROADCAST : in.param[1];
+			if (in.len > 2)
+				tnc.adaptive = (in.param[2] != 0);
+			if (in.len > 3)
+				tnc.fec_parity = in.param[3];
+			if (in.len > 4)
+				tnc.fec_depth = (in.param[4] == 0) ? 1 : in.param[4];
+			if (tnc.open)
+				KISS_TNC_open();      // again, with the new settings
+			break;
+
+		case KISS_CMD_RETURN:
+			KISS_TNC_close();
+			return;
+
+		default:                      // TXDELAY, TXtail .. the link keys up and down as it sees fit
+			break;
+	}
+
+	if (!tnc.open)
+		KISS_TNC_open();
+}
+
+bool KISS_TNC_uart_byte(const uint8_t b)
+{
+	uint8_t c = b;
+
+	switch (in.state)
+	{
+		case KISS_IN_IDLE:
+			if (c != KISS_FEND)
+				return false;
+			in.state = KISS_IN_COMMAND;
+			return true;
+
+		case KISS_IN_COMMAND:
+			if (c == KISS_FEND)
+				return true;          // FENDs back to back
+			if (c != KISS_CMD_RETURN && (c & 0x0Fu) > KISS_CMD_SETHARDWARE && (c & 0x0Fu) != KISS_CMD_ACKMODE)
+			{	// not a KISS command, most likely a programming frame after a KISS one
+				in.state = KISS_IN_IDLE;
+				return false;
+			}
+			if (c != KISS_CMD_RETURN && (c >> 4) != 0)
+			{	// we only have the one port
+				g_kiss_tnc_stats.uart_bad++;
+				in.state = KISS_IN_SKIP;
+				return true;
+			}
+			KISS_TNC_start(c);
+			return true;
+
+		default:
+			break;
+	}
+
+	if (c == KISS_FEND)
+	{
+		KISS_TNC_end();
+		in.state = KISS_IN_COMMAND;   // a frame's closing FEND can be the next one's opening FEND too
+		return true;
+	}
+
+	if (in.state == KISS_IN_SKIP)
+		return true;
+
+	if (in.state == KISS_IN_ESCAPE)
+	{
+		if (c != KISS_TFEND && c != KISS_TFESC)
+		{
+			g_kiss_tnc_stats.uart_bad++;
+			in.state = KISS_IN_SKIP;
+			return true;
+		}
+		c        = (c == KISS_TFEND) ? KISS_FEND : KISS_FESC;
+		in.state = KISS_IN_DATA;
+	}
+	else
+	if (c == KISS_FESC)
+	{
+		in.state = KISS_IN_ESCAPE;
+		return true;
+	}
+
+	KISS_TNC_put(c);
+	return true;
+}
+
+// ****************************
+
+void KISS_TNC_process_10ms(void)
+{
+	if (!tnc.open)
+		return;
+
+	KISS_TNC_dcd_10ms();
+	KISS_TNC_tx_next();
+	KISS_TNC_uart_out();
+}
@@ -0,0 +1,114 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#ifndef KISS_TNC_H
+#define KISS_TNC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "fsk_link.h"
+
+// KISS TNC .. host software on the programming lead sends and receives FSK link messages as KISS frames
+//
+//   FEND [command] [data, FEND -> FESC TFEND, FESC -> FESC TFESC] FEND
+//
+// the frames share UART1 with the 0xABCD programming protocol, a FEND outside a programming frame starts
+// a KISS one. The link is opened by the first KISS frame, with the FSK M? menu modulation, and closed by
+// the KISS 'return' command (0xFF). Data frames (port 0 only) go out on the link, broadcast or to the
+// SetHardware peer, every message the link hands up goes back out the UART as a data frame.
+//
+// both directions are queued in RAM so the UART and the air stay busy at the same time .. a frame from
+// the host is decoded straight into the TX queue while the one before it is on the air, a frame off the
+// air waits in the RX queue while the UART DMA sends the one before it. A frame that finds its queue
+// full, or is longer than the link's FSK_LINK_MAX_MESSAGE_BYTES (1kB by default), is dropped and
+// counted in tx_dropped.
+//
+// flow control is the ACKMODE extension (command 0x0C) .. the host puts a 2 byte id in front of the data,
+// the TNC sends FEND 0x0C id FEND back once that frame has been on the air. Keeping two or three frames
+// acked-but-not-yet-answered keeps the channel busy without ever filling the TX queue. The queue depths
+// and counters can also be read with programming command 0x0541.
+//
+// channel access is p-persistent CSMA with the KISS P and SlotTime, carrier detect is an FSK sync word
+// until its packet ends, FullDuplex on skips it. TXDELAY and TXtail are accepted and ignored, the link
+// layer keys up and down as it needs to.
+//
+// SetHardware (command 6) takes [link address] [peer address] [adaptive rate on/off] [FEC parity bytes]
+// [FEC depth], any it leaves off keep their last value. The link address otherwise comes from the DTMF
+// ANI ID. Frames are broadcast unless a peer is given (0 or 0xFF = broadcast), and adaptive rate is only
+// used with a peer as broadcasts always go at the slowest rate .. both stations give each other as the
+// peer to run it. FEC (ENABLE_FSK_FEC builds only, see FSK_LINK_set_fec()) is off with 0 parity bytes,
+// sizes the coder can't do turn it off. Every station on the channel has to use the same FEC settings,
+// a packet with a different amount of parity doesn't even get through the receiver.
+
+#ifndef KISS_TNC_TX_QUEUE_BYTES
+	#define KISS_TNC_TX_QUEUE_BYTES   1024      // host to air
+#endif
+#ifndef KISS_TNC_RX_QUEUE_BYTES
+	#define KISS_TNC_RX_QUEUE_BYTES   1024      // air to host
+#endif
+#define KISS_TNC_ACKS                 8         // ACKMODE acks waiting for the UART
+
+#define KISS_FEND                     0xC0
+#define KISS_FESC                     0xDB
+#define KISS_TFEND                    0xDC
+#define KISS_TFESC                    0xDD
+
+enum kiss_command_e {
+	KISS_CMD_DATA = 0,
+	KISS_CMD_TXDELAY,
+	KISS_CMD_P,
+	KISS_CMD_SLOTTIME,
+	KISS_CMD_TXTAIL,
+	KISS_CMD_FULLDUPLEX,
+	KISS_CMD_SETHARDWARE,
+	KISS_CMD_ACKMODE = 0x0C,
+	KISS_CMD_RETURN  = 0xFF
+};
+
+#if (KISS_TNC_TX_QUEUE_BYTES & 1) != 0 || (KISS_TNC_RX_QUEUE_BYTES & 1) != 0
+	#error "the KISS TNC queues must be a whole number of words"
+#endif
+
+typedef struct {
+	uint16_t uart_frames;           // data frames from the host
+	uint16_t uart_bad;              // frames for another port, unknown commands, bad escapes
+	uint16_t tx_frames;             // sent on the air
+	uint16_t tx_failed;             // the link gave up on them
+	uint16_t tx_dropped;            // no room in the TX queue, or bigger than a link message
+	uint16_t tx_high_water;         // most bytes ever waiting in the TX queue
+	uint16_t rx_frames;             // off the air and out the UART
+	uint16_t rx_dropped;            // no room in the RX queue
+	uint16_t rx_high_water;
+	uint16_t acks;                  // ACKMODE acks sent
+	uint16_t acks_lost;             // more acks due than KISS_TNC_ACKS
+} kiss_tnc_stats_t;
+
+extern kiss_tnc_stats_t g_kiss_tnc_stats;
+
+// a byte from the UART, false if it isn't part of a KISS frame (the programming protocol's then)
+bool    KISS_TNC_uart_byte(const uint8_t b);
+// a frame is part way out of the UART, anything else sent now would land in the middle of it
+bool    KISS_TNC_uart_busy(void);
+// frames waiting in the TX (host to air) or RX (air to host) queue, and their bytes
+uint8_t KISS_TNC_queued(const bool tx, uint16_t *p_bytes);
+bool    KISS_TNC_is_open(void);
+void    KISS_TNC_close(void);
+
+void    KISS_TNC_process_10ms(void);
+
+#endif
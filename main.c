@@ -17,6 +17,8 @@
 #include <string.h>
 #include <stdio.h>     // NULL
 
+#include "ARMCM0.h"
+
 #ifdef ENABLE_AM_FIX
 	#include "am_fix.h"
 #endif
@@ -36,6 +38,7 @@
 #include "helper/battery.h"
 #include "helper/boot.h"
 #include "misc.h"
+#include "profile.h"
 #include "radio.h"
 #include "settings.h"
 #include "ui/lock.h"
@@ -48,6 +51,34 @@ void _putchar(char c)
 	UART_Send((uint8_t *)&c, 1);
 }
 
+#if defined(ENABLE_UART) && defined(ENABLE_UART_DEBUG)
+	// boot profiler .. prints how long each boot phase took
+
+	static uint32_t boot_phase_us;
+
+	static uint32_t boot_time_us(void)
+	{	// 10ms ticks + how far the SysTick counter is into the current tick
+		uint32_t ticks;
+		uint32_t val;
+		do {
+			ticks = g_global_sys_tick_counter;
+			val   = SysTick->VAL;
+		} while (ticks != g_global_sys_tick_counter);
+		return (ticks * 10000) + ((SysTick->LOAD - val) / 48);
+	}
+
+	static void boot_phase(const char *name)
+	{
+		const uint32_t now = boot_time_us();
+		UART_printf("boot %-8s %7uus  %7uus\r\n", name, (unsigned int)(now - boot_phase_us), (unsigned int)now);
+		boot_phase_us = boot_time_us();   // don't count the printf
+	}
+
+	#define BOOT_PHASE(name)  boot_phase(name)
+#else
+	#define BOOT_PHASE(name)
+#endif
+
 void Main(void)
 {
 	unsigned int i;
@@ -75,6 +106,8 @@ void Main(void)
 		UART_SendText("\r\n");
 	#endif
 
+	BOOT_PHASE("init");
+
 	// Not implementing authentic device checks
 
 	memset(&g_eeprom, 0, sizeof(g_eeprom));
@@ -90,11 +123,13 @@ void Main(void)
 
 	BK4819_Init();
 
+	BOOT_PHASE("bk4819");
+
 	BOARD_ADC_GetBatteryInfo(&g_usb_current_voltage, &g_usb_current);
 
-	BOARD_EEPROM_load();
+	BOARD_EEPROM_boot_load();
 
-	BOARD_EEPROM_LoadCalibration();
+	BOOT_PHASE("eeprom");
 
 	RADIO_configure_channel(0, VFO_CONFIGURE_RELOAD);
 	RADIO_configure_channel(1, VFO_CONFIGURE_RELOAD);
@@ -103,11 +138,15 @@ void Main(void)
 
 	RADIO_setup_registers(true);
 
+	BOOT_PHASE("radio");
+
 	for (i = 0; i < ARRAY_SIZE(g_battery_voltages); i++)
 		BOARD_ADC_GetBatteryInfo(&g_battery_voltages[i], &g_usb_current);
 
 	BATTERY_GetReadings(false);
 
+	BOOT_PHASE("battery");
+
 	#ifdef ENABLE_CONTRAST
 		ST7565_SetContrast(g_setting_contrast);
 	#endif
@@ -220,19 +259,29 @@ void Main(void)
 		#endif
 	}
 
+	BOOT_PHASE("welcome");
+
 	while (1)
 	{
+		PROFILE_ENTER(PROFILE_ID_APP_PROCESS);
 		APP_process();
+		PROFILE_EXIT(PROFILE_ID_APP_PROCESS);
 
 		if (g_next_time_slice)
 		{
+			PROFILE_SLICE(PROFILE_SLICE_10MS);
+			PROFILE_ENTER(PROFILE_ID_SLICE_10MS);
 			APP_time_slice_10ms();
+			PROFILE_EXIT(PROFILE_ID_SLICE_10MS);
 			g_next_time_slice = false;
 		}
 
 		if (g_next_time_slice_500ms)
 		{
+			PROFILE_SLICE(PROFILE_SLICE_500MS);
+			PROFILE_ENTER(PROFILE_ID_SLICE_500MS);
 			APP_time_slice_500ms();
+			PROFILE_EXIT(PROFILE_ID_SLICE_500MS);
 			g_next_time_slice_500ms = false;
 		}
 	}
@@ -248,6 +248,7 @@ bool                  g_update_display;
 
 bool                  g_unhide_hidden = false;
 
+volatile uint32_t     g_global_sys_tick_counter;   // 10ms ticks since power on
 volatile bool         g_next_time_slice;
 volatile uint8_t      g_found_cdcss_count_down_10ms;
 volatile uint8_t      g_found_ctcss_count_down_10ms;
@@ -323,18 +324,129 @@ void NUMBER_Get(char *pDigits, uint32_t *pInteger)
 	*pInteger = val;
 }
 
+static uint32_t NUMBER_div10(const uint32_t value, unsigned int *p_rem)
+{	// value / 10 without the library divide, the M0 has no divider
+	// multiply by 0.8 with shifts and adds, divide that by 8, then the one step correction
+	uint32_t     q = (value >> 1) + (value >> 2);
+	unsigned int r;
+
+	q += q >> 4;
+	q += q >> 8;
+	q += q >> 16;
+	q >>= 3;
+
+	r = value - (q * 10u);
+	if (r > 9)
+	{
+		q++;
+		r -= 10;
+	}
+
+	*p_rem = r;
+	return q;
+}
+
 void NUMBER_ToDigits(uint32_t Value, char *pDigits)
 {
 	unsigned int i;
 	for (i = 0; i < 8; i++)
 	{
-		const uint32_t Result = Value / 10U;
-		pDigits[7 - i] = Value - (Result * 10U);
-		Value = Result;
+		unsigned int rem;
+		Value = NUMBER_div10(Value, &rem);
+		pDigits[7 - i] = rem;
 	}
 	pDigits[8] = 0;
 }
 
+// small formatters for the display, they replace sprintf() on the paths redrawn all the time
+// each writes a null terminated string and returns a pointer to the null, so they can be chained
+
+char *NUMBER_format_uint(char *s, uint32_t value, const unsigned int width, const char pad)
+{	// right aligned in at least 'width' chars .. "%*u" or "%0*u"
+	char         digits[10];
+	unsigned int n = 0;
+	unsigned int i;
+
+	do {
+		unsigned int rem;
+		value = NUMBER_div10(value, &rem);
+		digits[n++] = '0' + rem;
+	} while (value > 0);
+
+	for (i = n; i < width; i++)
+		*s++ = pad;
+	while (n > 0)
+		*s++ = digits[--n];
+	*s = 0;
+
+	return s;
+}
+
+char *NUMBER_format_int(char *s, const int32_t value, const unsigned int width)
+{	// "%*d", dBm and the like
+	char         digits[11];
+	uint32_t     u = (value < 0) ? 0u - (uint32_t)value : (uint32_t)value;
+	unsigned int n = 0;
+	unsigned int i;
+
+	do {
+		unsigned int rem;
+		u = NUMBER_div10(u, &rem);
+		digits[n++] = '0' + rem;
+	} while (u > 0);
+
+	if (value < 0)
+		digits[n++] = '-';
+
+	for (i = n; i < width; i++)
+		*s++ = ' ';
+	while (n > 0)
+		*s++ = digits[--n];
+	*s = 0;
+
+	return s;
+}
+
+char *NUMBER_format_frequency(char *s, uint32_t freq_10Hz, const bool trim)
+{	// "%03u.%05u" MHz, optionally without the trailing zeros (one decimal is always kept)
+	char         digits[10];
+	unsigned int n = 0;
+
+	do {
+		unsigned int rem;
+		freq_10Hz = NUMBER_div10(freq_10Hz, &rem);
+		digits[n++] = '0' + rem;
+	} while (freq_10Hz > 0 || n < 8);
+
+	while (n > 5)
+		*s++ = digits[--n];
+	*s++ = '.';
+	while (n > 0)
+		*s++ = digits[--n];
+
+	if (trim)
+		while (s[-1] == '0' && s[-2] != '.')
+			s--;
+	*s = 0;
+
+	return s;
+}
+
+char *NUMBER_format_voltage(char *s, const unsigned int voltage_10mV)
+{	// "%u.%02uV"
+	unsigned int rem[2];
+	uint32_t     volts = NUMBER_div10(NUMBER_div10(voltage_10mV, &rem[1]), &rem[0]);
+
+	s    = NUMBER_format_uint(s, volts, 0, ' ');
+	*s++ = '.';
+	*s++ = '0' + rem[0];
+	*s++ = '0' + rem[1];
+	*s++ = 'V';
+	*s   = 0;
+
+	return s;
+}
+
 int32_t NUMBER_AddWithWraparound(int32_t Base, int32_t Add, int32_t LowerLimit, int32_t UpperLimit)
 {
 	Base += Add;
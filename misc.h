@@ -324,6 +324,7 @@ extern uint8_t               g_backup_cross_vfo_rx_tx;
 	extern bool              g_is_noaa_mode;
 	extern uint8_t           g_noaa_channel;
 #endif
+extern volatile uint32_t     g_global_sys_tick_counter;
 extern volatile bool         g_next_time_slice;
 extern bool                  g_update_display;
 extern bool                  g_unhide_hidden;
@@ -359,6 +360,10 @@ void         NUMBER_Get(char *pDigits, uint32_t *pInteger);
 void         NUMBER_ToDigits(uint32_t Value, char *pDigits);
 int32_t      NUMBER_AddWithWraparound(int32_t Base, int32_t Add, int32_t LowerLimit, int32_t UpperLimit);
 void         NUMBER_trim_trailing_zeros(char *str);
+char        *NUMBER_format_uint(char *s, uint32_t value, const unsigned int width, const char pad);
+char        *NUMBER_format_int(char *s, const int32_t value, const unsigned int width);
+char        *NUMBER_format_frequency(char *s, uint32_t freq_10Hz, const bool trim);
+char        *NUMBER_format_voltage(char *s, const unsigned int voltage_10mV);
 
 #endif
 
@@ -0,0 +1,77 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <string.h>
+
+#include "ARMCM0.h"
+#include "misc.h"
+#include "profile.h"
+
+profile_stat_t  g_profile_stat[PROFILE_ID_COUNT];
+uint32_t        g_profile_overruns[PROFILE_SLICE_COUNT];
+
+static uint32_t profile_start[PROFILE_ID_COUNT];
+static uint32_t profile_slice_tick[PROFILE_SLICE_COUNT];
+
+static const uint8_t profile_slice_period[PROFILE_SLICE_COUNT] = {1, 50};   // 10ms ticks
+
+static uint32_t PROFILE_now(void)
+{	// cycles since boot, wraps every 89 seconds which is fine for measuring intervals
+	uint32_t tick;
+	uint32_t val;
+
+	do {	// SysTick may reload between the two reads
+		tick = g_global_sys_tick_counter;
+		val  = SysTick->VAL;
+	} while (tick != g_global_sys_tick_counter);
+
+	return (tick * (SysTick->LOAD + 1)) + (SysTick->LOAD - val);
+}
+
+void PROFILE_enter(const profile_id_t id)
+{
+	profile_start[id] = PROFILE_now();
+}
+
+void PROFILE_exit(const profile_id_t id)
+{
+	const uint32_t  cycles = PROFILE_now() - profile_start[id];
+	profile_stat_t *p_stat = &g_profile_stat[id];
+
+	if (p_stat->count == 0 || p_stat->min > cycles)
+		p_stat->min = cycles;
+	if (p_stat->max < cycles)
+		p_stat->max = cycles;
+	p_stat->total += cycles;
+	p_stat->count++;
+}
+
+void PROFILE_slice(const profile_slice_t slice)
+{	// call as each time slice is serviced, counts the times we were late
+	const uint32_t tick = g_global_sys_tick_counter;
+
+	if (profile_slice_tick[slice] != 0 && (tick - profile_slice_tick[slice]) > profile_slice_period[slice])
+		g_profile_overruns[slice]++;
+
+	profile_slice_tick[slice] = tick;
+}
+
+void PROFILE_clear(void)
+{
+	memset(g_profile_stat,     0, sizeof(g_profile_stat));
+	memset(g_profile_overruns, 0, sizeof(g_profile_overruns));
+	memset(profile_slice_tick, 0, sizeof(profile_slice_tick));
+}
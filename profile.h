@@ -0,0 +1,76 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+
+// cycle profiler
+//
+// PROFILE_ENTER()/PROFILE_EXIT() time a region in CPU cycles against the SysTick counter,
+// keeping the count, min, max and total per region. PROFILE_SLICE() counts the 10ms/500ms
+// time slices that the main loop failed to service on time.
+// UART command 0x053F reads the table back.
+//
+// interrupts taken inside a region are counted as part of it
+
+#define PROFILE_CYCLES_PER_TICK  480000u   // SYSTICK_Init(), 10ms at 48MHz
+
+enum profile_id_e {
+	PROFILE_ID_APP_PROCESS = 0,     // APP_process()
+	PROFILE_ID_SLICE_10MS,          // APP_time_slice_10ms()
+	PROFILE_ID_SLICE_500MS,         // APP_time_slice_500ms()
+	PROFILE_ID_DISPLAY,             // GUI_DisplayScreen()
+	PROFILE_ID_AM_FIX,              // AM_fix_10ms()
+	PROFILE_ID_RADIO_IRQ,           // APP_process_radio_interrupts()
+	PROFILE_ID_COUNT
+};
+typedef uint8_t profile_id_t;
+
+enum profile_slice_e {
+	PROFILE_SLICE_10MS = 0,
+	PROFILE_SLICE_500MS,
+	PROFILE_SLICE_COUNT
+};
+typedef uint8_t profile_slice_t;
+
+typedef struct {
+	uint32_t count;
+	uint32_t min;                   // cycles
+	uint32_t max;                   // cycles
+	uint64_t total;                 // cycles
+} profile_stat_t;
+
+#ifdef ENABLE_PROFILE
+	extern profile_stat_t g_profile_stat[PROFILE_ID_COUNT];
+	extern uint32_t       g_profile_overruns[PROFILE_SLICE_COUNT];
+
+	void PROFILE_enter(const profile_id_t id);
+	void PROFILE_exit(const profile_id_t id);
+	void PROFILE_slice(const profile_slice_t slice);
+	void PROFILE_clear(void);
+
+	#define PROFILE_ENTER(id)     PROFILE_enter(id)
+	#define PROFILE_EXIT(id)      PROFILE_exit(id)
+	#define PROFILE_SLICE(slice)  PROFILE_slice(slice)
+#else
+	#define PROFILE_ENTER(id)     do {} while (0)
+	#define PROFILE_EXIT(id)      do {} while (0)
+	#define PROFILE_SLICE(slice)  do {} while (0)
+#endif
+
+#endif
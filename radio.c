@@ -46,6 +46,12 @@ dcs_code_type_t g_current_code_type;
 uint8_t         g_selected_code;
 vfo_state_t     g_vfo_state[2];
 
+// what the BK4819 RX side is currently set up for, lets RADIO_fast_retune() only push the differences
+static radio_tune_t radio_tune;
+static bool         radio_tune_valid;
+static uint16_t     radio_css_interrupt_mask;
+static uint16_t     radio_interrupt_mask;
+
 bool RADIO_CheckValidChannel(uint16_t Channel, bool bCheckScanList, uint8_t VFO)
 {	// return true if the channel appears valid
 
@@ -356,7 +362,7 @@ void RADIO_configure_channel(const unsigned int VFO, const unsigned int configur
 
 	// channel name
 	memset(p_vfo->name, 0, sizeof(p_vfo->name));
-	if (Channel <= USER_CHANNEL_LAST)
+	if (Channel <= USER_CHANNEL_LAST && BOARD_channel_name_hash(Channel) != 0)
 		EEPROM_ReadBuffer(0x0F50 + (Channel * 16), p_vfo->name, 10);	// only 10 bytes used
 
 	if (!p_vfo->frequency_reverse)
@@ -587,36 +593,106 @@ void RADIO_select_vfos(void)
 	RADIO_SelectCurrentVfo();
 }
 
-void RADIO_setup_registers(bool switch_to_function_foreground)
-{
-	BK4819_filter_bandwidth_t Bandwidth = g_rx_vfo->channel_bandwidth;
-	uint16_t                  interrupt_mask;
-	uint32_t                  Frequency;
+void RADIO_get_tune(const vfo_info_t *p_vfo, radio_tune_t *p_tune)
+{	// the RX register settings RADIO_setup_registers() would use for this VFO
+	memset(p_tune, 0, sizeof(*p_tune));
 
-	GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_SPEAKER);
-	g_speaker_enabled = false;
+	p_tune->frequency                   = p_vfo->p_rx->frequency;
+	p_tune->bandwidth                   = (p_vfo->channel_bandwidth == BK4819_FILTER_BW_NARROW) ? BK4819_FILTER_BW_NARROW : BK4819_FILTER_BW_WIDE;
+	p_tune->am_mode                     = p_vfo->am_mode;
 
-	BK4819_set_GPIO_pin(BK4819_GPIO6_PIN2_GREEN, false);
+	p_tune->squelch_open_rssi_thresh    = p_vfo->squelch_open_rssi_thresh;
+	p_tune->squelch_close_rssi_thresh   = p_vfo->squelch_close_rssi_thresh;
+	p_tune->squelch_open_noise_thresh   = p_vfo->squelch_open_noise_thresh;
+	p_tune->squelch_close_noise_thresh  = p_vfo->squelch_close_noise_thresh;
+	p_tune->squelch_close_glitch_thresh = p_vfo->squelch_close_glitch_thresh;
+	p_tune->squelch_open_glitch_thresh  = p_vfo->squelch_open_glitch_thresh;
 
-	#pragma GCC diagnostic push
-	#pragma GCC diagnostic ignored "-Wimplicit-fallthrough="
+	if (p_vfo->am_mode == 0)
+	{	// FM
+		p_tune->code_type = g_selected_code_type;
+		p_tune->code      = g_selected_code;
 
-	switch (Bandwidth)
+		if (g_css_scan_mode == CSS_SCAN_MODE_OFF)
+		{
+			p_tune->code_type = p_vfo->p_rx->code_type;
+			p_tune->code      = p_vfo->p_rx->code;
+		}
+
+		if (p_vfo->scrambling_type > 0 && g_setting_scramble_enable)
+			p_tune->scrambling_type = p_vfo->scrambling_type;
+
+		if (p_vfo->compand >= 2)
+			p_tune->compand = p_vfo->compand;
+	}
+}
+
+static void RADIO_set_filter_bandwidth(const BK4819_filter_bandwidth_t Bandwidth)
+{
+	#ifdef ENABLE_AM_FIX
+//		BK4819_SetFilterBandwidth(Bandwidth, g_rx_vfo->am_mode && g_setting_am_fix);
+		BK4819_SetFilterBandwidth(Bandwidth, true);
+	#else
+		BK4819_SetFilterBandwidth(Bandwidth, false);
+	#endif
+}
+
+static uint16_t RADIO_setup_rx_css(const dcs_code_type_t code_type, const uint8_t Code)
+{	// returns the interrupts to enable for the selected CTCSS/CDCSS
+	switch (code_type)
 	{
 		default:
-			Bandwidth = BK4819_FILTER_BW_WIDE;
-		case BK4819_FILTER_BW_WIDE:
-		case BK4819_FILTER_BW_NARROW:
-			#ifdef ENABLE_AM_FIX
-//				BK4819_SetFilterBandwidth(Bandwidth, g_rx_vfo->am_mode && g_setting_am_fix);
-				BK4819_SetFilterBandwidth(Bandwidth, true);
-			#else
-				BK4819_SetFilterBandwidth(Bandwidth, false);
-			#endif
-			break;
+		case CODE_TYPE_NONE:
+			BK4819_SetCTCSSFrequency(670);
+
+			//#ifndef ENABLE_CTCSS_TAIL_PHASE_SHIFT
+				BK4819_SetTailDetection(550);		// QS's 55Hz tone method
+			//#else
+			//	BK4819_SetTailDetection(670);       // 67Hz
+			//#endif
+
+			return BK4819_REG_3F_CxCSS_TAIL | BK4819_REG_3F_SQUELCH_FOUND | BK4819_REG_3F_SQUELCH_LOST;
+
+		case CODE_TYPE_CONTINUOUS_TONE:
+			BK4819_SetCTCSSFrequency(CTCSS_OPTIONS[Code]);
+
+			//#ifndef ENABLE_CTCSS_TAIL_PHASE_SHIFT
+				BK4819_SetTailDetection(550);		// QS's 55Hz tone method
+			//#else
+			//	BK4819_SetTailDetection(CTCSS_OPTIONS[Code]);
+			//#endif
+
+			return
+				BK4819_REG_3F_CxCSS_TAIL    |
+				BK4819_REG_3F_CTCSS_FOUND   |
+				BK4819_REG_3F_CTCSS_LOST    |
+				BK4819_REG_3F_SQUELCH_FOUND |
+				BK4819_REG_3F_SQUELCH_LOST;
+
+		case CODE_TYPE_DIGITAL:
+		case CODE_TYPE_REVERSE_DIGITAL:
+			BK4819_SetCDCSSCodeWord(DCS_GetGolayCodeWord(code_type, Code));
+			return
+				BK4819_REG_3F_CxCSS_TAIL    |
+				BK4819_REG_3F_CDCSS_FOUND   |
+				BK4819_REG_3F_CDCSS_LOST    |
+				BK4819_REG_3F_SQUELCH_FOUND |
+				BK4819_REG_3F_SQUELCH_LOST;
 	}
+}
 
-	#pragma GCC diagnostic pop
+void RADIO_setup_registers(bool switch_to_function_foreground)
+{
+	uint16_t interrupt_mask;
+	uint16_t css_interrupt_mask;
+	uint32_t Frequency;
+
+	GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_SPEAKER);
+	g_speaker_enabled = false;
+
+	BK4819_set_GPIO_pin(BK4819_GPIO6_PIN2_GREEN, false);
+
+	RADIO_set_filter_bandwidth((g_rx_vfo->channel_bandwidth == BK4819_FILTER_BW_NARROW) ? BK4819_FILTER_BW_NARROW : BK4819_FILTER_BW_WIDE);
 
 	BK4819_set_GPIO_pin(BK4819_GPIO5_PIN1_RED, false);         // LED off
 	BK4819_SetupPowerAmplifier(0, 0);
@@ -662,8 +738,8 @@ void RADIO_setup_registers(bool switch_to_function_foreground)
 	{
 		if (g_rx_vfo->am_mode == 0)
 		{	// FM
-			uint8_t code_type = g_selected_code_type;
-			uint8_t Code      = g_selected_code;
+			dcs_code_type_t code_type = g_selected_code_type;
+			uint8_t         Code      = g_selected_code;
 
 			if (g_css_scan_mode == CSS_SCAN_MODE_OFF)
 			{
@@ -671,50 +747,7 @@ void RADIO_setup_registers(bool switch_to_function_foreground)
 				Code      = g_rx_vfo->p_rx->code;
 			}
 
-			switch (code_type)
-			{
-				default:
-				case CODE_TYPE_NONE:
-					BK4819_SetCTCSSFrequency(670);
-
-					//#ifndef ENABLE_CTCSS_TAIL_PHASE_SHIFT
-						BK4819_SetTailDetection(550);		// QS's 55Hz tone method
-					//#else
-					//	BK4819_SetTailDetection(670);       // 67Hz
-					//#endif
-
-					interrupt_mask = BK4819_REG_3F_CxCSS_TAIL | BK4819_REG_3F_SQUELCH_FOUND | BK4819_REG_3F_SQUELCH_LOST;
-					break;
-
-				case CODE_TYPE_CONTINUOUS_TONE:
-					BK4819_SetCTCSSFrequency(CTCSS_OPTIONS[Code]);
-
-					//#ifndef ENABLE_CTCSS_TAIL_PHASE_SHIFT
-						BK4819_SetTailDetection(550);		// QS's 55Hz tone method
-					//#else
-					//	BK4819_SetTailDetection(CTCSS_OPTIONS[Code]);
-					//#endif
-
-					interrupt_mask =
-						BK4819_REG_3F_CxCSS_TAIL    |
-						BK4819_REG_3F_CTCSS_FOUND   |
-						BK4819_REG_3F_CTCSS_LOST    |
-						BK4819_REG_3F_SQUELCH_FOUND |
-						BK4819_REG_3F_SQUELCH_LOST;
-
-					break;
-
-				case CODE_TYPE_DIGITAL:
-				case CODE_TYPE_REVERSE_DIGITAL:
-					BK4819_SetCDCSSCodeWord(DCS_GetGolayCodeWord(code_type, Code));
-					interrupt_mask =
-						BK4819_REG_3F_CxCSS_TAIL    |
-						BK4819_REG_3F_CDCSS_FOUND   |
-						BK4819_REG_3F_CDCSS_LOST    |
-						BK4819_REG_3F_SQUELCH_FOUND |
-						BK4819_REG_3F_SQUELCH_LOST;
-					break;
-			}
+			interrupt_mask = RADIO_setup_rx_css(code_type, Code);
 
 			if (g_rx_vfo->scrambling_type > 0 && g_setting_scramble_enable)
 				BK4819_EnableScramble(g_rx_vfo->scrambling_type - 1);
@@ -734,6 +767,8 @@ void RADIO_setup_registers(bool switch_to_function_foreground)
 		}
 	#endif
 
+	css_interrupt_mask = interrupt_mask;
+
 	#ifdef ENABLE_VOX
 		if (
 			#ifdef ENABLE_FMRADIO
@@ -783,6 +818,11 @@ void RADIO_setup_registers(bool switch_to_function_foreground)
 	// enable/disable BK4819 selected interrupts
 	BK4819_WriteRegister(BK4819_REG_3F, interrupt_mask);
 
+	RADIO_get_tune(g_rx_vfo, &radio_tune);
+	radio_tune_valid         = IS_NOT_NOAA_CHANNEL(g_rx_vfo->channel_save);
+	radio_css_interrupt_mask = css_interrupt_mask;
+	radio_interrupt_mask     = interrupt_mask;
+
 	FUNCTION_Init();
 
 	if (switch_to_function_foreground)
@@ -794,6 +834,72 @@ void RADIO_setup_registers(bool switch_to_function_foreground)
 	}
 }
 
+bool RADIO_fast_retune(void)
+{	// retune the RX to g_rx_vfo without a full RADIO_setup_registers(), only the registers that
+	// differ from what the BK4819 is already set up for are written and the receiver is left
+	// running (no RX_TurnOn), so the squelch settles a lot quicker.
+	//
+	// returns false if it can't be done, the caller then has to use RADIO_setup_registers()
+	radio_tune_t tune;
+
+	if (!radio_tune_valid || g_current_function != FUNCTION_FOREGROUND || IS_NOAA_CHANNEL(g_rx_vfo->channel_save))
+		return false;
+
+	RADIO_get_tune(g_rx_vfo, &tune);
+
+	if (tune.am_mode != radio_tune.am_mode)
+		return false;   // AF path change, needs the full setup
+
+	if (tune.bandwidth != radio_tune.bandwidth)
+		RADIO_set_filter_bandwidth(tune.bandwidth);
+
+	if (tune.frequency != radio_tune.frequency)
+	{
+		BK4819_set_rf_frequency(tune.frequency, true);
+		BK4819_set_rf_filter_path(tune.frequency);
+	}
+
+	if (tune.squelch_open_rssi_thresh    != radio_tune.squelch_open_rssi_thresh    ||
+	    tune.squelch_close_rssi_thresh   != radio_tune.squelch_close_rssi_thresh   ||
+	    tune.squelch_open_noise_thresh   != radio_tune.squelch_open_noise_thresh   ||
+	    tune.squelch_close_noise_thresh  != radio_tune.squelch_close_noise_thresh  ||
+	    tune.squelch_close_glitch_thresh != radio_tune.squelch_close_glitch_thresh ||
+	    tune.squelch_open_glitch_thresh  != radio_tune.squelch_open_glitch_thresh)
+	{
+		BK4819_SetSquelchThresholds(
+			tune.squelch_open_rssi_thresh,    tune.squelch_close_rssi_thresh,
+			tune.squelch_open_noise_thresh,   tune.squelch_close_noise_thresh,
+			tune.squelch_close_glitch_thresh, tune.squelch_open_glitch_thresh);
+	}
+
+	if (tune.am_mode == 0 && (tune.code_type != radio_tune.code_type || tune.code != radio_tune.code))
+	{
+		const uint16_t css_interrupt_mask = RADIO_setup_rx_css(tune.code_type, tune.code);
+
+		radio_interrupt_mask     = (radio_interrupt_mask & ~radio_css_interrupt_mask) | css_interrupt_mask;
+		radio_css_interrupt_mask = css_interrupt_mask;
+
+		BK4819_WriteRegister(BK4819_REG_3F, radio_interrupt_mask);
+	}
+
+	if (tune.scrambling_type != radio_tune.scrambling_type)
+	{
+		if (tune.scrambling_type > 0)
+			BK4819_EnableScramble(tune.scrambling_type - 1);
+		else
+			BK4819_DisableScramble();
+	}
+
+	if (tune.compand != radio_tune.compand)
+		BK4819_SetCompander(tune.compand);
+
+	radio_tune = tune;
+
+	FUNCTION_Init();
+
+	return true;
+}
+
 #ifdef ENABLE_NOAA
 	void RADIO_ConfigureNOAA(void)
 	{
@@ -843,6 +949,8 @@ void RADIO_enableTX(const bool fsk_tx)
 {
 	BK4819_filter_bandwidth_t Bandwidth = g_current_vfo->channel_bandwidth;
 
+	radio_tune_valid = false;   // RX has to go through RADIO_setup_registers() again
+
 	GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_SPEAKER);
 
 	g_speaker_enabled = false;
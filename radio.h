@@ -120,6 +120,24 @@ typedef struct vfo_info_t
 	char           name[16];
 } vfo_info_t;
 
+// compact copy of the RX register settings for a VFO/channel, see RADIO_fast_retune()
+typedef struct
+{
+	uint32_t frequency;
+	uint8_t  squelch_open_rssi_thresh;
+	uint8_t  squelch_close_rssi_thresh;
+	uint8_t  squelch_open_noise_thresh;
+	uint8_t  squelch_close_noise_thresh;
+	uint8_t  squelch_close_glitch_thresh;
+	uint8_t  squelch_open_glitch_thresh;
+	uint8_t  code_type;         // dcs_code_type_t
+	uint8_t  code;
+	uint8_t  bandwidth;         // BK4819_filter_bandwidth_t
+	uint8_t  am_mode;
+	uint8_t  scrambling_type;   // 0 = off
+	uint8_t  compand;           // RX expander, 0 = off
+} radio_tune_t;
+
 extern vfo_info_t     *g_tx_vfo;
 extern vfo_info_t     *g_rx_vfo;
 extern vfo_info_t     *g_current_vfo;
@@ -137,7 +155,9 @@ void     RADIO_configure_channel(const unsigned int VFO, const unsigned int conf
 void     RADIO_ConfigureSquelchAndOutputPower(vfo_info_t *p_vfo);
 void     RADIO_ApplyOffset(vfo_info_t *p_vfo);
 void     RADIO_select_vfos(void);
+void     RADIO_get_tune(const vfo_info_t *p_vfo, radio_tune_t *p_tune);
 void     RADIO_setup_registers(bool switch_to_function_foreground);
+bool     RADIO_fast_retune(void);
 #ifdef ENABLE_NOAA
 	void RADIO_ConfigureNOAA(void);
 #endif
@@ -41,8 +41,6 @@
 				flag = true;             \
 	} while (0)
 
-static volatile uint32_t g_global_sys_tick_counter;
-
 void SystickHandler(void);
 
 // we come here every 10ms
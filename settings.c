@@ -19,6 +19,7 @@
 #ifdef ENABLE_FMRADIO
 	#include "app/fm.h"
 #endif
+#include "board.h"
 #include "driver/eeprom.h"
 #include "driver/uart.h"
 #include "misc.h"
@@ -435,6 +436,8 @@ void SETTINGS_save_channel(const unsigned int channel, const unsigned int vfo, c
 				EEPROM_WriteBuffer8(eeprom_addr + 8, name + 8);
 			}
 		#endif
+
+		BOARD_channel_index_update(channel);   // keep the RAM channel table in step
 	}
 }
 
@@ -484,5 +487,7 @@ void SETTINGS_save_chan_attribs_name(const unsigned int channel, const vfo_info_
 
 		EEPROM_WriteBuffer8(0x0F50 + 0 + index, name + 0);
 		EEPROM_WriteBuffer8(0x0F50 + 8 + index, name + 8);
+
+		BOARD_channel_index_update(channel);   // keep the RAM channel table in step
 	}
 }
@@ -0,0 +1,72 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <string.h>
+
+#include "ARMCM0.h"
+#include "misc.h"
+#include "trace.h"
+
+#define TRACE_RING_SIZE   64u       // must be a power of 2, 10 bytes each
+
+static trace_entry_t trace_ring[TRACE_RING_SIZE];
+static uint16_t      trace_head;    // total events recorded
+static uint16_t      trace_tail;    // total events drained (or overwritten)
+static uint16_t      trace_lost;    // overwritten before they were drained
+
+void TRACE_event(const trace_id_t id, const uint16_t arg0, const uint16_t arg1)
+{
+	const uint32_t primask = __get_PRIMASK();
+	trace_entry_t *p_entry;
+
+	__disable_irq();
+
+	p_entry         = &trace_ring[trace_head++ & (TRACE_RING_SIZE - 1)];
+	p_entry->tick   = g_global_sys_tick_counter;
+	p_entry->sub    = SysTick->VAL >> 3;
+	p_entry->id     = id;
+	p_entry->arg[0] = arg0;
+	p_entry->arg[1] = arg1;
+
+	if ((uint16_t)(trace_head - trace_tail) > TRACE_RING_SIZE)
+	{	// the oldest one just got overwritten
+		trace_tail++;
+		trace_lost++;
+	}
+
+	__set_PRIMASK(primask);
+}
+
+// copy out up to 'max' of the oldest events, returns how many
+// *p_lost is set to the number of events overwritten since the last drain
+unsigned int TRACE_drain(trace_entry_t *p_dest, const unsigned int max, uint16_t *p_lost)
+{
+	const uint32_t primask = __get_PRIMASK();
+	unsigned int   count   = 0;
+
+	__disable_irq();
+
+	while (count < max && trace_tail != trace_head)
+		p_dest[count++] = trace_ring[trace_tail++ & (TRACE_RING_SIZE - 1)];
+
+	if (p_lost != NULL)
+		*p_lost = trace_lost;
+	trace_lost = 0;
+
+	__set_PRIMASK(primask);
+
+	return count;
+}
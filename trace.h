@@ -0,0 +1,61 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+// binary event trace
+//
+// TRACE() drops a {time, id, arg0, arg1} record into a RAM ring, that's all .. no formatting,
+// so it can sit in the FSK FIFO servicing and interrupt paths without upsetting their timing.
+// UART command 0x053D drains the ring, utils/trace_decode.py turns it back into text.
+//
+// keep the ids in step with utils/trace_decode.py, it reads the names from this enum
+
+enum trace_id_e {
+	TRACE_ID_NONE = 0,
+	TRACE_ID_BK4819_IRQ,            // REG_0C, REG_02
+	TRACE_ID_RADIO_IRQ,             // REG_02 interrupt bits, 0
+	TRACE_ID_FSK_TX_START,          // length words, FIFO words pre-loaded
+	TRACE_ID_FSK_TX_REFILL,         // words sent so far, words loaded
+	TRACE_ID_FSK_TX_END,            // ok, words sent
+	TRACE_ID_FSK_RX_DRAIN,          // words read, words in the packet so far
+	TRACE_ID_FSK_RX_PACKET,         // length words, status
+	TRACE_ID_SQUELCH,               // open, RSSI
+	TRACE_ID_SCAN_NEXT,             // channel, fast retune
+	TRACE_ID_COUNT
+};
+typedef uint16_t trace_id_t;
+
+typedef struct {
+	uint16_t tick;                  // 10ms tick count, low 16 bits
+	uint16_t sub;                   // SysTick->VAL / 8 at the time, counts down 6 per us within the tick
+	uint16_t id;
+	uint16_t arg[2];
+} __attribute__((packed)) trace_entry_t;
+
+#ifdef ENABLE_TRACE
+	void         TRACE_event(const trace_id_t id, const uint16_t arg0, const uint16_t arg1);
+	unsigned int TRACE_drain(trace_entry_t *p_dest, const unsigned int max, uint16_t *p_lost);
+
+	#define TRACE(id, arg0, arg1)  TRACE_event((id), (uint16_t)(arg0), (uint16_t)(arg1))
+#else
+	#define TRACE(id, arg0, arg1)  do {} while (0)
+#endif
+
+#endif
@@ -17,8 +17,8 @@
 #include <string.h>
 
 #include "driver/st7565.h"
-#include "external/printf/printf.h"
 #include "font.h"
+#include "misc.h"
 #include "ui/helper.h"
 #include "ui/inputbox.h"
 
@@ -35,7 +35,10 @@ void UI_GenerateChannelString(char *pString, const uint8_t Channel, const char s
 
 	if (g_input_box_index == 0)
 	{
-		sprintf(pString, "CH%c%02u", separating_char, Channel + 1);
+		pString[0] = 'C';
+		pString[1] = 'H';
+		pString[2] = separating_char;
+		NUMBER_format_uint(pString + 3, Channel + 1, 2, '0');
 		return;
 	}
 
@@ -67,7 +70,7 @@ void UI_GenerateChannelStringEx(char *pString, const char *prefix, const uint8_t
 	if (ChannelNumber == 0xFF)
 		strcpy(pString, "NULL");
 	else
-		sprintf(pString + strlen(prefix), "%03u", ChannelNumber + 1);
+		NUMBER_format_uint(pString + strlen(prefix), ChannelNumber + 1, 3, '0');
 }
 
 void UI_PrintString(const char *pString, uint8_t Start, uint8_t End, uint8_t Line, uint8_t Width)
@@ -151,40 +154,69 @@ void PutPixelStatus(const unsigned int x, const unsigned int y, bool fill)
 		g_status_line[x] &= ~(1u << y);
 }
 
-void UI_PrintStringSmallest(const void *pString, unsigned int x, const unsigned int y, const bool statusbar, const bool fill)
-{
-	const unsigned int char_width  = ARRAY_SIZE(g_font3x5[0]);
-	const unsigned int char_height = 5;
-//	const uint8_t      pixel_mask  = (1u << char_height) - 1;
-	const uint8_t *p = (const uint8_t *)pString;
-	int c;
-
-	while ((c = *p++) != 0)
+void UI_draw_string(
+	const uint8_t     *str,
+	unsigned int       x,
+	const unsigned int y,
+	uint8_t           *buffer,
+	const unsigned int buffer_size,
+	const uint8_t     *font,
+	const unsigned int font_size,
+	const unsigned int char_width,
+	const uint8_t      rows,
+	const bool         fill)
+{	// OR (or mask out) whole glyph columns into the page bytes at any pixel row
+	//
+	// buffer is a run of LCD_WIDTH byte pages, x past the right edge carries on into the next page
+	// same as PutPixel() did. A glyph that straddles two pages is the one shifted column split
+	// over the two bytes, the shift is worked out once for the whole string.
+	const unsigned int shift    = y & 7u;
+	const bool         straddle = (((unsigned int)rows << shift) > 0xFFu) ? true : false;
+	unsigned int       index    = ((y >> 3) * LCD_WIDTH) + x;
+	int                c;
+
+	while ((c = *str++) != 0)
 	{
 		c -= ' ';
-		if (c >= 0 && c < (int)ARRAY_SIZE(g_font3x5))
+		if (c >= 0 && c < (int)font_size)
 		{
-			for (unsigned int xx = 0; xx < char_width; xx++)
+			const uint8_t *p_glyph = font + (char_width * c);
+			unsigned int   xx;
+
+			for (xx = 0; xx < char_width; xx++)
 			{
-				uint8_t pixels = g_font3x5[c][xx];
-				if (statusbar)
+				const unsigned int i    = index + xx;
+				const unsigned int bits = (unsigned int)(p_glyph[xx] & rows) << shift;
+
+				if (i >= buffer_size)
+					return;
+
+				if (fill)
 				{
-					for (unsigned int yy = 0; yy <= char_height; yy++, pixels >>= 1)
-						if (pixels & 1u)
-							PutPixelStatus(x + xx, y + yy, fill);
+					buffer[i] |= (uint8_t)bits;
+					if (straddle && (i + LCD_WIDTH) < buffer_size)
+						buffer[i + LCD_WIDTH] |= (uint8_t)(bits >> 8);
 				}
 				else
 				{
-					for (unsigned int yy = 0; yy <= char_height; yy++, pixels >>= 1)
-						if (pixels & 1u)
-							PutPixel(x + xx, y + yy, fill);
+					buffer[i] &= (uint8_t)~bits;
+					if (straddle && (i + LCD_WIDTH) < buffer_size)
+						buffer[i + LCD_WIDTH] &= (uint8_t)~(bits >> 8);
 				}
 			}
 		}
-		x += char_width + 1;
+		index += char_width + 1;
 	}
 }
 
+void UI_PrintStringSmallest(const void *pString, unsigned int x, const unsigned int y, const bool statusbar, const bool fill)
+{	// 3x5 font, the 6th row is there for the few glyphs with a descender
+	if (statusbar)
+		UI_draw_string((const uint8_t *)pString, x, y, g_status_line, sizeof(g_status_line), &g_font3x5[0][0], ARRAY_SIZE(g_font3x5), ARRAY_SIZE(g_font3x5[0]), 0x3F, fill);
+	else
+		UI_draw_string((const uint8_t *)pString, x, y, g_frame_buffer[0], sizeof(g_frame_buffer), &g_font3x5[0][0], ARRAY_SIZE(g_font3x5), ARRAY_SIZE(g_font3x5[0]), 0x3F, fill);
+}
+
 void UI_PrintStringSmallBuffer(const char *pString, uint8_t *buffer)
 {
 	const unsigned int char_width   = ARRAY_SIZE(g_font_small[0]);
@@ -28,6 +28,7 @@ void UI_PrintStringSmall(const char *str, const unsigned int start, const unsign
 	void UI_PrintStringSmallBold(const char *str, const unsigned int start, const unsigned int end, const unsigned int line);
 #endif
 //void UI_PrintStringSmall4x5(const char *str, const unsigned int start, const unsigned int end, const unsigned int line);
+void UI_draw_string(const uint8_t *str, unsigned int x, const unsigned int y, uint8_t *buffer, const unsigned int buffer_size, const uint8_t *font, const unsigned int font_size, const unsigned int char_width, const uint8_t rows, const bool fill);
 void UI_PrintStringSmallest(const void *pString, unsigned int x, const unsigned int y, const bool statusbar, const bool fill);
 void UI_PrintStringSmallBuffer(const char *pString, uint8_t *buffer);
 void UI_DisplayFrequency(const char *pDigits, uint8_t X, uint8_t Y, bool bDisplayLeadingZero, bool flag);
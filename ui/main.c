@@ -45,6 +45,45 @@
 
 center_line_t center_line = CENTER_LINE_NONE;
 
+// per VFO copy of the channel name line, so a redraw (every RSSI change while receiving) doesn't go
+// back to the eeprom for it .. refilled when the VFO's screen channel changes, or when the channel
+// is written (UI_main_channel_changed() from BOARD_channel_index_update())
+typedef struct {
+	uint16_t channel;            // 0xffff = nothing cached
+	char     name[11];           // the channel name, or "CH-nnn" when it has none
+} main_channel_name_t;
+
+static main_channel_name_t main_channel_name[2] = {{0xffff, ""}, {0xffff, ""}};
+
+// ***************************************************************************
+
+void UI_main_channel_changed(const unsigned int channel)
+{
+	unsigned int i;
+	for (i = 0; i < ARRAY_SIZE(main_channel_name); i++)
+		if (main_channel_name[i].channel == channel)
+			main_channel_name[i].channel = 0xffff;
+}
+
+static const char *UI_main_channel_name(const unsigned int vfo_num)
+{
+	main_channel_name_t *p       = &main_channel_name[vfo_num];
+	const uint16_t       channel = g_eeprom.screen_channel[vfo_num];
+
+	if (p->channel != channel)
+	{
+		BOARD_fetchChannelName(p->name, channel);
+		if (p->name[0] == 0)
+		{	// no channel name available, channel number instead
+			strcpy(p->name, "CH-");
+			NUMBER_format_uint(p->name + 3, 1 + channel, 3, '0');
+		}
+		p->channel = channel;
+	}
+
+	return p->name;
+}
+
 // ***************************************************************************
 
 void draw_bar(uint8_t *line, const int len, const int max_width)
@@ -115,7 +154,8 @@ void draw_bar(uint8_t *line, const int len, const int max_width)
 			if (now)
 				memset(p_line, 0, LCD_WIDTH);
 
-			sprintf(s, "TX %u", secs);
+			strcpy(s, "TX ");
+			NUMBER_format_uint(s + 3, secs, 0, ' ');
 			#ifdef ENABLE_SMALL_BOLD
 				UI_PrintStringSmallBold(s, 2, 0, line);
 			#else
@@ -203,7 +243,7 @@ void UI_drawBars(uint8_t *p, const unsigned int level)
 				memset(p_line, 0, LCD_WIDTH);
 
 			// TX timeout seconds
-			sprintf(s, "%3u", secs);
+			NUMBER_format_uint(s, secs, 3, ' ');
 			#ifdef ENABLE_SMALL_BOLD
 				UI_PrintStringSmallBold(s, 2, 0, line);
 			#else
@@ -278,14 +318,19 @@ void UI_drawBars(uint8_t *p, const unsigned int level)
 
 			if (rssi_dBm >= (s9_dBm + 6))
 			{	// S9+XXdB, 1dB increment
-				const char *fmt[] = {"%3d 9+%u  ", "%3d 9+%2u "};
 				const unsigned int s9_dB = ((rssi_dBm - s9_dBm) <= 99) ? rssi_dBm - s9_dBm : 99;
-				sprintf(s, (s9_dB < 10) ? fmt[0] : fmt[1], rssi_dBm, s9_dB);
+				char              *p     = NUMBER_format_int(s, rssi_dBm, 3);
+				strcpy(p, " 9+");
+				p = NUMBER_format_uint(p + 3, s9_dB, 0, ' ');
+				strcpy(p, (s9_dB < 10) ? "  " : " ");
 			}
 			else
 			{	// S0 ~ S9, 6dB per S-point
 				const unsigned int s_level = (rssi_dBm >= s0_dBm) ? (rssi_dBm - s0_dBm) / 6 : 0;
-				sprintf(s, "%4d S%u ", rssi_dBm, s_level);
+				char              *p       = NUMBER_format_int(s, rssi_dBm, 4);
+				strcpy(p, " S");
+				p = NUMBER_format_uint(p + 2, s_level, 0, ' ');
+				strcpy(p, " ");
 			}
 			UI_PrintStringSmall(s, 2, 0, line);
 
@@ -597,7 +642,8 @@ void UI_DisplayMain(void)
 			// show the frequency band number
 			const unsigned int x = 2;	// was 14
 //			sprintf(String, "FB%u", 1 + g_eeprom.screen_channel[vfo_num] - FREQ_CHANNEL_FIRST);
-			sprintf(str, "VFO%u", 1 + g_eeprom.screen_channel[vfo_num] - FREQ_CHANNEL_FIRST);
+			strcpy(str, "VFO");
+			NUMBER_format_uint(str + 3, 1 + g_eeprom.screen_channel[vfo_num] - FREQ_CHANNEL_FIRST, 0, ' ');
 			UI_PrintStringSmall(str, x, 0, line + 1);
 		}
 		#ifdef ENABLE_NOAA
@@ -605,7 +651,8 @@ void UI_DisplayMain(void)
 			{
 				if (g_input_box_index == 0 || g_eeprom.tx_vfo != vfo_num)
 				{	// channel number
-					sprintf(str, "N%u", 1 + g_eeprom.screen_channel[vfo_num] - NOAA_CHANNEL_FIRST);
+					str[0] = 'N';
+					NUMBER_format_uint(str + 1, 1 + g_eeprom.screen_channel[vfo_num] - NOAA_CHANNEL_FIRST, 0, ' ');
 				}
 				else
 				{	// user entering channel number
@@ -670,9 +717,10 @@ void UI_DisplayMain(void)
 							UI_Displaysmall_digits(2, str + 6, x + 81, line + 1, true);
 						#else
 							// show the frequency in the main font
-							sprintf(str, "%03u.%05u", frequency / 100000, frequency % 100000);
 							#ifdef ENABLE_TRIM_TRAILING_ZEROS
-								NUMBER_trim_trailing_zeros(str);
+								NUMBER_format_frequency(str, frequency, true);
+							#else
+								NUMBER_format_frequency(str, frequency, false);
 							#endif
 							UI_PrintString(str, x, 0, line, 8);
 						#endif
@@ -681,7 +729,8 @@ void UI_DisplayMain(void)
 
 					case MDF_CHANNEL:	// just channel number
 
-						sprintf(str, "CH-%03u", g_eeprom.screen_channel[vfo_num] + 1);
+						strcpy(str, "CH-");
+						NUMBER_format_uint(str + 3, g_eeprom.screen_channel[vfo_num] + 1, 3, '0');
 						UI_PrintString(str, x, 0, line, 8);
 
 						break;
@@ -689,35 +738,34 @@ void UI_DisplayMain(void)
 					case MDF_NAME:		// channel name
 					case MDF_NAME_FREQ:	// channel name and frequency
 
-						BOARD_fetchChannelName(str, g_eeprom.screen_channel[vfo_num]);
-						if (str[0] == 0)
-						{	// no channel name available, channel number instead
-							sprintf(str, "CH-%03u", 1 + g_eeprom.screen_channel[vfo_num]);
-						}
+					{
+						const char *name = UI_main_channel_name(vfo_num);
 
 						if (g_eeprom.channel_display_mode == MDF_NAME)
 						{	// just the name
-							UI_PrintString(str, x + 4, 0, line, 8);
+							UI_PrintString(name, x + 4, 0, line, 8);
 						}
 						else
 						{	// name & frequency
 							
 							// name
 							#ifdef ENABLE_SMALL_BOLD
-								UI_PrintStringSmallBold(str, x + 4, 0, line);
+								UI_PrintStringSmallBold(name, x + 4, 0, line);
 							#else
-								UI_PrintStringSmall(str, x + 4, 0, line);
+								UI_PrintStringSmall(name, x + 4, 0, line);
 							#endif
 
 							// frequency
-							sprintf(str, "%03u.%05u", frequency / 100000, frequency % 100000);
 							#ifdef ENABLE_TRIM_TRAILING_ZEROS
-								NUMBER_trim_trailing_zeros(str);
+								NUMBER_format_frequency(str, frequency, true);
+							#else
+								NUMBER_format_frequency(str, frequency, false);
 							#endif
 							UI_PrintStringSmall(str, x + 4, 0, line + 1);
 						}
 
 						break;
+					}
 				}
 
 				#pragma GCC diagnostic pop
@@ -738,9 +786,10 @@ void UI_DisplayMain(void)
 				#else
 					// show the frequency in the main font
 
-					sprintf(str, "%03u.%05u", frequency / 100000, frequency % 100000);
 					#ifdef ENABLE_TRIM_TRAILING_ZEROS
-						NUMBER_trim_trailing_zeros(str);
+						NUMBER_format_frequency(str, frequency, true);
+					#else
+						NUMBER_format_frequency(str, frequency, false);
 					#endif
 					UI_PrintString(str, x, 0, line, 8);
 
@@ -779,7 +828,7 @@ void UI_DisplayMain(void)
 					//g_eeprom.vfo_info[vfo_num].freq_in_channel = BOARD_find_channel(frequency);
 					if (g_eeprom.vfo_info[vfo_num].freq_in_channel <= USER_CHANNEL_LAST)
 					{	// the channel number that contains this VFO frequency
-						sprintf(str, "%03u", 1 + g_eeprom.vfo_info[vfo_num].freq_in_channel);
+						NUMBER_format_uint(str, 1 + g_eeprom.vfo_info[vfo_num].freq_in_channel, 3, '0');
 						UI_PrintStringSmallest(str, x, (line + 0) * 8, false, true);
 					}
 				}
@@ -976,9 +1025,14 @@ void UI_DisplayMain(void)
 
 					center_line = CENTER_LINE_CHARGE_DATA;
 
-					sprintf(str, "Charge %u.%02uV %u%%",
-						g_battery_voltage_average / 100, g_battery_voltage_average % 100,
-						BATTERY_VoltsToPercent(g_battery_voltage_average));
+					{
+						char *p = str;
+						strcpy(p, "Charge ");
+						p = NUMBER_format_voltage(p + 7, g_battery_voltage_average);
+						*p++ = ' ';
+						p = NUMBER_format_uint(p, BATTERY_VoltsToPercent(g_battery_voltage_average), 0, ' ');
+						strcpy(p, "%");
+					}
 					UI_PrintStringSmall(str, 2, 0, 3);
 				}
 			#endif
@@ -24,7 +24,6 @@
 #include "driver/keyboard.h"
 #include "driver/st7565.h"
 #include "app/dtmf.h"
-#include "external/printf/printf.h"
 #include "functions.h"
 #include "helper/battery.h"
 #include "misc.h"
@@ -213,7 +212,7 @@ void UI_DisplayStatus(const bool test_display)
 			case 1:		// voltage
 			{
 				const uint16_t voltage = (g_battery_voltage_average <= 999) ? g_battery_voltage_average : 999; // limit to 9.99V
-				sprintf(s, "%u.%02uV", voltage / 100, voltage % 100);
+				NUMBER_format_voltage(s, voltage);
 				space_needed = (7 * strlen(s));
 				if (x2 >= (x1 + space_needed))
 					UI_PrintStringSmallBuffer(s, line + x2 - space_needed);
@@ -222,7 +221,7 @@ void UI_DisplayStatus(const bool test_display)
 			
 			case 2:		// percentage
 			{
-				sprintf(s, "%u%%", BATTERY_VoltsToPercent(g_battery_voltage_average));
+				strcpy(NUMBER_format_uint(s, BATTERY_VoltsToPercent(g_battery_voltage_average), 0, ' '), "%");
 				space_needed = (7 * strlen(s));
 				if (x2 >= (x1 + space_needed))
 					UI_PrintStringSmallBuffer(s, line + x2 - space_needed);
@@ -23,6 +23,7 @@
 #include "app/search.h"
 #include "driver/keyboard.h"
 #include "misc.h"
+#include "profile.h"
 #ifdef ENABLE_AIRCOPY
 	#include "ui/aircopy.h"
 #endif
@@ -43,6 +44,8 @@ bool               g_ask_to_delete;
 
 void GUI_DisplayScreen(void)
 {
+	PROFILE_ENTER(PROFILE_ID_DISPLAY);
+
 	g_update_display = false;
 
 	switch (g_screen_to_display)
@@ -74,6 +77,8 @@ void GUI_DisplayScreen(void)
 		default:
 			break;
 	}
+
+	PROFILE_EXIT(PROFILE_ID_DISPLAY);
 }
 
 void GUI_SelectNextDisplay(gui_display_type_t Display)
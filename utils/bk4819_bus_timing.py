@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+#
+# Rough host side estimate of the BK4819 bit-banged bus cost, old vs new bus code
+#
+# The cycle counts are for the DP32G030 (Cortex-M0 @ 48MHz) built with -Os, they come from
+# reading the generated code, not from measurement, so treat the results as ball park figures.
+#
+#   python3 utils/bk4819_bus_timing.py
+
+CPU_HZ = 48000000
+
+# ****************************
+# old bus code .. GPIO_SetBit()/GPIO_ClearBit() calls + SYSTICK_DelayUs(1) around every clock edge
+
+OLD_GPIO_CALL = 10   # call + read-modify-write + return
+OLD_DELAY_1US = 80   # 48 ticks + call, multiply and SysTick polling overhead
+
+def old_write():
+	framing = 5 * OLD_GPIO_CALL + 4 * OLD_DELAY_1US
+	per_bit = 3 * OLD_GPIO_CALL + 3 * OLD_DELAY_1US
+	return framing + 24 * per_bit
+
+def old_read():
+	framing = 6 * OLD_GPIO_CALL + 2 * OLD_DELAY_1US + 40   # + SDA direction switching
+	wr_bit  = 3 * OLD_GPIO_CALL + 3 * OLD_DELAY_1US
+	rd_bit  = 3 * OLD_GPIO_CALL + 2 * OLD_DELAY_1US
+	return framing + 8 * wr_bit + 16 * rd_bit
+
+# ****************************
+# new bus code .. inline GPIO writes + BK4819_BUS_DELAY() (8 NOPs) per clock phase
+
+NEW_GPIO  = 4        # inline read-modify-write
+NEW_DELAY = 8
+
+def new_write(batched = False):
+	per_bit = 3 * NEW_GPIO + 2 * NEW_DELAY + 5            # + shift, test and loop
+	if batched:
+		framing = 2 * NEW_GPIO + 2 * NEW_DELAY + 4        # SCN pulse between frames
+	else:
+		framing = 6 * NEW_GPIO + 3 * NEW_DELAY + 10       # start + stop + call
+	return framing + 24 * per_bit
+
+def new_read():
+	framing = 6 * NEW_GPIO + 3 * NEW_DELAY + 10 + 40
+	wr_bit  = 3 * NEW_GPIO + 2 * NEW_DELAY + 5
+	rd_bit  = 3 * NEW_GPIO + 2 * NEW_DELAY + 5
+	return framing + 8 * wr_bit + 16 * rd_bit
+
+# ****************************
+# register traffic of RADIO_setup_registers() on a channel change (FM, no CTCSS/DCS, no VOX)
+#   writes, batched writes, reads
+
+CHANNEL_CHANGE = [
+	("GPIO pins/LEDs/PA/filter path", 6, 0, 0),
+	("filter bandwidth + PA bias",    2, 0, 0),
+	("interrupt status",              1, 0, 1),
+	("interrupt mask + mic gain",     2, 0, 0),
+	("RF frequency",                  0, 2, 0),
+	("squelch",                       0, 5, 0),
+	("AF + RX on",                    4, 0, 0),
+	("AF gain",                       1, 0, 0),
+	("CTCSS + tail detection",        3, 0, 0),
+	("scramble/VOX/compander",        6, 0, 3),
+	("DTMF",                          3, 0, 0),
+	("interrupt mask",                1, 0, 0),
+]
+
+def us(cycles):
+	return (cycles * 1000000.0) / CPU_HZ
+
+def main():
+	print("single access          old        new")
+	print("  write          %7.1fus  %7.1fus" % (us(old_write()), us(new_write())))
+	print("  write batched  %7.1fus  %7.1fus" % (us(old_write()), us(new_write(True))))
+	print("  read           %7.1fus  %7.1fus" % (us(old_read()),  us(new_read())))
+	print("")
+
+	old_total = 0
+	new_total = 0
+	print("channel change                      old        new")
+	for name, writes, batched, reads in CHANNEL_CHANGE:
+		old = (writes + batched) * old_write() + reads * old_read()
+		new = writes * new_write() + batched * new_write(True) + reads * new_read()
+		old_total += old
+		new_total += new
+		print("  %-30s %7.1fus  %7.1fus" % (name, us(old), us(new)))
+	print("  %-30s %7.1fus  %7.1fus  x%.1f" % ("total", us(old_total), us(new_total), float(old_total) / new_total))
+
+if __name__ == "__main__":
+	main()
@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+#
+# Read the ENABLE_KISS_TNC queue depths and counters over the programming lead and print them
+#
+#   python3 utils/kiss_stats.py /dev/ttyUSB0           # read
+#   python3 utils/kiss_stats.py /dev/ttyUSB0 --clear   # read then reset the counters
+#
+# the programming frames share the port with the KISS ones, so this can be run while a KISS
+# client has the radio .. as long as it isn't also holding the serial port open.
+#
+# needs pyserial, the framing is shared with trace_decode.py
+
+import struct
+import sys
+
+import serial
+
+from trace_decode import hello, receive, send
+
+STATS = [
+	"uart_frames", "uart_bad",
+	"tx_frames", "tx_failed", "tx_dropped", "tx_high_water",
+	"rx_frames", "rx_dropped", "rx_high_water",
+	"acks", "acks_lost",
+]
+
+def main():
+	if len(sys.argv) < 2:
+		print("usage: %s <serial port> [--clear]" % sys.argv[0])
+		return 1
+
+	clear = 1 if "--clear" in sys.argv[2:] else 0
+
+	with serial.Serial(sys.argv[1], 38400, timeout = 0.05) as port:
+		hello(port)
+		send(port, 0x0541, struct.pack("<B3x", clear))
+		cmd_id, data = receive(port)
+
+	if cmd_id != 0x0542:
+		print("no reply", file = sys.stderr)
+		return 1
+
+	is_open, tx_frames, rx_frames, tx_bytes, rx_bytes, tx_size, rx_size = struct.unpack_from("<BBBxHHHH", data)
+	stats = dict(zip(STATS, struct.unpack_from("<%uH" % len(STATS), data, 12)))
+
+	print("link %s" % ("open" if is_open else "closed"))
+	print("tx queue  %3u frames %5u/%u bytes  high %5u  dropped %u" % (tx_frames, tx_bytes, tx_size, stats["tx_high_water"], stats["tx_dropped"]))
+	print("rx queue  %3u frames %5u/%u bytes  high %5u  dropped %u" % (rx_frames, rx_bytes, rx_size, stats["rx_high_water"], stats["rx_dropped"]))
+	print("")
+	for name in STATS:
+		print("  %-14s %u" % (name, stats[name]))
+	return 0
+
+if __name__ == "__main__":
+	sys.exit(main())
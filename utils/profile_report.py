@@ -0,0 +1,59 @@
+#!/usr/bin/env python3
+#
+# Read the ENABLE_PROFILE cycle table over the programming lead and print it
+#
+#   python3 utils/profile_report.py /dev/ttyUSB0           # read
+#   python3 utils/profile_report.py /dev/ttyUSB0 --clear   # read then reset the counters
+#
+# needs pyserial, the framing is shared with trace_decode.py
+
+import os
+import re
+import struct
+import sys
+
+import serial
+
+from trace_decode import ROOT, hello, receive, send
+
+CPU_MHZ = 48
+
+def load_names(enum):
+	src = open(os.path.join(ROOT, "profile.h")).read()
+	body = re.search(r"enum\s+" + enum + r"\s*\{(.*?)\};", src, re.S).group(1)
+	return [m.group(1) for m in re.finditer(r"^\s*PROFILE_(?:ID|SLICE)_(\w+)", body, re.M) if m.group(1) != "COUNT"]
+
+def main():
+	if len(sys.argv) < 2:
+		print("usage: %s <serial port> [--clear]" % sys.argv[0])
+		return 1
+
+	regions = load_names("profile_id_e")
+	slices  = load_names("profile_slice_e")
+	clear   = 1 if "--clear" in sys.argv[2:] else 0
+
+	with serial.Serial(sys.argv[1], 38400, timeout = 0.05) as port:
+		hello(port)
+		send(port, 0x053F, struct.pack("<B3x", clear))
+		cmd_id, data = receive(port)
+
+	if cmd_id != 0x0540:
+		print("no reply", file = sys.stderr)
+		return 1
+
+	cycles_per_tick = struct.unpack_from("<I", data)[0]
+	overruns        = struct.unpack_from("<%uI" % len(slices), data, 4)
+	offset          = 4 + 4 * len(slices)
+
+	print("region             count      min us     avg us     max us   max %% of 10ms")
+	for name in regions:
+		count, mn, avg, mx = struct.unpack_from("<IIII", data, offset)
+		offset += 16
+		print("  %-14s %9u %10.1f %10.1f %10.1f   %5.1f" % (name, count, mn / CPU_MHZ, avg / CPU_MHZ, mx / CPU_MHZ, (mx * 100.0) / cycles_per_tick))
+	print("")
+	for name, n in zip(slices, overruns):
+		print("late %-6s slices  %u" % (name, n))
+	return 0
+
+if __name__ == "__main__":
+	sys.exit(main())
@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+#
+# Read back the ENABLE_TRACE event ring over the programming lead and print it as text
+#
+# Sends UART command 0x053D until the radio has nothing left, the event names are taken from
+# the TRACE_ID_ enum in trace.h so the two can't drift apart.
+#
+#   python3 utils/trace_decode.py /dev/ttyUSB0
+#   python3 utils/trace_decode.py /dev/ttyUSB0 --follow      # keep polling
+#
+# needs pyserial
+
+import os
+import re
+import struct
+import sys
+import time
+
+import serial
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+
+TICK_US      = 10000        # g_global_sys_tick_counter period
+SYSTICK_LOAD = 480000 - 1   # 10ms at 48MHz, SysTick counts down
+SUB_SHIFT    = 3            # the firmware stores SysTick->VAL >> 3
+
+# ****************************
+
+def load_ids():
+	src = open(os.path.join(ROOT, "trace.h")).read()
+	body = re.search(r"enum\s+trace_id_e\s*\{(.*?)\};", src, re.S).group(1)
+	names = {}
+	value = 0
+	for line in body.splitlines():
+		m = re.match(r"\s*TRACE_ID_(\w+)\s*(?:=\s*(\w+))?\s*,?", line)
+		if not m:
+			continue
+		if m.group(2) is not None:
+			value = int(m.group(2), 0)
+		names[value] = m.group(1)
+		value += 1
+	return names
+
+def load_obfuscate_key():
+	src = open(os.path.join(ROOT, "misc.c")).read()
+	body = re.search(r"obfuscate_array\[16\]\s*=\s*\{(.*?)\};", src, re.S).group(1)
+	return bytes(int(v, 0) for v in re.findall(r"0x[0-9A-Fa-f]+", body))
+
+KEY = load_obfuscate_key()
+
+def obfuscate(data):
+	return bytes(b ^ KEY[i % 16] for i, b in enumerate(data))
+
+def crc16(data):
+	crc = 0
+	for b in data:
+		crc ^= b << 8
+		for _ in range(8):
+			crc = ((crc << 1) ^ 0x1021) if (crc & 0x8000) else (crc << 1)
+			crc &= 0xFFFF
+	return crc
+
+# ****************************
+# framing .. AB CD | size | obfuscated(payload + CRC) | DC BA
+
+def send(port, cmd_id, data = b""):
+	payload = struct.pack("<HH", cmd_id, len(data)) + data
+	body    = obfuscate(payload + struct.pack("<H", crc16(payload)))
+	port.write(struct.pack("<HH", 0xCDAB, len(payload)) + body + struct.pack("<H", 0xBADC))
+
+def receive(port, timeout = 1.0):
+	buf = b""
+	end = time.time() + timeout
+	while time.time() < end:
+		buf += port.read(port.in_waiting or 1)
+		start = buf.find(b"\xAB\xCD")
+		if start < 0 or len(buf) < start + 4:
+			continue
+		size = struct.unpack_from("<H", buf, start + 2)[0]
+		if len(buf) < start + 4 + size + 4:
+			continue
+		payload = obfuscate(buf[start + 4 : start + 4 + size])   # replies carry no CRC
+		return struct.unpack_from("<HH", payload)[0], payload[4:]
+	return None, None
+
+def hello(port):
+	send(port, 0x0514, struct.pack("<I", 0x6A6C6548))   # time stamp, anything will do
+	receive(port)
+
+# ****************************
+
+def drain(port, names, t0):
+	total = 0
+	while True:
+		send(port, 0x053D, struct.pack("<B3x", 0))
+		cmd_id, data = receive(port)
+		if cmd_id != 0x053E:
+			print("no reply", file = sys.stderr)
+			return total
+		lost, count = struct.unpack_from("<HB", data)
+		if lost:
+			print("-- %u events lost --" % lost)
+		for n in range(count):
+			tick, sub, ev, a0, a1 = struct.unpack_from("<HHHHH", data, 4 + n * 10)
+			us = tick * TICK_US + ((SYSTICK_LOAD - (sub << SUB_SHIFT)) * TICK_US) // (SYSTICK_LOAD + 1)
+			if t0[0] is None:
+				t0[0] = us
+			rel = (us - t0[0]) % (65536 * TICK_US)   # the tick is only 16 bits
+			name = names.get(ev, "ID_%u" % ev)
+			print("%10.3fms  %-14s 0x%04X %5u   0x%04X %5u" % (rel / 1000.0, name, a0, a0, a1, a1))
+		total += count
+		if count == 0:
+			return total
+
+def main():
+	if len(sys.argv) < 2:
+		print("usage: %s <serial port> [--follow]" % sys.argv[0])
+		return 1
+
+	names  = load_ids()
+	follow = "--follow" in sys.argv[2:]
+	t0     = [None]
+
+	with serial.Serial(sys.argv[1], 38400, timeout = 0.05) as port:
+		hello(port)
+		while True:
+			drain(port, names, t0)
+			if not follow:
+				break
+			time.sleep(0.2)
+	return 0
+
+if __name__ == "__main__":
+	sys.exit(main())